@@ -0,0 +1,47 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pack.h"
+#include "platform.h"
+
+int main(int argc, char** argv) {
+    const char* directory = "textures";
+    const char* output = PACK_TEXTURE_ARCHIVE;
+    bool compact = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(arg, "--dir") == 0 && has_value) {
+            directory = argv[++i];
+        } else if (strcmp(arg, "--out") == 0 && has_value) {
+            output = argv[++i];
+        } else if (strcmp(arg, "--16bit") == 0) {
+            compact = true;
+        } else {
+            fprintf(stderr, "Uso: %s [--dir pasta] [--out arquivo] [--16bit]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    double start = platform_time_seconds();
+    PackStats stats;
+    if (!pack_build(directory, output, compact, &stats)) return 1;
+    double seconds = platform_time_seconds() - start;
+
+    PackArchive archive;
+    if (!pack_open(&archive, output)) return 1;
+    for (int i = 0; i < archive.entry_count; i++) {
+        const PackEntry* entry = &archive.entries[i];
+        uint64_t bytes = 0;
+        for (int m = 0; m < entry->mip_count; m++) bytes += entry->mips[m].size;
+        printf("%s: %dx%d, %d mips, %s, %llu bytes\n", entry->name, entry->width, entry->height, entry->mip_count,
+               entry->format == PACK_FORMAT_RGB565 ? "RGB565" : (entry->format == PACK_FORMAT_RGBA8 ? "RGBA8" : "RGB8"),
+               (unsigned long long)bytes);
+    }
+    pack_close(&archive);
+
+    printf("%d texturas, %llu bytes de BMP -> %llu bytes em %s (%.2f s)\n", stats.textures,
+           (unsigned long long)stats.source_bytes, (unsigned long long)stats.packed_bytes, output, seconds);
+    return 0;
+}
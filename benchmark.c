@@ -0,0 +1,400 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "benchmark.h"
+#include "mazegen.h"
+#include "platform.h"
+#include "render.h"
+#include "glload.h"
+#include "flythrough.h"
+#include "collectibles.h"
+#include "collision.h"
+#include "pathfind.h"
+#include "texture.h"
+#include "glstate.h"
+
+#define FLYTHROUGH_STEP 0.05f
+#define FRAME_TIME (1.0f / 60.0f)
+#define PATH_BENCH_QUERIES 200
+#define PATH_BENCH_REMOVALS 100
+
+static const int bench_sizes[] = {15, 63, 255, 1023, 4095, 16383};
+static const int default_limits[MAZEGEN_ALGORITHM_COUNT] = {4095, 1023, 16383};
+
+static void checksum_row(int z, const unsigned char* row, int width, void* user) {
+    uint64_t* sum = user;
+    for (int x = 0; x < width; x++) *sum = *sum * 31 + row[x];
+}
+
+int benchmark_maze_generation(int max_size) {
+    printf("algorithm,size,cells,seconds,cells_per_second,work_bytes,world_bytes,peak_rss_bytes\n");
+
+    for (int a = 0; a < MAZEGEN_ALGORITHM_COUNT; a++) {
+        int limit = max_size > 0 ? max_size : default_limits[a];
+
+        for (size_t i = 0; i < sizeof(bench_sizes) / sizeof(bench_sizes[0]); i++) {
+            int size = bench_sizes[i];
+            if (size > limit) break;
+
+            LevelConfig level = {size, 12345u, (MazeAlgorithm)a, mazegen_default_collectibles(size), 0};
+            size_t work_bytes = 0, world_bytes = 0;
+            double start = platform_time_seconds();
+
+            // Eller's is measured as a pure row stream, which is how it handles mazes too big to hold.
+            if (a == MAZEGEN_ELLER) {
+                uint64_t sum = 0;
+                work_bytes = mazegen_eller_stream(size, size, level.seed, level.collectibles, checksum_row, &sum);
+                if (sum == 0) printf("# checksum vazio\n");
+            } else {
+                World world;
+                if (!mazegen_generate(&world, &level, &work_bytes)) {
+                    printf("# %s %d: memoria insuficiente\n", mazegen_algorithm_name(level.algorithm), size);
+                    world_destroy(&world);
+                    break;
+                }
+                world_bytes = (size_t)world.chunks_x * world.chunks_z * sizeof(WorldChunk);
+                world_destroy(&world);
+            }
+
+            double seconds = platform_time_seconds() - start;
+            double cells = (double)size * size;
+            printf("%s,%d,%.0f,%.6f,%.0f,%zu,%zu,%zu\n", mazegen_algorithm_name(level.algorithm), size, cells,
+                   seconds, seconds > 0.0 ? cells / seconds : 0.0, work_bytes, world_bytes,
+                   platform_peak_memory_bytes());
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
+
+static PathCell random_open_cell(MazeRng* rng, const CollisionMap* map) {
+    PathCell cell;
+    do {
+        cell.x = (int)maze_rng_range(rng, map->width);
+        cell.z = (int)maze_rng_range(rng, map->height);
+    } while (collision_map_solid(map, cell.x, cell.z));
+    return cell;
+}
+
+int benchmark_pathfinding(int max_size) {
+    int limit = max_size > 0 ? max_size : 1023;
+    printf("size,cells,field_seconds,flow_path_us,collectible_field_seconds,incremental_update_us,"
+           "hpa_build_seconds,hpa_nodes,hpa_query_us,hpa_length_ratio\n");
+
+    for (size_t i = 0; i < sizeof(bench_sizes) / sizeof(bench_sizes[0]); i++) {
+        int size = bench_sizes[i];
+        if (size > limit) break;
+
+        LevelConfig level = {size, 12345u, MAZEGEN_BACKTRACKER, mazegen_default_collectibles(size), 0};
+        World world;
+        CollisionMap map = {0};
+        CollectibleIndex collectibles = {0};
+        PathField field;
+        if (!mazegen_generate(&world, &level, NULL) || !collision_map_build(&map, &world, false) ||
+            !collectibles_build(&collectibles, &world) || !path_field_init(&field, world.width, world.height)) {
+            printf("# %d: memoria insuficiente\n", size);
+            collectibles_free(&collectibles);
+            collision_map_free(&map);
+            world_destroy(&world);
+            break;
+        }
+        MazeRng rng;
+        maze_rng_seed(&rng, size);
+
+        PathCell exit_cell = {world.exit_x, world.exit_z};
+        double start = platform_time_seconds();
+        path_field_build(&field, &map, &exit_cell, 1);
+        double field_seconds = platform_time_seconds() - start;
+
+        PathCell queries[PATH_BENCH_QUERIES];
+        for (int q = 0; q < PATH_BENCH_QUERIES; q++) queries[q] = random_open_cell(&rng, &map);
+        long long exact_steps = 0;
+        start = platform_time_seconds();
+        for (int q = 0; q < PATH_BENCH_QUERIES; q++) {
+            PathCell cell = queries[q];
+            while (path_field_step(&field, cell.x, cell.z, &cell)) exact_steps++;
+        }
+        double flow_us = (platform_time_seconds() - start) * 1e6 / PATH_BENCH_QUERIES;
+
+        PathHierarchy hierarchy;
+        start = platform_time_seconds();
+        bool has_hierarchy = path_hierarchy_build(&hierarchy, &map, CHUNK_SIZE);
+        double hpa_build_seconds = platform_time_seconds() - start;
+        double hpa_us = 0.0;
+        long long hpa_steps = 0;
+        PathCell* path = has_hierarchy ? malloc((size_t)world.width * world.height * sizeof(PathCell)) : NULL;
+        if (path) {
+            start = platform_time_seconds();
+            for (int q = 0; q < PATH_BENCH_QUERIES; q++) {
+                hpa_steps += path_hierarchy_find(&hierarchy, &map, queries[q], exit_cell, path, world.width * world.height);
+            }
+            hpa_us = (platform_time_seconds() - start) * 1e6 / PATH_BENCH_QUERIES;
+        }
+
+        PathCell* sources = malloc((collectibles.count > 0 ? collectibles.count : 1) * sizeof(PathCell));
+        double collectible_seconds = 0.0, incremental_us = 0.0;
+        if (sources) {
+            for (int c = 0; c < collectibles.count; c++) {
+                sources[c].x = collectibles.items[c].cell_x;
+                sources[c].z = collectibles.items[c].cell_z;
+            }
+            start = platform_time_seconds();
+            path_field_build(&field, &map, sources, collectibles.count);
+            collectible_seconds = platform_time_seconds() - start;
+
+            int removals = collectibles.count < PATH_BENCH_REMOVALS ? collectibles.count : PATH_BENCH_REMOVALS;
+            start = platform_time_seconds();
+            for (int r = 0; r < removals; r++) {
+                PathCell* source = &sources[(long long)r * collectibles.count / removals];
+                path_field_remove_source(&field, &map, source->x, source->z);
+            }
+            incremental_us = removals > 0 ? (platform_time_seconds() - start) * 1e6 / removals : 0.0;
+        }
+
+        printf("%d,%.0f,%.6f,%.3f,%.6f,%.3f,%.6f,%d,%.3f,%.4f\n", size, (double)size * size, field_seconds, flow_us,
+               collectible_seconds, incremental_us, hpa_build_seconds, has_hierarchy ? hierarchy.node_count : 0, hpa_us,
+               exact_steps > 0 ? (double)hpa_steps / exact_steps : 1.0);
+        fflush(stdout);
+
+        free(sources);
+        free(path);
+        if (has_hierarchy) path_hierarchy_free(&hierarchy);
+        path_field_free(&field);
+        collectibles_free(&collectibles);
+        collision_map_free(&map);
+        world_destroy(&world);
+    }
+    return 0;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double da = *(const double*)a, db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+// 0, 1, 4, 16, ... with max_lights itself as the last step; -1 once it has been measured.
+static int next_light_count(int count, int max_lights) {
+    if (count >= max_lights) return -1;
+    if (count == 0) return 1;
+    return count * 4 < max_lights ? count * 4 : max_lights;
+}
+
+static double percentile(const double* sorted, int count, int p) {
+    return sorted[(count - 1) * p / 100];
+}
+
+static bool create_offscreen_target(int width, int height, GLuint* fbo, GLuint* buffers) {
+    if (!glload_has_fbo()) return false;
+
+    gl_gen_framebuffers(1, fbo);
+    gl_gen_renderbuffers(2, buffers);
+    gl_bind_framebuffer(GL_FRAMEBUFFER, *fbo);
+
+    gl_bind_renderbuffer(GL_RENDERBUFFER, buffers[0]);
+    gl_renderbuffer_storage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    gl_framebuffer_renderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, buffers[0]);
+
+    gl_bind_renderbuffer(GL_RENDERBUFFER, buffers[1]);
+    gl_renderbuffer_storage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    gl_framebuffer_renderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, buffers[1]);
+    gl_bind_renderbuffer(GL_RENDERBUFFER, 0);
+
+    if (gl_check_framebuffer_status(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        gl_bind_framebuffer(GL_FRAMEBUFFER, 0);
+        gl_delete_renderbuffers(2, buffers);
+        gl_delete_framebuffers(1, fbo);
+        return false;
+    }
+    return true;
+}
+
+static void destroy_offscreen_target(GLuint fbo, GLuint* buffers) {
+    gl_bind_framebuffer(GL_FRAMEBUFFER, 0);
+    gl_delete_renderbuffers(2, buffers);
+    gl_delete_framebuffers(1, &fbo);
+}
+
+typedef struct {
+    long long draw_call_sum;
+    int draw_call_max;
+    long long state_issued_sum, state_skipped_sum;
+} FrameCounters;
+
+// Renders config->warmup + config->frames frames along the path; returns the measured seconds.
+static double render_frames(const World* world, const CollectibleIndex* collectibles, const Flythrough* path,
+                            const RenderBenchConfig* config, bool offscreen, double* frame_ms, FrameCounters* counters) {
+    int total = config->warmup + config->frames;
+    double start = 0.0;
+    for (int i = 0; i < total; i++) {
+        if (i == config->warmup) start = platform_time_seconds();
+        double frame_start = platform_time_seconds();
+
+        Player view;
+        flythrough_sample(path, i * FLYTHROUGH_STEP, &view);
+        render_start_frame();
+        // A fixed step per frame keeps runs comparable.
+        render_scene(world, collectibles, &view, STATE_ESCAPING, i * FRAME_TIME);
+        if (offscreen) glFinish();
+        else glutSwapBuffers();
+
+        if (i < config->warmup) continue;
+        int n = i - config->warmup;
+        frame_ms[n] = (platform_time_seconds() - frame_start) * 1000.0;
+        int calls = render_get_draw_calls();
+        counters->draw_call_sum += calls;
+        if (calls > counters->draw_call_max) counters->draw_call_max = calls;
+        GlStateStats state;
+        glstate_get_stats(&state);
+        counters->state_issued_sum += state.issued;
+        counters->state_skipped_sum += state.skipped;
+    }
+    return platform_time_seconds() - start;
+}
+
+int benchmark_render_flythrough(const World* world, const RenderBenchConfig* config) {
+    Flythrough path;
+    if (!flythrough_build(&path, world)) {
+        fprintf(stderr, "Nenhum caminho ate a saida para o voo de benchmark\n");
+        return 1;
+    }
+    CollectibleIndex collectibles;
+    if (!collectibles_build(&collectibles, world)) {
+        flythrough_free(&path);
+        return 1;
+    }
+
+    double* frame_ms = malloc(config->frames * sizeof(double));
+    if (!frame_ms) {
+        collectibles_free(&collectibles);
+        flythrough_free(&path);
+        return 1;
+    }
+
+    // Measures steady-state rendering, not texture streaming.
+    texture_stream_finish();
+
+    GLuint fbo = 0, buffers[2] = {0, 0};
+    bool offscreen = create_offscreen_target(config->width, config->height, &fbo, buffers);
+    if (!offscreen) fprintf(stderr, "FBO indisponivel, renderizando na janela\n");
+    render_reshape(config->width, config->height);
+
+    FrameCounters counters = {0, 0, 0, 0};
+    double elapsed = render_frames(world, &collectibles, &path, config, offscreen, frame_ms, &counters);
+    if (offscreen) destroy_offscreen_target(fbo, buffers);
+
+    double sum = 0.0;
+    for (int i = 0; i < config->frames; i++) sum += frame_ms[i];
+    qsort(frame_ms, config->frames, sizeof(double), compare_doubles);
+
+    FILE* out = config->output ? fopen(config->output, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Nao foi possivel gravar o resultado: %s\n", config->output);
+        out = stdout;
+    }
+    fprintf(out, "{\n");
+    fprintf(out, "  \"renderer\": \"%s\",\n", (const char*)glGetString(GL_RENDERER));
+    fprintf(out, "  \"backend\": \"%s\",\n", render_backend_name(render_get_backend()));
+    fprintf(out, "  \"level\": {\"width\": %d, \"height\": %d},\n", world->width, world->height);
+    fprintf(out, "  \"resolution\": {\"width\": %d, \"height\": %d, \"offscreen\": %s},\n",
+            config->width, config->height, offscreen ? "true" : "false");
+    fprintf(out, "  \"frames\": %d,\n  \"warmup_frames\": %d,\n  \"seconds\": %.4f,\n", config->frames, config->warmup, elapsed);
+    fprintf(out, "  \"avg_fps\": %.2f,\n", elapsed > 0.0 ? config->frames / elapsed : 0.0);
+    fprintf(out, "  \"frame_ms\": {\"avg\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n",
+            sum / config->frames, percentile(frame_ms, config->frames, 50), percentile(frame_ms, config->frames, 95),
+            percentile(frame_ms, config->frames, 99), frame_ms[config->frames - 1]);
+    fprintf(out, "  \"draw_calls\": {\"avg\": %.2f, \"max\": %d},\n",
+            (double)counters.draw_call_sum / config->frames, counters.draw_call_max);
+    fprintf(out, "  \"gl_state_calls\": {\"issued_avg\": %.2f, \"skipped_avg\": %.2f}\n",
+            (double)counters.state_issued_sum / config->frames, (double)counters.state_skipped_sum / config->frames);
+    fprintf(out, "}\n");
+    if (out != stdout) fclose(out);
+
+    free(frame_ms);
+    collectibles_free(&collectibles);
+    flythrough_free(&path);
+    return 0;
+}
+
+// Scatters extra lights over random open cells and reports frame time per light count.
+int benchmark_render_lights(const World* world, const RenderBenchConfig* config) {
+    Flythrough path;
+    if (!flythrough_build(&path, world)) {
+        fprintf(stderr, "Nenhum caminho ate a saida para o voo de benchmark\n");
+        return 1;
+    }
+    CollectibleIndex collectibles;
+    if (!collectibles_build(&collectibles, world)) {
+        flythrough_free(&path);
+        return 1;
+    }
+    int max_lights = config->max_lights < LIGHTS_MAX ? config->max_lights : LIGHTS_MAX;
+    double* frame_ms = malloc(config->frames * sizeof(double));
+    PointLight* lights = malloc(max_lights * sizeof(PointLight));
+    if (!frame_ms || !lights) {
+        free(frame_ms);
+        free(lights);
+        collectibles_free(&collectibles);
+        flythrough_free(&path);
+        return 1;
+    }
+
+    uint32_t seed = 12345u;
+    for (int i = 0; i < max_lights; i++) {
+        int x, z;
+        do {
+            seed = seed * 1664525u + 1013904223u;
+            x = (int)(seed >> 8) % world->width;
+            seed = seed * 1664525u + 1013904223u;
+            z = (int)(seed >> 8) % world->height;
+        } while (world_get(world, x, z) == 1);
+        PointLight* light = &lights[i];
+        light->x = (x + 0.5f) * CUBE_SIZE;
+        light->y = 0.5f;
+        light->z = (z + 0.5f) * CUBE_SIZE;
+        light->r = 1.0f;
+        light->g = 0.1f + (seed >> 24) / 1024.0f;
+        light->b = 0.1f;
+        light->linear = 0.8f;
+        light->quadratic = 0.3f;
+    }
+
+    texture_stream_finish();
+    GLuint fbo = 0, buffers[2] = {0, 0};
+    bool offscreen = create_offscreen_target(config->width, config->height, &fbo, buffers);
+    if (!offscreen) fprintf(stderr, "FBO indisponivel, renderizando na janela\n");
+    render_reshape(config->width, config->height);
+
+    FILE* out = config->output ? fopen(config->output, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Nao foi possivel gravar o resultado: %s\n", config->output);
+        out = stdout;
+    }
+    fprintf(out, "# %s, %s, %dx%d, labirinto %dx%d\n", (const char*)glGetString(GL_RENDERER),
+            lights_available() ? "iluminacao por clusters" : "iluminacao fixa", config->width, config->height,
+            world->width, world->height);
+    fprintf(out, "extra_lights,lights,visible_lights,max_per_cluster,avg_ms,p50_ms,p99_ms,max_ms\n");
+    for (int count = 0; count >= 0; count = next_light_count(count, max_lights)) {
+        render_set_extra_lights(lights, count);
+        FrameCounters counters = {0, 0, 0, 0};
+        render_frames(world, &collectibles, &path, config, offscreen, frame_ms, &counters);
+
+        double sum = 0.0;
+        for (int i = 0; i < config->frames; i++) sum += frame_ms[i];
+        qsort(frame_ms, config->frames, sizeof(double), compare_doubles);
+        LightStats stats;
+        lights_get_stats(&stats);
+        fprintf(out, "%d,%d,%d,%d,%.4f,%.4f,%.4f,%.4f\n", count, stats.lights, stats.visible, stats.max_per_cluster,
+                sum / config->frames, percentile(frame_ms, config->frames, 50),
+                percentile(frame_ms, config->frames, 99), frame_ms[config->frames - 1]);
+        fflush(out);
+    }
+    render_set_extra_lights(NULL, 0);
+    if (out != stdout) fclose(out);
+
+    if (offscreen) destroy_offscreen_target(fbo, buffers);
+    free(lights);
+    free(frame_ms);
+    collectibles_free(&collectibles);
+    flythrough_free(&path);
+    return 0;
+}
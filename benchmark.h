@@ -0,0 +1,19 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "world.h"
+
+typedef struct {
+    int frames;
+    int warmup;
+    int width, height;
+    const char* output;
+    int max_lights;
+} RenderBenchConfig;
+
+int benchmark_maze_generation(int max_size);
+int benchmark_pathfinding(int max_size);
+int benchmark_render_flythrough(const World* world, const RenderBenchConfig* config);
+int benchmark_render_lights(const World* world, const RenderBenchConfig* config);
+
+#endif
@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "billboards.h"
+#include "glload.h"
+#include "shader.h"
+#include "glstate.h"
+
+// Corner offsets in units of the instance size, then texture coordinates.
+static const GLfloat quad[4][4] = {
+    {-0.5f, -0.5f, 0.0f, 0.0f},
+    { 0.5f, -0.5f, 1.0f, 0.0f},
+    { 0.5f,  0.5f, 1.0f, 1.0f},
+    {-0.5f,  0.5f, 0.0f, 1.0f}
+};
+static const GLuint quad_indices[6] = {0, 1, 2, 0, 2, 3};
+
+// The corners are offset in eye space, so the quad always faces the camera.
+static const char* vertex_source =
+    "#version 120\n"
+    "attribute vec4 billboard_instance;\n"
+    "void main() {\n"
+    "    vec4 eye = gl_ModelViewMatrix * vec4(billboard_instance.xyz, 1.0);\n"
+    "    eye.xy += gl_Vertex.xy * billboard_instance.w;\n"
+    "    gl_FrontColor = gl_Color;\n"
+    "    gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+    "    gl_Position = gl_ProjectionMatrix * eye;\n"
+    "}\n";
+
+static const char* fragment_source =
+    "#version 120\n"
+    "uniform sampler2D billboard_texture;\n"
+    "void main() {\n"
+    "    vec4 texel = texture2D(billboard_texture, gl_TexCoord[0].st);\n"
+    "    if (texel.a < 0.5) discard;\n"
+    "    gl_FragColor = texel * gl_Color;\n"
+    "}\n";
+
+static GLuint texture = 0;
+static GLuint vbo = 0, ibo = 0, instance_vbo = 0;
+static GLuint program = 0;
+static GLint instance_location = -1;
+static bool instanced = false;
+
+// A dark ghost with glowing red eyes; row 0 is the bottom of the quad.
+void billboards_build_texture(unsigned char* pixels) {
+    int size = BILLBOARD_TEXTURE_SIZE;
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            unsigned char* p = &pixels[(y * size + x) * 4];
+            float dx = x - 31.5f, dy = y - 36.0f;
+            float hem = 6.0f + 3.0f * sinf(x * 0.6f);
+            bool body = dx * dx + dy * dy <= 24.0f * 24.0f || (y < 36 && fabsf(dx) <= 24.0f && y >= hem);
+            float left = (x - 22.5f) * (x - 22.5f) + (y - 40.0f) * (y - 40.0f);
+            float right = (x - 40.5f) * (x - 40.5f) + (y - 40.0f) * (y - 40.0f);
+            float eye = left < right ? left : right;
+
+            if (!body) {
+                p[0] = p[1] = p[2] = p[3] = 0;
+            } else if (eye <= 5.0f * 5.0f) {
+                p[0] = 255;
+                p[1] = (unsigned char)(eye <= 2.0f * 2.0f ? 180 : 30);
+                p[2] = 20;
+                p[3] = 255;
+            } else {
+                // Darker toward the hem so the figure reads against the floor.
+                float shade = 0.5f + 0.5f * y / size;
+                p[0] = (unsigned char)(40 * shade);
+                p[1] = (unsigned char)(30 * shade);
+                p[2] = (unsigned char)(55 * shade);
+                p[3] = 255;
+            }
+        }
+    }
+}
+
+bool billboards_init() {
+    unsigned char* pixels = malloc(BILLBOARD_TEXTURE_SIZE * BILLBOARD_TEXTURE_SIZE * 4);
+    if (!pixels) return false;
+    billboards_build_texture(pixels);
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, BILLBOARD_TEXTURE_SIZE, BILLBOARD_TEXTURE_SIZE, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, pixels);
+    free(pixels);
+
+    if (glload_has_instancing()) {
+        program = shader_build("perseguidores", vertex_source, fragment_source);
+        if (program) {
+            instance_location = gl_get_attrib_location(program, "billboard_instance");
+            gl_use_program(program);
+            gl_uniform1i(gl_get_uniform_location(program, "billboard_texture"), 0);
+            gl_use_program(0);
+
+            gl_gen_buffers(1, &vbo);
+            gl_bind_buffer(GL_ARRAY_BUFFER, vbo);
+            gl_buffer_data(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+            gl_gen_buffers(1, &ibo);
+            gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+            gl_buffer_data(GL_ELEMENT_ARRAY_BUFFER, sizeof(quad_indices), quad_indices, GL_STATIC_DRAW);
+            gl_gen_buffers(1, &instance_vbo);
+            gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+            gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+            instanced = instance_location >= 0;
+        }
+    }
+    return true;
+}
+
+static int draw_instanced(const BillboardInstance* instances, int count) {
+    gl_bind_buffer(GL_ARRAY_BUFFER, instance_vbo);
+    gl_buffer_data(GL_ARRAY_BUFFER, count * sizeof(BillboardInstance), instances, GL_STREAM_DRAW);
+    glstate_use_program(program);
+    gl_enable_vertex_attrib_array(instance_location);
+    gl_vertex_attrib_divisor(instance_location, 1);
+    gl_vertex_attrib_pointer(instance_location, 4, GL_FLOAT, GL_FALSE, sizeof(BillboardInstance), NULL);
+
+    gl_bind_buffer(GL_ARRAY_BUFFER, vbo);
+    gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(quad[0]), NULL);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(quad[0]), (const char*)NULL + 2 * sizeof(GLfloat));
+    gl_draw_elements_instanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, NULL, count);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    gl_vertex_attrib_divisor(instance_location, 0);
+    gl_disable_vertex_attrib_array(instance_location);
+    glstate_use_program(0);
+    gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+    return 1;
+}
+
+// Builds every quad on the CPU from the camera's right and up vectors.
+static int draw_immediate(const BillboardInstance* instances, int count) {
+    GLfloat m[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, m);
+    float right[3] = {m[0], m[4], m[8]};
+    float up[3] = {m[1], m[5], m[9]};
+
+    glEnable(GL_ALPHA_TEST);
+    glAlphaFunc(GL_GEQUAL, 0.5f);
+    glBegin(GL_QUADS);
+    for (int i = 0; i < count; i++) {
+        const BillboardInstance* b = &instances[i];
+        for (int c = 0; c < 4; c++) {
+            float sx = quad[c][0] * b->size, sy = quad[c][1] * b->size;
+            glTexCoord2f(quad[c][2], quad[c][3]);
+            glVertex3f(b->x + right[0] * sx + up[0] * sy, b->y + right[1] * sx + up[1] * sy,
+                       b->z + right[2] * sx + up[2] * sy);
+        }
+    }
+    glEnd();
+    glDisable(GL_ALPHA_TEST);
+    return 1;
+}
+
+int billboards_draw(const BillboardInstance* instances, int count) {
+    if (count <= 0 || !texture) return 0;
+    glstate_bind_texture(0, texture);
+    glstate_set(GLSTATE_LIGHTING, false);
+    int draw_calls = instanced ? draw_instanced(instances, count) : draw_immediate(instances, count);
+    glstate_set(GLSTATE_LIGHTING, true);
+    return draw_calls;
+}
+
+void billboards_cleanup() {
+    if (texture) glDeleteTextures(1, &texture);
+    if (vbo) gl_delete_buffers(1, &vbo);
+    if (ibo) gl_delete_buffers(1, &ibo);
+    if (instance_vbo) gl_delete_buffers(1, &instance_vbo);
+    if (program) gl_delete_program(program);
+    texture = vbo = ibo = instance_vbo = program = 0;
+    instanced = false;
+}
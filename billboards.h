@@ -0,0 +1,23 @@
+#ifndef BILLBOARDS_H
+#define BILLBOARDS_H
+
+#include <stdbool.h>
+
+#define BILLBOARD_TEXTURE_SIZE 64
+
+typedef struct {
+    float x, y, z;
+    float size;
+} BillboardInstance;
+
+// Camera-facing quads sharing one procedural texture, drawn with a single
+// instanced call when the driver allows it. Texels below half alpha are cut
+// out, so the billboards need no sorting.
+bool billboards_init();
+int billboards_draw(const BillboardInstance* instances, int count);
+void billboards_cleanup();
+// Fills BILLBOARD_TEXTURE_SIZE squared RGBA texels, bottom row first, with the
+// texture the billboards use, so the software renderer can draw the same figure.
+void billboards_build_texture(unsigned char* pixels);
+
+#endif
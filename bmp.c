@@ -0,0 +1,61 @@
+#include <stdint.h>
+#include "bmp.h"
+
+#define BMP_HEADER_SIZE 54
+#define BMP_MAX_DIMENSION 16384
+
+static uint32_t read_u32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_u16(const unsigned char* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+const char* bmp_parse(const MappedFile* file, BmpImage* image) {
+    const unsigned char* h = file->data;
+    if (file->size < BMP_HEADER_SIZE || h[0] != 'B' || h[1] != 'M') return "assinatura invalida";
+
+    uint32_t data_pos = read_u32(h + 0x0A);
+    uint32_t info_size = read_u32(h + 0x0E);
+    int32_t width = (int32_t)read_u32(h + 0x12);
+    int32_t height = (int32_t)read_u32(h + 0x16);
+    uint16_t planes = read_u16(h + 0x1A);
+    uint16_t bits = read_u16(h + 0x1C);
+    uint32_t compression = read_u32(h + 0x1E);
+
+    if (info_size < 40 || 14 + info_size > file->size) return "cabecalho DIB nao suportado";
+    if (planes != 1) return "numero de planos invalido";
+    if (bits != 24 && bits != 32) return "apenas 24 ou 32 bits por pixel";
+    if (width <= 0 || height == 0 || width > BMP_MAX_DIMENSION ||
+        height > BMP_MAX_DIMENSION || height < -BMP_MAX_DIMENSION) return "dimensoes invalidas";
+
+    // BI_BITFIELDS is only accepted when the masks are plain BGRA.
+    bool has_alpha = false;
+    if (compression == 3) {
+        if (bits != 32 || info_size < 52) return "compressao nao suportada";
+        if (read_u32(h + 0x36) != 0x00FF0000 || read_u32(h + 0x3A) != 0x0000FF00 ||
+            read_u32(h + 0x3E) != 0x000000FF) return "mascaras de cor nao suportadas";
+        has_alpha = info_size >= 56 && read_u32(h + 0x42) == 0xFF000000;
+    } else if (compression != 0) {
+        return "compressao nao suportada";
+    }
+
+    image->width = width;
+    image->height = height < 0 ? -height : height;
+    image->top_down = height < 0;
+    image->bits = bits;
+    image->has_alpha = has_alpha;
+    // Rows are padded to 4 bytes, which is also GL's default unpack alignment.
+    image->stride = ((size_t)width * bits + 31) / 32 * 4;
+
+    if (data_pos < 14 + info_size || data_pos > file->size ||
+        image->stride * image->height > file->size - data_pos) return "dados de pixel truncados";
+    image->pixels = file->data + data_pos;
+    return NULL;
+}
+
+const unsigned char* bmp_row(const BmpImage* image, int y) {
+    int row = image->top_down ? image->height - 1 - y : y;
+    return image->pixels + (size_t)row * image->stride;
+}
@@ -0,0 +1,22 @@
+#ifndef BMP_H
+#define BMP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "platform.h"
+
+typedef struct {
+    int width, height;
+    int bits;
+    bool top_down;
+    bool has_alpha;
+    size_t stride;
+    const unsigned char* pixels;
+} BmpImage;
+
+// Validates an uncompressed 24/32-bit BMP in memory and points image->pixels at its rows.
+// Returns NULL on success or a short description of what is wrong with the file.
+const char* bmp_parse(const MappedFile* file, BmpImage* image);
+const unsigned char* bmp_row(const BmpImage* image, int y);
+
+#endif
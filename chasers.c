@@ -0,0 +1,181 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "chasers.h"
+#include "jobs.h"
+#include "mazegen.h"
+#include "thread.h"
+
+static inline int cell_of(float v) {
+    return (int)(v / CUBE_SIZE);
+}
+
+static inline int bucket_of(const Chasers* chasers, int x, int z) {
+    return (int)(((uint32_t)x * 73856093u) ^ ((uint32_t)z * 19349663u)) & chasers->bucket_mask;
+}
+
+bool chasers_init(Chasers* chasers, const World* level, int count) {
+    memset(chasers, 0, sizeof(*chasers));
+    if (count <= 0) return true;
+
+    int buckets = 1;
+    while (buckets < count * 2) buckets <<= 1;
+    chasers->bucket_mask = buckets - 1;
+    chasers->prev_x = malloc((size_t)count * 2 * sizeof(float));
+    chasers->bucket_start = malloc(((size_t)buckets + 1) * sizeof(int));
+    chasers->bucket_items = malloc((size_t)count * sizeof(int));
+    if (!chasers->prev_x || !chasers->bucket_start || !chasers->bucket_items ||
+        !collision_bodies_init(&chasers->bodies, count) ||
+        !path_field_init(&chasers->field, level->width, level->height)) {
+        chasers_free(chasers);
+        return false;
+    }
+    chasers->prev_z = chasers->prev_x + count;
+    chasers->count = count;
+    chasers->bodies.count = count;
+    chasers->target_x = chasers->target_z = -1;
+    return true;
+}
+
+void chasers_spawn(Chasers* chasers, const CollisionMap* map, float player_x, float player_z, uint32_t seed) {
+    MazeRng rng;
+    maze_rng_seed(&rng, seed);
+    int px = cell_of(player_x), pz = cell_of(player_z);
+    // Small mazes may not have enough far cells, so after a while any open cell but the player's will do.
+    int patience = chasers->count * 64;
+    for (int i = 0; i < chasers->count; i++) {
+        int x, z;
+        for (;;) {
+            x = (int)maze_rng_range(&rng, map->width);
+            z = (int)maze_rng_range(&rng, map->height);
+            if (collision_map_solid(map, x, z) || (x == px && z == pz)) continue;
+            if (abs(x - px) + abs(z - pz) >= CHASER_SPAWN_DISTANCE || --patience < 0) break;
+        }
+        chasers->bodies.x[i] = (x + 0.3f + 0.4f * maze_rng_range(&rng, 1001) / 1000.0f) * CUBE_SIZE;
+        chasers->bodies.z[i] = (z + 0.3f + 0.4f * maze_rng_range(&rng, 1001) / 1000.0f) * CUBE_SIZE;
+        chasers->bodies.vx[i] = 0.0f;
+        chasers->bodies.vz[i] = 0.0f;
+    }
+    memcpy(chasers->prev_x, chasers->bodies.x, chasers->count * sizeof(float));
+    memcpy(chasers->prev_z, chasers->bodies.z, chasers->count * sizeof(float));
+    chasers->target_x = chasers->target_z = -1;
+    chasers->caught = 0;
+}
+
+// Pushes apart from every pursuer closer than CHASER_SEPARATION in the 3x3 cells around (x, z).
+static void separation(const Chasers* chasers, int self, float x, float z, float* push_x, float* push_z) {
+    int cx = cell_of(x), cz = cell_of(z);
+    for (int oz = -1; oz <= 1; oz++) {
+        for (int ox = -1; ox <= 1; ox++) {
+            int bucket = bucket_of(chasers, cx + ox, cz + oz);
+            for (int k = chasers->bucket_start[bucket]; k < chasers->bucket_start[bucket + 1]; k++) {
+                int other = chasers->bucket_items[k];
+                float other_x = chasers->prev_x[other], other_z = chasers->prev_z[other];
+                // Buckets are shared by colliding cells; only the cell being visited counts.
+                if (other == self || cell_of(other_x) != cx + ox || cell_of(other_z) != cz + oz) continue;
+
+                float dx = x - other_x, dz = z - other_z;
+                float dist_sq = dx * dx + dz * dz;
+                if (dist_sq >= CHASER_SEPARATION * CHASER_SEPARATION) continue;
+                float dist = sqrtf(dist_sq);
+                if (dist < 1e-4f) {
+                    dx = self < other ? -1.0f : 1.0f;
+                    dz = 0.0f;
+                    dist = 1.0f;
+                }
+                float weight = (CHASER_SEPARATION - dist) / CHASER_SEPARATION;
+                *push_x += dx / dist * weight;
+                *push_z += dz / dist * weight;
+            }
+        }
+    }
+}
+
+// Reads only the positions from the start of the tick, so the result does
+// not depend on how the agents are split between threads.
+static void update_range(int begin, int end, void* user) {
+    Chasers* chasers = user;
+    for (int i = begin; i < end; i++) {
+        float x = chasers->prev_x[i], z = chasers->prev_z[i];
+        int cx = cell_of(x), cz = cell_of(z);
+        float vx = 0.0f, vz = 0.0f;
+
+        if (path_field_distance(&chasers->field, cx, cz) != PATH_UNREACHABLE) {
+            float goal_x = chasers->player_x, goal_z = chasers->player_z;
+            PathCell next;
+            if (path_field_step(&chasers->field, cx, cz, &next)) {
+                goal_x = (next.x + 0.5f) * CUBE_SIZE;
+                goal_z = (next.z + 0.5f) * CUBE_SIZE;
+            }
+            float dx = goal_x - x, dz = goal_z - z;
+            float length = sqrtf(dx * dx + dz * dz);
+            if (length > 1e-4f) {
+                vx = dx / length * CHASER_SPEED;
+                vz = dz / length * CHASER_SPEED;
+            }
+        }
+
+        float push_x = 0.0f, push_z = 0.0f;
+        separation(chasers, i, x, z, &push_x, &push_z);
+        chasers->bodies.vx[i] = vx + push_x * CHASER_AVOIDANCE * CHASER_SPEED;
+        chasers->bodies.vz[i] = vz + push_z * CHASER_AVOIDANCE * CHASER_SPEED;
+    }
+
+    CollisionBodies range = {chasers->bodies.x + begin, chasers->bodies.z + begin, chasers->bodies.vx + begin,
+                             chasers->bodies.vz + begin, end - begin, end - begin};
+    collision_move(chasers->map, &range, CHASER_SIZE / 2.0f, chasers->dt);
+
+    for (int i = begin; i < end; i++) {
+        float dx = chasers->bodies.x[i] - chasers->player_x, dz = chasers->bodies.z[i] - chasers->player_z;
+        if (dx * dx + dz * dz < CHASER_CATCH_DISTANCE * CHASER_CATCH_DISTANCE) {
+            thread_atomic_store(&chasers->caught, 1);
+        }
+    }
+}
+
+// Counting sort of the agents by the hash of their cell.
+static void fill_buckets(Chasers* chasers) {
+    int buckets = chasers->bucket_mask + 1;
+    memset(chasers->bucket_start, 0, ((size_t)buckets + 1) * sizeof(int));
+    for (int i = 0; i < chasers->count; i++) {
+        chasers->bucket_start[bucket_of(chasers, cell_of(chasers->prev_x[i]), cell_of(chasers->prev_z[i]))]++;
+    }
+    for (int b = 1; b < buckets; b++) chasers->bucket_start[b] += chasers->bucket_start[b - 1];
+    chasers->bucket_start[buckets] = chasers->count;
+    for (int i = chasers->count - 1; i >= 0; i--) {
+        int bucket = bucket_of(chasers, cell_of(chasers->prev_x[i]), cell_of(chasers->prev_z[i]));
+        chasers->bucket_items[--chasers->bucket_start[bucket]] = i;
+    }
+}
+
+bool chasers_update(Chasers* chasers, const CollisionMap* map, float player_x, float player_z, float dt) {
+    if (chasers->count == 0) return false;
+
+    memcpy(chasers->prev_x, chasers->bodies.x, chasers->count * sizeof(float));
+    memcpy(chasers->prev_z, chasers->bodies.z, chasers->count * sizeof(float));
+
+    int px = cell_of(player_x), pz = cell_of(player_z);
+    if (px != chasers->target_x || pz != chasers->target_z) {
+        PathCell target = {px, pz};
+        path_field_build_near(&chasers->field, map, &target, 1, CHASER_SENSE_RADIUS);
+        chasers->target_x = px;
+        chasers->target_z = pz;
+    }
+    fill_buckets(chasers);
+
+    chasers->map = map;
+    chasers->player_x = player_x;
+    chasers->player_z = player_z;
+    chasers->dt = dt;
+    jobs_parallel_for(chasers->count, CHASER_JOB_GRAIN, update_range, chasers);
+    return chasers->caught != 0;
+}
+
+void chasers_free(Chasers* chasers) {
+    collision_bodies_free(&chasers->bodies);
+    path_field_free(&chasers->field);
+    free(chasers->prev_x);
+    free(chasers->bucket_start);
+    free(chasers->bucket_items);
+    memset(chasers, 0, sizeof(*chasers));
+}
@@ -0,0 +1,38 @@
+#ifndef CHASERS_H
+#define CHASERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+#include "world.h"
+#include "collision.h"
+#include "pathfind.h"
+
+// Pursuers stored as parallel arrays. Every tick they follow one shared flow
+// field toward the player's cell, steer away from the others close by and
+// slide along the walls; the agents are split across the job threads.
+typedef struct {
+    int count;
+    CollisionBodies bodies;
+    // Positions at the start of the tick: what neighbours see, and what the renderer interpolates from.
+    float* prev_x;
+    float* prev_z;
+    PathField field;
+    int target_x, target_z;
+    int* bucket_start;
+    int* bucket_items;
+    int bucket_mask;
+    const CollisionMap* map;
+    float player_x, player_z;
+    float dt;
+    volatile int caught;
+} Chasers;
+
+bool chasers_init(Chasers* chasers, const World* level, int count);
+// Scatters the pursuers over open cells away from the player.
+void chasers_spawn(Chasers* chasers, const CollisionMap* map, float player_x, float player_z, uint32_t seed);
+// Returns true once a pursuer reaches the player.
+bool chasers_update(Chasers* chasers, const CollisionMap* map, float player_x, float player_z, float dt);
+void chasers_free(Chasers* chasers);
+
+#endif
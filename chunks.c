@@ -0,0 +1,163 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chunks.h"
+
+static RenderChunk slots[CHUNK_CACHE_SLOTS];
+static int* slot_of_chunk = NULL;
+static int chunks_x = 0, chunks_z = 0;
+static const Lightmap* level_lightmap = NULL;
+static unsigned int frame_counter = 0;
+
+static MeshStats wall_stats, floor_stats, ceiling_stats;
+static int chunks_built = 0, chunks_evicted = 0;
+
+static void evict(int slot) {
+    RenderChunk* chunk = &slots[slot];
+    if (!chunk->resident) return;
+
+    mesh_free(&chunk->walls);
+    mesh_free(&chunk->floor);
+    mesh_free(&chunk->ceiling);
+    pvs_chunk_free(&chunk->pvs);
+    if (chunk->lightmap) glDeleteTextures(1, &chunk->lightmap);
+    chunk->lightmap = 0;
+    slot_of_chunk[chunk->cx * chunks_z + chunk->cz] = -1;
+    chunk->resident = false;
+    chunks_evicted++;
+}
+
+static int find_slot() {
+    int victim = -1;
+    for (int i = 0; i < CHUNK_CACHE_SLOTS; i++) {
+        if (!slots[i].resident) return i;
+        if (slots[i].last_used == frame_counter) continue;
+        if (victim < 0 || slots[i].last_used < slots[victim].last_used) victim = i;
+    }
+    if (victim >= 0) evict(victim);
+    return victim;
+}
+
+static void upload_lightmap(RenderChunk* chunk) {
+    const unsigned char* texels = level_lightmap ? lightmap_chunk(level_lightmap, chunk->cx, chunk->cz) : NULL;
+    if (!texels) return;
+
+    GLint bound = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+    glGenTextures(1, &chunk->lightmap);
+    glBindTexture(GL_TEXTURE_2D, chunk->lightmap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE8, LIGHTMAP_WIDTH, LIGHTMAP_HEIGHT, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, texels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, bound);
+}
+
+static void build(const World* world, int slot, int cx, int cz) {
+    RenderChunk* chunk = &slots[slot];
+    memset(chunk, 0, sizeof(*chunk));
+    chunk->cx = cx;
+    chunk->cz = cz;
+
+    mesh_build_walls(&chunk->walls, world, cx, cz);
+    mesh_build_floor(&chunk->floor, world, cx, cz);
+    mesh_build_ceiling(&chunk->ceiling, world, cx, cz);
+
+    mesh_add_stats(&wall_stats, &chunk->walls);
+    mesh_add_stats(&floor_stats, &chunk->floor);
+    mesh_add_stats(&ceiling_stats, &chunk->ceiling);
+
+    mesh_upload(&chunk->walls);
+    mesh_upload(&chunk->floor);
+    mesh_upload(&chunk->ceiling);
+    pvs_chunk_init(&chunk->pvs, cx, cz);
+    upload_lightmap(chunk);
+
+    chunk->resident = true;
+    chunk->last_used = frame_counter;
+    slot_of_chunk[cx * chunks_z + cz] = slot;
+    chunks_built++;
+}
+
+bool chunks_init(const World* world, const Lightmap* lightmap) {
+    chunks_cleanup();
+    level_lightmap = lightmap;
+
+    chunks_x = world->chunks_x;
+    chunks_z = world->chunks_z;
+    slot_of_chunk = malloc((size_t)chunks_x * chunks_z * sizeof(int));
+    if (!slot_of_chunk) return false;
+    for (int i = 0; i < chunks_x * chunks_z; i++) slot_of_chunk[i] = -1;
+
+    memset(&wall_stats, 0, sizeof(wall_stats));
+    memset(&floor_stats, 0, sizeof(floor_stats));
+    memset(&ceiling_stats, 0, sizeof(ceiling_stats));
+    chunks_built = 0;
+    chunks_evicted = 0;
+    return true;
+}
+
+void chunks_update(const World* world, float x, float z, bool build_all) {
+    frame_counter++;
+
+    int pcx = (int)(x / CUBE_SIZE) >> CHUNK_SHIFT;
+    int pcz = (int)(z / CUBE_SIZE) >> CHUNK_SHIFT;
+    int builds = 0;
+
+    for (int cx = pcx - CHUNK_RESIDENT_RADIUS; cx <= pcx + CHUNK_RESIDENT_RADIUS; cx++) {
+        for (int cz = pcz - CHUNK_RESIDENT_RADIUS; cz <= pcz + CHUNK_RESIDENT_RADIUS; cz++) {
+            RenderChunk* chunk = chunks_get(cx, cz);
+            if (chunk) chunk->last_used = frame_counter;
+        }
+    }
+
+    // The player's own chunk is visited first so it is never starved by the per-frame build budget.
+    for (int ring = 0; ring <= CHUNK_RESIDENT_RADIUS; ring++) {
+        for (int cx = pcx - ring; cx <= pcx + ring; cx++) {
+            for (int cz = pcz - ring; cz <= pcz + ring; cz++) {
+                if (abs(cx - pcx) != ring && abs(cz - pcz) != ring) continue;
+                if (cx < 0 || cx >= chunks_x || cz < 0 || cz >= chunks_z) continue;
+                if (slot_of_chunk[cx * chunks_z + cz] >= 0) continue;
+                if (!build_all && ring > 0 && builds >= CHUNK_BUILDS_PER_FRAME) continue;
+
+                int slot = find_slot();
+                if (slot < 0) continue;
+                build(world, slot, cx, cz);
+                builds++;
+            }
+        }
+    }
+
+    RenderChunk* current = chunks_get(pcx, pcz);
+    if (current) {
+        pvs_fill(&current->pvs, world, build_all ? CHUNK_SIZE * CHUNK_SIZE : PVS_CELLS_PER_FRAME);
+    }
+}
+
+RenderChunk* chunks_get(int cx, int cz) {
+    if (!slot_of_chunk || cx < 0 || cx >= chunks_x || cz < 0 || cz >= chunks_z) return NULL;
+    int slot = slot_of_chunk[cx * chunks_z + cz];
+    return slot >= 0 ? &slots[slot] : NULL;
+}
+
+RenderChunk* chunks_slot(int slot) {
+    return slots[slot].resident ? &slots[slot] : NULL;
+}
+
+void chunks_print_stats() {
+    printf("Chunks: %d construidos, %d descartados\n", chunks_built, chunks_evicted);
+    mesh_print_stats("paredes", &wall_stats);
+    mesh_print_stats("chao", &floor_stats);
+    mesh_print_stats("teto", &ceiling_stats);
+}
+
+void chunks_cleanup() {
+    if (slot_of_chunk) {
+        for (int i = 0; i < CHUNK_CACHE_SLOTS; i++) evict(i);
+    }
+    free(slot_of_chunk);
+    slot_of_chunk = NULL;
+}
@@ -0,0 +1,31 @@
+#ifndef CHUNKS_H
+#define CHUNKS_H
+
+#include <stdbool.h>
+#include "config.h"
+#include "world.h"
+#include "mesh.h"
+#include "pvs.h"
+#include "lightmap.h"
+
+#define CHUNK_BLOCKS (CHUNK_SIZE / MESH_BLOCK_SIZE)
+
+typedef struct {
+    int cx, cz;
+    bool resident;
+    unsigned int last_used;
+    Mesh walls, floor, ceiling;
+    PvsChunk pvs;
+    GLuint lightmap;
+    bool block_visible[CHUNK_BLOCKS * CHUNK_BLOCKS];
+} RenderChunk;
+
+// lightmap may be NULL; chunks then carry no baked lighting.
+bool chunks_init(const World* world, const Lightmap* lightmap);
+void chunks_update(const World* world, float x, float z, bool build_all);
+RenderChunk* chunks_get(int cx, int cz);
+RenderChunk* chunks_slot(int slot);
+void chunks_print_stats();
+void chunks_cleanup();
+
+#endif
@@ -0,0 +1,157 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "collectibles.h"
+#include "config.h"
+
+#define BUCKET_CELLS (1 << COLLECTIBLE_BUCKET_SHIFT)
+
+static int bucket_of(const CollectibleIndex* index, int cell_x, int cell_z) {
+    return (cell_x >> COLLECTIBLE_BUCKET_SHIFT) * index->buckets_z + (cell_z >> COLLECTIBLE_BUCKET_SHIFT);
+}
+
+bool collectibles_build(CollectibleIndex* index, const World* world) {
+    memset(index, 0, sizeof(*index));
+    index->buckets_x = (world->width + BUCKET_CELLS - 1) >> COLLECTIBLE_BUCKET_SHIFT;
+    index->buckets_z = (world->height + BUCKET_CELLS - 1) >> COLLECTIBLE_BUCKET_SHIFT;
+    int bucket_count = index->buckets_x * index->buckets_z;
+
+    index->bucket_start = calloc(bucket_count + 1, sizeof(int));
+    index->bucket_active = calloc(bucket_count, sizeof(int));
+    int total = world_count_tiles(world, 2);
+    index->items = malloc((total > 0 ? total : 1) * sizeof(Collectible));
+    if (!index->bucket_start || !index->bucket_active || !index->items) {
+        collectibles_free(index);
+        return false;
+    }
+
+    // Walking the grid bucket by bucket leaves every bucket's items contiguous.
+    for (int bx = 0; bx < index->buckets_x; bx++) {
+        for (int bz = 0; bz < index->buckets_z; bz++) {
+            index->bucket_start[bx * index->buckets_z + bz] = index->count;
+            for (int x = bx * BUCKET_CELLS; x < (bx + 1) * BUCKET_CELLS && x < world->width; x++) {
+                for (int z = bz * BUCKET_CELLS; z < (bz + 1) * BUCKET_CELLS && z < world->height; z++) {
+                    if (world_get(world, x, z) != 2) continue;
+                    Collectible* item = &index->items[index->count++];
+                    item->cell_x = x;
+                    item->cell_z = z;
+                    item->x = (x + 0.5f) * CUBE_SIZE;
+                    item->z = (z + 0.5f) * CUBE_SIZE;
+                }
+            }
+        }
+    }
+    index->bucket_start[bucket_count] = index->count;
+    collectibles_reset(index);
+    return true;
+}
+
+void collectibles_reset(CollectibleIndex* index) {
+    int bucket_count = index->buckets_x * index->buckets_z;
+    for (int b = 0; b < bucket_count; b++) {
+        index->bucket_active[b] = index->bucket_start[b + 1] - index->bucket_start[b];
+    }
+    for (int i = 0; i < index->count; i++) index->items[i].active = true;
+    index->active_count = index->count;
+}
+
+int collectibles_remove_at(CollectibleIndex* index, int cell_x, int cell_z) {
+    if (cell_x < 0 || cell_z < 0) return -1;
+    if ((cell_x >> COLLECTIBLE_BUCKET_SHIFT) >= index->buckets_x || (cell_z >> COLLECTIBLE_BUCKET_SHIFT) >= index->buckets_z) return -1;
+
+    int b = bucket_of(index, cell_x, cell_z);
+    for (int i = index->bucket_start[b]; i < index->bucket_start[b + 1]; i++) {
+        Collectible* item = &index->items[i];
+        if (item->active && item->cell_x == cell_x && item->cell_z == cell_z) {
+            item->active = false;
+            index->bucket_active[b]--;
+            index->active_count--;
+            return i;
+        }
+    }
+    return -1;
+}
+
+static float distance_sq(const Collectible* item, float x, float z) {
+    return (item->x - x) * (item->x - x) + (item->z - z) * (item->z - z);
+}
+
+int collectibles_in_radius(const CollectibleIndex* index, float x, float z, float radius, int* out, int max_out) {
+    int bx0 = (int)floorf((x - radius) / CUBE_SIZE) >> COLLECTIBLE_BUCKET_SHIFT;
+    int bx1 = (int)floorf((x + radius) / CUBE_SIZE) >> COLLECTIBLE_BUCKET_SHIFT;
+    int bz0 = (int)floorf((z - radius) / CUBE_SIZE) >> COLLECTIBLE_BUCKET_SHIFT;
+    int bz1 = (int)floorf((z + radius) / CUBE_SIZE) >> COLLECTIBLE_BUCKET_SHIFT;
+    if (bx0 < 0) bx0 = 0;
+    if (bz0 < 0) bz0 = 0;
+    if (bx1 >= index->buckets_x) bx1 = index->buckets_x - 1;
+    if (bz1 >= index->buckets_z) bz1 = index->buckets_z - 1;
+
+    float radius_sq = radius * radius;
+    int found = 0;
+    for (int bx = bx0; bx <= bx1; bx++) {
+        for (int bz = bz0; bz <= bz1; bz++) {
+            int b = bx * index->buckets_z + bz;
+            if (index->bucket_active[b] == 0) continue;
+            for (int i = index->bucket_start[b]; i < index->bucket_start[b + 1]; i++) {
+                const Collectible* item = &index->items[i];
+                if (!item->active || distance_sq(item, x, z) > radius_sq) continue;
+                if (found < max_out) out[found] = i;
+                found++;
+            }
+        }
+    }
+    return found < max_out ? found : max_out;
+}
+
+int collectibles_nearest(const CollectibleIndex* index, float x, float z, float max_radius, int k, int* out) {
+    if (k <= 0 || index->active_count == 0) return 0;
+
+    float best_sq[k];
+    int found = 0;
+    float max_sq = max_radius * max_radius;
+    int cbx = (int)floorf(x / CUBE_SIZE) >> COLLECTIBLE_BUCKET_SHIFT;
+    int cbz = (int)floorf(z / CUBE_SIZE) >> COLLECTIBLE_BUCKET_SHIFT;
+    int max_ring = (int)(max_radius / (CUBE_SIZE * BUCKET_CELLS)) + 1;
+    float bucket_size = CUBE_SIZE * BUCKET_CELLS;
+
+    for (int ring = 0; ring <= max_ring; ring++) {
+        // Anything in this ring or beyond is at least this far from the query point.
+        float ring_min = (ring - 1) * bucket_size;
+        if (ring_min > 0.0f && found == k && ring_min * ring_min > best_sq[k - 1]) break;
+        if (ring_min > 0.0f && ring_min * ring_min > max_sq) break;
+
+        for (int bx = cbx - ring; bx <= cbx + ring; bx++) {
+            if (bx < 0 || bx >= index->buckets_x) continue;
+            bool edge_x = bx == cbx - ring || bx == cbx + ring;
+            for (int bz = cbz - ring; bz <= cbz + ring; bz += (edge_x || ring == 0) ? 1 : ring * 2) {
+                if (bz < 0 || bz >= index->buckets_z) continue;
+                int b = bx * index->buckets_z + bz;
+                if (index->bucket_active[b] == 0) continue;
+
+                for (int i = index->bucket_start[b]; i < index->bucket_start[b + 1]; i++) {
+                    const Collectible* item = &index->items[i];
+                    if (!item->active) continue;
+                    float d = distance_sq(item, x, z);
+                    if (d > max_sq || (found == k && d >= best_sq[k - 1])) continue;
+
+                    int pos = found < k ? found++ : k - 1;
+                    while (pos > 0 && best_sq[pos - 1] > d) {
+                        best_sq[pos] = best_sq[pos - 1];
+                        out[pos] = out[pos - 1];
+                        pos--;
+                    }
+                    best_sq[pos] = d;
+                    out[pos] = i;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+void collectibles_free(CollectibleIndex* index) {
+    free(index->items);
+    free(index->bucket_start);
+    free(index->bucket_active);
+    memset(index, 0, sizeof(*index));
+}
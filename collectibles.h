@@ -0,0 +1,31 @@
+#ifndef COLLECTIBLES_H
+#define COLLECTIBLES_H
+
+#include <stdbool.h>
+#include "world.h"
+
+#define COLLECTIBLE_BUCKET_SHIFT 3
+
+typedef struct {
+    float x, z;
+    int cell_x, cell_z;
+    bool active;
+} Collectible;
+
+typedef struct {
+    Collectible* items;
+    int count;
+    int active_count;
+    int buckets_x, buckets_z;
+    int* bucket_start;
+    int* bucket_active;
+} CollectibleIndex;
+
+bool collectibles_build(CollectibleIndex* index, const World* world);
+void collectibles_reset(CollectibleIndex* index);
+int collectibles_remove_at(CollectibleIndex* index, int cell_x, int cell_z);
+int collectibles_nearest(const CollectibleIndex* index, float x, float z, float max_radius, int k, int* out);
+int collectibles_in_radius(const CollectibleIndex* index, float x, float z, float radius, int* out, int max_out);
+void collectibles_free(CollectibleIndex* index);
+
+#endif
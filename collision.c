@@ -0,0 +1,91 @@
+#include <stdlib.h>
+#include <string.h>
+#include "collision.h"
+#include "config.h"
+
+bool collision_map_build(CollisionMap* map, const World* world, bool exit_solid) {
+    map->width = world->width;
+    map->height = world->height;
+    map->stride = (world->width + 2 + 63) / 64;
+    map->bits = calloc((size_t)map->stride * (world->height + 2), sizeof(uint64_t));
+    if (!map->bits) return false;
+
+    for (int z = -1; z <= world->height; z++) {
+        for (int x = -1; x <= world->width; x++) {
+            bool solid = world_get(world, x, z) == 1 || (exit_solid && world_is_exit(world, x, z));
+            if (solid) collision_map_set(map, x, z, true);
+        }
+    }
+    return true;
+}
+
+void collision_map_set(CollisionMap* map, int x, int z, bool solid) {
+    if (x < -1 || x > map->width || z < -1 || z > map->height) return;
+    int bit = x + 1;
+    uint64_t* word = &map->bits[(size_t)(z + 1) * map->stride + (bit >> 6)];
+    uint64_t mask = (uint64_t)1 << (bit & 63);
+    *word = solid ? (*word | mask) : (*word & ~mask);
+}
+
+void collision_map_free(CollisionMap* map) {
+    free(map->bits);
+    map->bits = NULL;
+}
+
+bool collision_bodies_init(CollisionBodies* bodies, int capacity) {
+    memset(bodies, 0, sizeof(*bodies));
+    float* block = calloc((size_t)capacity * 4, sizeof(float));
+    if (!block) return false;
+    bodies->x = block;
+    bodies->z = block + capacity;
+    bodies->vx = block + capacity * 2;
+    bodies->vz = block + capacity * 3;
+    bodies->capacity = capacity;
+    return true;
+}
+
+void collision_bodies_free(CollisionBodies* bodies) {
+    free(bodies->x);
+    memset(bodies, 0, sizeof(*bodies));
+}
+
+static inline int clamp_cell(float v, int max) {
+    v = v < -1.0f ? -1.0f : v;
+    v = v > (float)max ? (float)max : v;
+    return (int)(v + 1.0f) - 1;
+}
+
+// Cells overlapped by [lo, hi) on one axis; hi is nudged down so touching a wall is not a hit.
+static inline void cell_span(float lo, float hi, int max, int* c0, int* c1) {
+    *c0 = clamp_cell(lo * (1.0f / CUBE_SIZE), max);
+    *c1 = clamp_cell(hi * (1.0f / CUBE_SIZE) - 1e-5f, max);
+}
+
+static inline uint64_t box_hits(const CollisionMap* map, float x, float z, float half_size) {
+    int x0, x1, z0, z1;
+    cell_span(x - half_size, x + half_size, map->width, &x0, &x1);
+    cell_span(z - half_size, z + half_size, map->height, &z0, &z1);
+    return collision_map_solid(map, x0, z0) | collision_map_solid(map, x1, z0) |
+           collision_map_solid(map, x0, z1) | collision_map_solid(map, x1, z1);
+}
+
+void collision_move(const CollisionMap* map, CollisionBodies* bodies, float half_size, float dt) {
+    float* restrict xs = bodies->x;
+    float* restrict zs = bodies->z;
+    const float* restrict vxs = bodies->vx;
+    const float* restrict vzs = bodies->vz;
+
+    // half_size must stay below half a cell so a box spans at most 2x2 cells.
+    for (int i = 0; i < bodies->count; i++) {
+        float x = xs[i], z = zs[i];
+
+        float nx = x + vxs[i] * dt;
+        x = box_hits(map, nx, z, half_size) ? x : nx;
+
+        float nz = z + vzs[i] * dt;
+        z = box_hits(map, x, nz, half_size) ? z : nz;
+
+        xs[i] = x;
+        zs[i] = z;
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "world.h"
+
+typedef struct {
+    int width, height;
+    int stride;
+    uint64_t* bits;
+} CollisionMap;
+
+typedef struct {
+    float* x;
+    float* z;
+    float* vx;
+    float* vz;
+    int count, capacity;
+} CollisionBodies;
+
+bool collision_map_build(CollisionMap* map, const World* world, bool exit_solid);
+void collision_map_set(CollisionMap* map, int x, int z, bool solid);
+void collision_map_free(CollisionMap* map);
+
+bool collision_bodies_init(CollisionBodies* bodies, int capacity);
+void collision_bodies_free(CollisionBodies* bodies);
+
+void collision_move(const CollisionMap* map, CollisionBodies* bodies, float half_size, float dt);
+
+// The map has a solid one-cell border, so cells from -1 to width/height are valid.
+static inline uint64_t collision_map_solid(const CollisionMap* map, int x, int z) {
+    int bit = x + 1;
+    return (map->bits[(size_t)(z + 1) * map->stride + (bit >> 6)] >> (bit & 63)) & 1;
+}
+
+#endif
@@ -7,8 +7,42 @@
 #define WALL_HEIGHT 1.5f
 #define PLAYER_SIZE 0.2f
 
+#define PVS_RADIUS 24
+#define PVS_CELLS_PER_FRAME 8
+
+#define CHUNK_RESIDENT_RADIUS 1
+#define CHUNK_CACHE_SLOTS 16
+#define CHUNK_BUILDS_PER_FRAME 2
+
+#define LIGHT_RADIUS 5.0f
+#define LIGHT_CLUSTER_CELLS 2
+
+#define LIGHTMAP_TEXELS 8
+#define LIGHTMAP_RAYS 64
+#define LIGHTMAP_AO_DISTANCE 1.0f
+#define LIGHTMAP_MAX_CHUNKS 16
+
+#define TEXTURE_STREAM_BUDGET_MS 2.0
+#define TEXTURE_BUDGET_MB 24
+
 #define ESCAPE_SECONDS 30.0f
 
+#define SIM_HZ 60
+#define SIM_DT (1.0 / SIM_HZ)
+#define MAX_FRAME_TIME 0.25
+#define PLAYER_SPEED 1.8f
+#define PLAYER_FALL_SPEED 6.0f
+
+#define CHASER_SPEED 1.2f
+#define CHASER_SIZE 0.3f
+#define CHASER_SEPARATION 0.35f
+#define CHASER_AVOIDANCE 1.5f
+#define CHASER_CATCH_DISTANCE 0.3f
+#define CHASER_SENSE_RADIUS 48
+#define CHASER_SPAWN_DISTANCE 6
+#define CHASER_JOB_GRAIN 64
+#define CHASER_BILLBOARD_SIZE 0.5f
+
 #define PI 3.1415926535
 #define PITCH_LIMIT 1.55f
 
@@ -23,6 +57,7 @@ typedef enum {
 
 typedef struct {
     float x, y, z;
+    float prev_x, prev_y, prev_z;
     float angle;
     float pitch;
     float speed;
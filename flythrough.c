@@ -0,0 +1,120 @@
+#include <stdlib.h>
+#include <math.h>
+#include "flythrough.h"
+
+#define FLYTHROUGH_LOOK_AHEAD 0.6f
+
+static bool is_open(const World* world, int x, int z) {
+    return world_is_exit(world, x, z) || (world_in_bounds(world, x, z) && world_get(world, x, z) != 1);
+}
+
+bool flythrough_build(Flythrough* path, const World* world) {
+    static const int dx[4] = {1, -1, 0, 0};
+    static const int dz[4] = {0, 0, 1, -1};
+
+    path->points = NULL;
+    path->point_count = 0;
+    path->length = 0.0f;
+
+    size_t cells = (size_t)world->width * world->height;
+    int* parent = malloc(cells * sizeof(int));
+    int* queue = malloc(cells * sizeof(int));
+    if (!parent || !queue) {
+        free(parent);
+        free(queue);
+        return false;
+    }
+    for (size_t i = 0; i < cells; i++) parent[i] = -1;
+
+    int start = (int)(world->start_x / CUBE_SIZE) * world->height + (int)(world->start_z / CUBE_SIZE);
+    int goal = world->exit_x * world->height + world->exit_z;
+    int head = 0, tail = 0;
+    queue[tail++] = start;
+    parent[start] = start;
+
+    while (head < tail && parent[goal] < 0) {
+        int cell = queue[head++];
+        int x = cell / world->height, z = cell % world->height;
+        for (int d = 0; d < 4; d++) {
+            int nx = x + dx[d], nz = z + dz[d];
+            if (!is_open(world, nx, nz)) continue;
+            int next = nx * world->height + nz;
+            if (parent[next] >= 0) continue;
+            parent[next] = cell;
+            queue[tail++] = next;
+        }
+    }
+
+    bool found = parent[goal] >= 0;
+    if (found) {
+        int count = 1;
+        for (int cell = goal; cell != start; cell = parent[cell]) count++;
+
+        path->points = malloc((size_t)count * 2 * sizeof(float));
+        found = path->points != NULL;
+        if (found) {
+            int i = count - 1;
+            for (int cell = goal;; cell = parent[cell], i--) {
+                path->points[i * 2] = (cell / world->height + 0.5f) * CUBE_SIZE;
+                path->points[i * 2 + 1] = (cell % world->height + 0.5f) * CUBE_SIZE;
+                if (cell == start) break;
+            }
+            path->point_count = count;
+            path->length = (float)(count - 1);
+        }
+    }
+
+    free(parent);
+    free(queue);
+    return found && path->point_count > 1;
+}
+
+static void spline_point(const Flythrough* path, float s, float* x, float* z) {
+    int last = path->point_count - 1;
+    if (s <= 0.0f) s = 0.0f;
+    if (s >= last) s = (float)last;
+
+    // Cell centres are one unit apart, so the spline parameter doubles as arc length.
+    int i = (int)s;
+    if (i >= last) i = last - 1;
+    float t = s - i;
+
+    const float* p = path->points;
+    int i0 = i > 0 ? i - 1 : 0, i1 = i, i2 = i + 1, i3 = i + 2 <= last ? i + 2 : last;
+    float t2 = t * t, t3 = t2 * t;
+    float w0 = -0.5f * t3 + t2 - 0.5f * t;
+    float w1 = 1.5f * t3 - 2.5f * t2 + 1.0f;
+    float w2 = -1.5f * t3 + 2.0f * t2 + 0.5f * t;
+    float w3 = 0.5f * t3 - 0.5f * t2;
+    *x = w0 * p[i0 * 2] + w1 * p[i1 * 2] + w2 * p[i2 * 2] + w3 * p[i3 * 2];
+    *z = w0 * p[i0 * 2 + 1] + w1 * p[i1 * 2 + 1] + w2 * p[i2 * 2 + 1] + w3 * p[i3 * 2 + 1];
+}
+
+void flythrough_sample(const Flythrough* path, float distance, Player* view) {
+    float lap = fmodf(distance, path->length * 2.0f);
+    bool returning = lap > path->length;
+    float s = returning ? path->length * 2.0f - lap : lap;
+    float ahead = returning ? s - FLYTHROUGH_LOOK_AHEAD : s + FLYTHROUGH_LOOK_AHEAD;
+
+    float x, z, ax, az;
+    spline_point(path, s, &x, &z);
+    spline_point(path, ahead, &ax, &az);
+    if (ax == x && az == z) {
+        spline_point(path, returning ? s + FLYTHROUGH_LOOK_AHEAD : s - FLYTHROUGH_LOOK_AHEAD, &ax, &az);
+        ax = 2.0f * x - ax;
+        az = 2.0f * z - az;
+    }
+
+    view->x = view->prev_x = x;
+    view->y = view->prev_y = 0.5f;
+    view->z = view->prev_z = z;
+    view->angle = atan2f(-(az - z), ax - x);
+    view->pitch = 0.0f;
+    view->speed = PLAYER_SPEED;
+}
+
+void flythrough_free(Flythrough* path) {
+    free(path->points);
+    path->points = NULL;
+    path->point_count = 0;
+}
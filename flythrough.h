@@ -0,0 +1,18 @@
+#ifndef FLYTHROUGH_H
+#define FLYTHROUGH_H
+
+#include <stdbool.h>
+#include "config.h"
+#include "world.h"
+
+typedef struct {
+    float* points;
+    int point_count;
+    float length;
+} Flythrough;
+
+bool flythrough_build(Flythrough* path, const World* world);
+void flythrough_sample(const Flythrough* path, float distance, Player* view);
+void flythrough_free(Flythrough* path);
+
+#endif
@@ -0,0 +1,42 @@
+#include <GL/glut.h>
+#include <math.h>
+#include "frustum.h"
+
+static float planes[6][4];
+
+void frustum_update() {
+    float proj[16], view[16], clip[16];
+    glGetFloatv(GL_PROJECTION_MATRIX, proj);
+    glGetFloatv(GL_MODELVIEW_MATRIX, view);
+
+    for (int c = 0; c < 4; c++) {
+        for (int r = 0; r < 4; r++) {
+            clip[c * 4 + r] = view[c * 4 + 0] * proj[0 * 4 + r] + view[c * 4 + 1] * proj[1 * 4 + r] +
+                              view[c * 4 + 2] * proj[2 * 4 + r] + view[c * 4 + 3] * proj[3 * 4 + r];
+        }
+    }
+
+    for (int i = 0; i < 3; i++) {
+        for (int k = 0; k < 4; k++) {
+            planes[i * 2][k] = clip[k * 4 + 3] + clip[k * 4 + i];
+            planes[i * 2 + 1][k] = clip[k * 4 + 3] - clip[k * 4 + i];
+        }
+    }
+
+    for (int i = 0; i < 6; i++) {
+        float len = sqrtf(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] + planes[i][2] * planes[i][2]);
+        if (len > 0.0f) {
+            for (int k = 0; k < 4; k++) planes[i][k] /= len;
+        }
+    }
+}
+
+bool frustum_test_box(float min_x, float min_y, float min_z, float max_x, float max_y, float max_z) {
+    for (int i = 0; i < 6; i++) {
+        float px = planes[i][0] > 0 ? max_x : min_x;
+        float py = planes[i][1] > 0 ? max_y : min_y;
+        float pz = planes[i][2] > 0 ? max_z : min_z;
+        if (planes[i][0] * px + planes[i][1] * py + planes[i][2] * pz + planes[i][3] < 0) return false;
+    }
+    return true;
+}
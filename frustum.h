@@ -0,0 +1,9 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <stdbool.h>
+
+void frustum_update();
+bool frustum_test_box(float min_x, float min_y, float min_z, float max_x, float max_y, float max_z);
+
+#endif
@@ -1,103 +1,363 @@
 #include <GL/glut.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <math.h>
 #include "game.h"
 #include "config.h"
 #include "render.h"
 #include "player.h"
 #include "ui.h"
+#include "world.h"
+#include "mazegen.h"
+#include "sim.h"
+#include "replay.h"
+#include "profiler.h"
+#include "gpu_timer.h"
+#include "benchmark.h"
+#include "platform.h"
+#include "thread.h"
+#include "snapshot.h"
+#include "input_queue.h"
+#include "jobs.h"
 
-static GameState game_state;
-static GameState previous_game_state;
-static int collectibles_eaten = 0;
-static int total_collectibles = 0;
-static float escape_timer = ESCAPE_SECONDS;
-
-static int maze_grid[MAZE_WIDTH][MAZE_HEIGHT] = {
-    {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1}, {1,0,0,1,0,0,0,0,0,1,1,0,1,2,1}, {1,1,0,1,1,1,0,1,0,0,1,0,1,0,1},
-    {1,0,0,0,0,1,0,1,0,1,1,0,0,0,1}, {1,0,1,1,0,1,0,1,0,1,0,0,1,0,1}, {1,0,0,1,0,1,0,0,0,1,0,0,1,0,1},
-    {1,1,0,1,0,0,1,1,1,1,0,1,1,0,1}, {1,0,0,0,0,1,1,0,0,0,0,0,0,0,1}, {1,0,1,1,1,1,0,0,1,0,1,1,1,0,1},
-    {1,0,0,0,0,0,0,1,1,0,0,0,1,0,1}, {1,0,1,1,1,1,0,1,0,1,1,0,1,2,1}, {1,0,0,0,0,1,0,0,0,0,1,0,0,0,1},
-    {1,1,1,0,1,1,1,1,1,0,1,1,1,0,1}, {1,0,0,0,0,0,0,0,1,0,0,0,0,0,1}, {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1}
-};
-static int initial_maze_grid[MAZE_WIDTH][MAZE_HEIGHT];
-
-
-void reset_game() {
-    player_init();
-    collectibles_eaten = 0;
-    escape_timer = ESCAPE_SECONDS;
-    memcpy(maze_grid, initial_maze_grid, sizeof(maze_grid));
-    game_set_state(STATE_PLAYING);
-    render_update_ambient_light(collectibles_eaten, total_collectibles, game_get_state());
-    glutSetCursor(GLUT_CURSOR_NONE);
-}
-
-bool game_init() {
+#define LOOK_SENSITIVITY 0.003f
+
+static World level;
+
+// Owned by the simulation thread once game_start has run.
+static Sim sim;
+static bool key_states[256] = {false};
+static float pending_turn = 0.0f, pending_tilt = 0.0f;
+static double consumed_turn = 0.0, consumed_tilt = 0.0;
+static unsigned char pending_commands[REPLAY_MAX_COMMANDS];
+static int pending_command_count = 0;
+static Replay recording, playback;
+static bool is_recording = false, is_playing_back = false;
+static CellChange* pickups = NULL;
+static int pickup_count = 0, pickup_generation = 0;
+
+// Shared by both threads.
+static SnapshotBuffer snapshots;
+static InputQueue input_queue;
+static Thread* sim_thread = NULL;
+static volatile int sim_running = 0;
+
+// Owned by the window thread, which renders from its own copy of the collectibles.
+static CollectibleIndex view_collectibles;
+static const SimSnapshot* current = NULL;
+// Snapshot times are relative to this, so the render time stays small enough for a float.
+static double start_time = 0.0;
+static double sent_turn = 0.0, sent_tilt = 0.0;
+static int synced_generation = -1, applied_changes = 0;
+static GameState synced_state = STATE_MAIN_MENU;
+static int synced_eaten = -1;
+static BillboardInstance* view_chasers = NULL;
+// Set by the window when the guide is first shown; its fields are only built then.
+static volatile int guide_wanted = 0;
+
+bool game_init(const LevelConfig* config, const char* record_path, const char* replay_path) {
     if (!render_init()) return false;
+    if (!ui_init()) return false;
 
-    memcpy(initial_maze_grid, maze_grid, sizeof(maze_grid));
-    total_collectibles = 0;
-    for (int x = 0; x < MAZE_WIDTH; x++) {
-        for (int z = 0; z < MAZE_HEIGHT; z++) {
-            if (maze_grid[x][z] == 2) total_collectibles++;
+    LevelConfig level_config = {0, 0, MAZEGEN_BACKTRACKER, 0, 0};
+    if (config) level_config = *config;
+    if (replay_path) {
+        if (!replay_open_read(&playback, replay_path)) return false;
+        level_config = playback.level;
+        is_playing_back = true;
+    }
+
+    if (!sim_load_level(&level, &level_config)) return false;
+    if (level_config.size > 0) {
+        printf("Labirinto %dx%d (%s, semente %u)\n", level.width, level.height,
+               mazegen_algorithm_name(level_config.algorithm), level_config.seed);
+    }
+    if (!sim_init(&sim, &level)) return false;
+    if (level_config.chasers > 0) {
+        if (!jobs_init(0) || !sim_enable_chasers(&sim, level_config.chasers)) {
+            fprintf(stderr, "Falha ao criar os perseguidores\n");
+            return false;
         }
+        printf("%d perseguidores em %d threads\n", level_config.chasers, jobs_thread_count());
     }
+    if (!collectibles_build(&view_collectibles, &level)) return false;
+    pickups = malloc((sim.total_collectibles > 0 ? sim.total_collectibles : 1) * sizeof(CellChange));
+    if (!pickups || !snapshot_buffer_init(&snapshots, sim.total_collectibles, sim.chasers.count)) return false;
+    view_chasers = malloc((sim.chasers.count > 0 ? sim.chasers.count : 1) * sizeof(BillboardInstance));
+    if (!view_chasers) return false;
+    input_queue_init(&input_queue);
+    render_load_level(&level);
+    render_set_state_textures(sim.state);
 
-    player_init();
-    game_state = STATE_MAIN_MENU;
+    if (record_path && !is_playing_back) {
+        if (!replay_open_write(&recording, record_path, &level_config)) return false;
+        is_recording = true;
+    }
     return true;
 }
 
-void game_update() {
-    glutPostRedisplay();
+int game_run_benchmark(const RenderBenchConfig* config) {
+    render_update_ambient_light(sim.total_collectibles, sim.total_collectibles, STATE_ESCAPING);
+    render_set_state_textures(STATE_ESCAPING);
+    if (config->max_lights > 0) return benchmark_render_lights(&level, config);
+    return benchmark_render_flythrough(&level, config);
+}
 
-    if (game_state == STATE_PLAYING || game_state == STATE_ESCAPING) {
-        player_update(maze_grid);
+static void apply_input_event(const InputEvent* event) {
+    switch (event->type) {
+        case INPUT_EVENT_KEY:
+            key_states[event->key] = event->pressed;
+            break;
+        case INPUT_EVENT_LOOK:
+            pending_turn += event->turn;
+            pending_tilt += event->tilt;
+            break;
+        case INPUT_EVENT_COMMAND:
+            if (is_playing_back) return;
+            if (!sim_command(&sim, event->command)) return;
+            if (pending_command_count < REPLAY_MAX_COMMANDS) {
+                pending_commands[pending_command_count++] = (unsigned char)event->command;
+            }
+            break;
+    }
+}
 
-        int px = (int)(player_get()->x / CUBE_SIZE);
-        int pz = (int)(player_get()->z / CUBE_SIZE);
+static void log_pickup(int events) {
+    if (sim.generation != pickup_generation) {
+        pickup_generation = sim.generation;
+        pickup_count = 0;
+    }
+    if ((events & SIM_EVENT_PICKUP) && pickup_count < sim.total_collectibles) {
+        pickups[pickup_count].x = sim.last_pickup_x;
+        pickups[pickup_count].z = sim.last_pickup_z;
+        pickup_count++;
+    }
+}
+
+static void update_simulation(float dt) {
+    int events = 0;
+    profiler_begin(PROFILE_GAME_UPDATE);
 
-        if (px >= 0 && px < MAZE_WIDTH && pz >= 0 && pz < MAZE_HEIGHT) {
-            if (maze_grid[px][pz] == 2) {
-                maze_grid[px][pz] = 0;
-                collectibles_eaten++;
-                render_update_ambient_light(collectibles_eaten, total_collectibles, game_get_state());
+    if (!sim.guide_enabled && thread_atomic_exchange(&guide_wanted, 0)) {
+        if (!sim_enable_guide(&sim)) fprintf(stderr, "Falha ao preparar o guia do labirinto\n");
+    }
 
-                if (collectibles_eaten == total_collectibles) {
-                    game_set_state(STATE_ESCAPING);
-                    render_update_ambient_light(collectibles_eaten, total_collectibles, game_get_state());
-                }
+    if (is_playing_back) {
+        ReplayStatus status = replay_step(&playback, &sim, dt, &events);
+        if (status != REPLAY_OK) {
+            if (status == REPLAY_DIVERGED) {
+                printf("Replay divergiu no tick %ld\n", playback.tick);
+            } else {
+                printf("Replay concluido: %ld ticks\n", playback.tick);
             }
+            replay_close(&playback);
+            is_playing_back = false;
         }
+    } else {
+        ReplayTick tick;
+        PlayerInput input = {key_states['w'], key_states['s'], key_states['a'], key_states['d'], pending_turn, pending_tilt};
+        consumed_turn += pending_turn;
+        consumed_tilt += pending_tilt;
+        pending_turn = pending_tilt = 0.0f;
+        events = sim_step(&sim, &input, dt);
 
-        if (game_state == STATE_ESCAPING) {
-            escape_timer -= 16.0f / 1000.0f;
-            if (player_get()->y < -8.0f) {
-                 game_set_state(STATE_WON);
-                 glutSetCursor(GLUT_CURSOR_INHERIT);
-            } else if (escape_timer <= 0.0f) {
-                escape_timer = 0.0f;
-                game_set_state(STATE_LOST);
-                glutSetCursor(GLUT_CURSOR_INHERIT);
-            }
+        if (is_recording) {
+            tick.input = input;
+            memcpy(tick.commands, pending_commands, sizeof(pending_commands));
+            tick.command_count = pending_command_count;
+            tick.hash = sim_hash(&sim);
+            replay_write_tick(&recording, &tick);
         }
+        pending_command_count = 0;
     }
+
+    log_pickup(events);
+    profiler_end(PROFILE_GAME_UPDATE);
+    profiler_end_tick();
 }
 
+static void publish_snapshot(double time) {
+    SimSnapshot* snapshot = snapshot_write_begin(&snapshots);
+    if (snapshot->generation != pickup_generation || snapshot->change_count > pickup_count) {
+        snapshot->change_count = 0;
+    }
+    snapshot->generation = pickup_generation;
+    snapshot->time = time;
+    snapshot->player = sim.player;
+    snapshot->state = sim.state;
+    snapshot->collectibles_eaten = sim.collectibles_eaten;
+    snapshot->total_collectibles = sim.total_collectibles;
+    snapshot->escape_timer = sim.escape_timer;
+    snapshot->playing_back = is_playing_back;
+    snapshot->look_turn = consumed_turn;
+    snapshot->look_tilt = consumed_tilt;
+    snapshot->guide_distance = sim_guide(&sim, &snapshot->guide_next);
+    // Only the pickups this slot has not seen yet are copied.
+    memcpy(snapshot->changes + snapshot->change_count, pickups + snapshot->change_count,
+           (pickup_count - snapshot->change_count) * sizeof(CellChange));
+    snapshot->change_count = pickup_count;
+    const Chasers* chasers = &sim.chasers;
+    snapshot->chaser_count = sim.state == STATE_MAIN_MENU ? 0 : chasers->count;
+    memcpy(snapshot->chaser_x, chasers->bodies.x, snapshot->chaser_count * sizeof(float));
+    memcpy(snapshot->chaser_z, chasers->bodies.z, snapshot->chaser_count * sizeof(float));
+    memcpy(snapshot->chaser_prev_x, chasers->prev_x, snapshot->chaser_count * sizeof(float));
+    memcpy(snapshot->chaser_prev_z, chasers->prev_z, snapshot->chaser_count * sizeof(float));
+    snapshot_publish(&snapshots);
+}
+
+// Runs the fixed-step simulation against the wall clock. Input events are
+// applied on the first tick that ends after they happened.
+static void simulation_thread(void* arg) {
+    double next_tick = platform_time_seconds() + SIM_DT;
+    while (thread_atomic_load(&sim_running)) {
+        double now = platform_time_seconds();
+        if (now < next_tick) {
+            thread_sleep(next_tick - now);
+            continue;
+        }
+        if (now - next_tick > MAX_FRAME_TIME) next_tick = now - MAX_FRAME_TIME;
+
+        InputEvent event;
+        while (input_queue_peek(&input_queue, &event) && event.time <= next_tick) {
+            apply_input_event(&event);
+            input_queue_pop(&input_queue);
+        }
+        update_simulation((float)SIM_DT);
+        publish_snapshot(next_tick);
+        next_tick += SIM_DT;
+    }
+}
+
+bool game_start() {
+    start_time = platform_time_seconds();
+    publish_snapshot(start_time);
+    current = snapshot_acquire(&snapshots);
+    sim_running = 1;
+    sim_thread = thread_start(simulation_thread, NULL);
+    return sim_thread != NULL;
+}
+
+static bool queue_event(InputEvent* event) {
+    event->time = platform_time_seconds();
+    return input_queue_push(&input_queue, event);
+}
+
+static void game_command(SimCommand command) {
+    InputEvent event = {0};
+    event.type = INPUT_EVENT_COMMAND;
+    event.command = command;
+    queue_event(&event);
+}
+
+// Brings the window thread's view of the game up to the newest snapshot.
+static void sync_frontend() {
+    current = snapshot_acquire(&snapshots);
+    if (current->generation != synced_generation) {
+        collectibles_reset(&view_collectibles);
+        synced_generation = current->generation;
+        applied_changes = 0;
+    }
+    for (; applied_changes < current->change_count; applied_changes++) {
+        const CellChange* change = &current->changes[applied_changes];
+        collectibles_remove_at(&view_collectibles, change->x, change->z);
+    }
+
+    if (current->state == synced_state && current->collectibles_eaten == synced_eaten) return;
+    synced_state = current->state;
+    synced_eaten = current->collectibles_eaten;
+    render_update_ambient_light(current->collectibles_eaten, current->total_collectibles, current->state);
+    render_set_state_textures(current->state);
+    bool in_game = current->state == STATE_PLAYING || current->state == STATE_ESCAPING;
+    glutSetCursor(in_game ? GLUT_CURSOR_NONE : GLUT_CURSOR_INHERIT);
+}
+
+void game_handle_keyboard(unsigned char key, bool is_pressed) {
+    if (key >= 'A' && key <= 'Z') key = tolower(key);
+    if (key >= 'a' && key <= 'z') {
+        InputEvent event = {0};
+        event.type = INPUT_EVENT_KEY;
+        event.key = key;
+        event.pressed = is_pressed;
+        queue_event(&event);
+    }
+
+    if (is_pressed) {
+        if (key == 27) {
+             game_command(SIM_COMMAND_PAUSE);
+        }
+    }
+}
+
+void game_handle_special_key(int key) {
+    if (key == GLUT_KEY_F2 && ui_toggle_guide()) thread_atomic_store(&guide_wanted, 1);
+    if (key == GLUT_KEY_F3) ui_toggle_profiler_overlay();
+}
+
+void game_handle_mouse_motion(int x, int y) {
+    if (current->playing_back) return;
+    if (current->state == STATE_PLAYING || current->state == STATE_ESCAPING) {
+        int w_center = render_window_width() / 2;
+        int h_center = render_window_height() / 2;
+        if (x == w_center && y == h_center) return;
+
+        InputEvent event = {0};
+        event.type = INPUT_EVENT_LOOK;
+        event.turn = (x - w_center) * LOOK_SENSITIVITY;
+        event.tilt = (y - h_center) * LOOK_SENSITIVITY;
+        if (queue_event(&event)) {
+            sent_turn += event.turn;
+            sent_tilt += event.tilt;
+        }
+        glutWarpPointer(w_center, h_center);
+    }
+}
+
+// Angle of the guide's next cell from where the view is facing, positive to the right.
+static float guide_angle(const SimSnapshot* s, const Player* view) {
+    float dx = (s->guide_next.x + 0.5f) * CUBE_SIZE - view->x;
+    float dz = (s->guide_next.z + 0.5f) * CUBE_SIZE - view->z;
+    float ahead = dx * cos(view->angle) - dz * sin(view->angle);
+    float right = dx * sin(view->angle) + dz * cos(view->angle);
+    return atan2f(right, ahead);
+}
+
+static void interpolate_chasers(const SimSnapshot* s, float alpha) {
+    for (int i = 0; i < s->chaser_count; i++) {
+        BillboardInstance* b = &view_chasers[i];
+        b->x = s->chaser_prev_x[i] + (s->chaser_x[i] - s->chaser_prev_x[i]) * alpha;
+        b->z = s->chaser_prev_z[i] + (s->chaser_z[i] - s->chaser_prev_z[i]) * alpha;
+        b->y = CHASER_BILLBOARD_SIZE / 2.0f;
+        b->size = CHASER_BILLBOARD_SIZE;
+    }
+    render_set_chasers(view_chasers, s->chaser_count);
+}
 
 void game_render() {
+    sync_frontend();
     render_start_frame();
 
-    if (game_state != STATE_MAIN_MENU) {
-        render_scene(maze_grid, game_state);
+    const SimSnapshot* s = current;
+    Player view = s->player;
+    if (s->state != STATE_MAIN_MENU) {
+        float alpha = (float)((platform_time_seconds() - s->time) / SIM_DT);
+        if (alpha < 0.0f) alpha = 0.0f;
+        if (alpha > 1.0f) alpha = 1.0f;
+        view = player_get_view(&s->player, alpha);
+        // Look input still on its way to the simulation is applied right away.
+        player_look(&view, (float)(sent_turn - s->look_turn), (float)(sent_tilt - s->look_tilt));
+        interpolate_chasers(s, alpha);
+        render_scene(&level, &view_collectibles, &view, s->state, (float)(s->time + alpha * SIM_DT - start_time));
     }
 
-    if (game_state == STATE_PLAYING || game_state == STATE_ESCAPING) {
-        ui_draw_game_hud(collectibles_eaten, total_collectibles, escape_timer, game_state);
+    gpu_timer_begin(PROFILE_UI);
+    if (s->state == STATE_PLAYING || s->state == STATE_ESCAPING) {
+        ui_set_guide(s->guide_distance, guide_angle(s, &view));
+        ui_draw_game_hud(s->collectibles_eaten, s->total_collectibles, s->escape_timer, s->state);
     }
 
-    switch (game_state) {
+    switch (s->state) {
         case STATE_MAIN_MENU:
             ui_draw_main_menu();
             break;
@@ -105,13 +365,14 @@ void game_render() {
             ui_draw_pause_menu();
             break;
         case STATE_WON:
-            ui_draw_end_screen("win_bg");
+            ui_draw_end_screen(RENDER_TEXTURE_WIN_BG);
             break;
         case STATE_LOST:
-            ui_draw_end_screen("loser_bg");
+            ui_draw_end_screen(RENDER_TEXTURE_LOSER_BG);
             break;
         default: break;
     }
+    gpu_timer_end(PROFILE_UI);
 
     render_end_frame();
 }
@@ -129,41 +390,45 @@ void game_handle_mouse_click(int button, int state, int x, int y) {
         if (choice == 0) return;
 
         if (current_state == STATE_MAIN_MENU) {
-            if (choice == 1) reset_game();
+            if (choice == 1) game_command(SIM_COMMAND_START);
             if (choice == 2) game_cleanup();
         }
         else if (current_state == STATE_PAUSED) {
-            if (choice == 1) {
-                 game_set_state(game_get_previous_state());
-                 glutSetCursor(GLUT_CURSOR_NONE);
-            }
-            if (choice == 2) game_set_state(STATE_MAIN_MENU);
+            if (choice == 1) game_command(SIM_COMMAND_RESUME);
+            if (choice == 2) game_command(SIM_COMMAND_MENU);
             if (choice == 3) game_cleanup();
         }
         else if (current_state == STATE_WON || current_state == STATE_LOST) {
-            if (choice == 1) game_set_state(STATE_MAIN_MENU);
+            if (choice == 1) game_command(SIM_COMMAND_MENU);
             if (choice == 2) game_cleanup();
         }
     }
 }
 
-
-void game_set_state(GameState new_state) {
-    if (new_state == STATE_PAUSED) {
-        previous_game_state = game_state;
-    }
-    game_state = new_state;
-}
-
 GameState game_get_state() {
-    return game_state;
-}
-
-GameState game_get_previous_state() {
-    return previous_game_state;
+    return current ? current->state : sim.state;
 }
 
 void game_cleanup() {
+    if (sim_thread) {
+        thread_atomic_store(&sim_running, 0);
+        thread_join(sim_thread);
+        sim_thread = NULL;
+    }
+    jobs_shutdown();
+    if (is_recording) {
+        printf("Replay gravado: %ld ticks\n", recording.tick);
+        replay_close(&recording);
+    }
+    if (is_playing_back) replay_close(&playback);
+    profiler_shutdown();
+    ui_cleanup();
     render_cleanup();
+    sim_free(&sim);
+    collectibles_free(&view_collectibles);
+    snapshot_buffer_free(&snapshots);
+    free(pickups);
+    free(view_chasers);
+    world_destroy(&level);
     exit(0);
 }
@@ -3,15 +3,21 @@
 
 #include <stdbool.h>
 #include "config.h"
+#include "mazegen.h"
+#include "benchmark.h"
 
-bool game_init();
-void game_update();
+bool game_init(const LevelConfig* level, const char* record_path, const char* replay_path);
+int game_run_benchmark(const RenderBenchConfig* config);
+// Starts the simulation thread; from then on input is queued to it and
+// game_render draws its latest snapshot.
+bool game_start();
 void game_render();
 void game_reshape(int w, int h);
+void game_handle_keyboard(unsigned char key, bool is_pressed);
+void game_handle_special_key(int key);
+void game_handle_mouse_motion(int x, int y);
 void game_handle_mouse_click(int button, int state, int x, int y);
 void game_cleanup();
 GameState game_get_state();
-void game_set_state(GameState new_state);
-GameState game_get_previous_state();
 
 #endif
@@ -0,0 +1,223 @@
+#include <GL/glut.h>
+#include <GL/freeglut_ext.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "glload.h"
+
+PFNGLGENBUFFERSPROC gl_gen_buffers = NULL;
+PFNGLDELETEBUFFERSPROC gl_delete_buffers = NULL;
+PFNGLBINDBUFFERPROC gl_bind_buffer = NULL;
+PFNGLBUFFERDATAPROC gl_buffer_data = NULL;
+PFNGLMAPBUFFERPROC gl_map_buffer = NULL;
+PFNGLUNMAPBUFFERPROC gl_unmap_buffer = NULL;
+
+PFNGLGENQUERIESPROC gl_gen_queries = NULL;
+PFNGLDELETEQUERIESPROC gl_delete_queries = NULL;
+PFNGLBEGINQUERYPROC gl_begin_query = NULL;
+PFNGLENDQUERYPROC gl_end_query = NULL;
+PFNGLGETQUERYOBJECTIVPROC gl_get_query_objectiv = NULL;
+PFNGLGETQUERYOBJECTUI64VPROC gl_get_query_objectui64v = NULL;
+
+PFNGLGENFRAMEBUFFERSPROC gl_gen_framebuffers = NULL;
+PFNGLDELETEFRAMEBUFFERSPROC gl_delete_framebuffers = NULL;
+PFNGLBINDFRAMEBUFFERPROC gl_bind_framebuffer = NULL;
+PFNGLFRAMEBUFFERRENDERBUFFERPROC gl_framebuffer_renderbuffer = NULL;
+PFNGLCHECKFRAMEBUFFERSTATUSPROC gl_check_framebuffer_status = NULL;
+PFNGLGENRENDERBUFFERSPROC gl_gen_renderbuffers = NULL;
+PFNGLDELETERENDERBUFFERSPROC gl_delete_renderbuffers = NULL;
+PFNGLBINDRENDERBUFFERPROC gl_bind_renderbuffer = NULL;
+PFNGLRENDERBUFFERSTORAGEPROC gl_renderbuffer_storage = NULL;
+PFNGLGENERATEMIPMAPPROC gl_generate_mipmap = NULL;
+
+PFNGLCREATESHADERPROC gl_create_shader = NULL;
+PFNGLDELETESHADERPROC gl_delete_shader = NULL;
+PFNGLSHADERSOURCEPROC gl_shader_source = NULL;
+PFNGLCOMPILESHADERPROC gl_compile_shader = NULL;
+PFNGLGETSHADERIVPROC gl_get_shaderiv = NULL;
+PFNGLGETSHADERINFOLOGPROC gl_get_shader_info_log = NULL;
+PFNGLCREATEPROGRAMPROC gl_create_program = NULL;
+PFNGLDELETEPROGRAMPROC gl_delete_program = NULL;
+PFNGLATTACHSHADERPROC gl_attach_shader = NULL;
+PFNGLLINKPROGRAMPROC gl_link_program = NULL;
+PFNGLGETPROGRAMIVPROC gl_get_programiv = NULL;
+PFNGLGETPROGRAMINFOLOGPROC gl_get_program_info_log = NULL;
+PFNGLUSEPROGRAMPROC gl_use_program = NULL;
+PFNGLGETUNIFORMLOCATIONPROC gl_get_uniform_location = NULL;
+PFNGLGETATTRIBLOCATIONPROC gl_get_attrib_location = NULL;
+PFNGLUNIFORM1IPROC gl_uniform1i = NULL;
+PFNGLUNIFORM2FPROC gl_uniform2f = NULL;
+PFNGLUNIFORM1FPROC gl_uniform1f = NULL;
+PFNGLUNIFORM3FPROC gl_uniform3f = NULL;
+PFNGLUNIFORMMATRIX4FVPROC gl_uniform_matrix4fv = NULL;
+PFNGLACTIVETEXTUREPROC gl_active_texture = NULL;
+PFNGLENABLEVERTEXATTRIBARRAYPROC gl_enable_vertex_attrib_array = NULL;
+PFNGLDISABLEVERTEXATTRIBARRAYPROC gl_disable_vertex_attrib_array = NULL;
+PFNGLVERTEXATTRIBPOINTERPROC gl_vertex_attrib_pointer = NULL;
+
+PFNGLDRAWELEMENTSINSTANCEDPROC gl_draw_elements_instanced = NULL;
+PFNGLVERTEXATTRIBDIVISORPROC gl_vertex_attrib_divisor = NULL;
+
+static bool has_vbo = false;
+static bool has_timer_query = false;
+static bool has_fbo = false;
+static bool has_shaders = false;
+static bool has_instancing = false;
+static bool has_auto_mipmap = false;
+static bool has_pbo = false;
+static bool has_float_textures = false;
+
+static int gl_version() {
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int major = 1, minor = 0;
+    if (version) sscanf(version, "%d.%d", &major, &minor);
+    return major * 10 + minor;
+}
+
+static bool has_extension(const char* name) {
+    const char* list = (const char*)glGetString(GL_EXTENSIONS);
+    if (!list) return false;
+    size_t len = strlen(name);
+    for (const char* p = strstr(list, name); p; p = strstr(p + len, name)) {
+        if ((p == list || p[-1] == ' ') && (p[len] == ' ' || p[len] == '\0')) return true;
+    }
+    return false;
+}
+
+static void* load_proc(const char* core_name, const char* arb_name) {
+    void* proc = (void*)glutGetProcAddress(core_name);
+    if (!proc && arb_name) proc = (void*)glutGetProcAddress(arb_name);
+    return proc;
+}
+
+bool glload_init() {
+    if (gl_version() >= 15 || has_extension("GL_ARB_vertex_buffer_object")) {
+        gl_gen_buffers = (PFNGLGENBUFFERSPROC)load_proc("glGenBuffers", "glGenBuffersARB");
+        gl_delete_buffers = (PFNGLDELETEBUFFERSPROC)load_proc("glDeleteBuffers", "glDeleteBuffersARB");
+        gl_bind_buffer = (PFNGLBINDBUFFERPROC)load_proc("glBindBuffer", "glBindBufferARB");
+        gl_buffer_data = (PFNGLBUFFERDATAPROC)load_proc("glBufferData", "glBufferDataARB");
+        gl_map_buffer = (PFNGLMAPBUFFERPROC)load_proc("glMapBuffer", "glMapBufferARB");
+        gl_unmap_buffer = (PFNGLUNMAPBUFFERPROC)load_proc("glUnmapBuffer", "glUnmapBufferARB");
+        has_vbo = gl_gen_buffers && gl_delete_buffers && gl_bind_buffer && gl_buffer_data;
+    }
+
+    has_pbo = has_vbo && gl_map_buffer && gl_unmap_buffer &&
+              (gl_version() >= 21 || has_extension("GL_ARB_pixel_buffer_object"));
+
+    if (!has_vbo) {
+        printf("VBO indisponivel, usando display lists\n");
+    }
+
+    if (gl_version() >= 33 || has_extension("GL_ARB_timer_query")) {
+        gl_gen_queries = (PFNGLGENQUERIESPROC)load_proc("glGenQueries", "glGenQueriesARB");
+        gl_delete_queries = (PFNGLDELETEQUERIESPROC)load_proc("glDeleteQueries", "glDeleteQueriesARB");
+        gl_begin_query = (PFNGLBEGINQUERYPROC)load_proc("glBeginQuery", "glBeginQueryARB");
+        gl_end_query = (PFNGLENDQUERYPROC)load_proc("glEndQuery", "glEndQueryARB");
+        gl_get_query_objectiv = (PFNGLGETQUERYOBJECTIVPROC)load_proc("glGetQueryObjectiv", "glGetQueryObjectivARB");
+        gl_get_query_objectui64v = (PFNGLGETQUERYOBJECTUI64VPROC)load_proc("glGetQueryObjectui64v", NULL);
+        has_timer_query = gl_gen_queries && gl_delete_queries && gl_begin_query && gl_end_query &&
+                          gl_get_query_objectiv && gl_get_query_objectui64v;
+    }
+
+    if (gl_version() >= 30 || has_extension("GL_ARB_framebuffer_object") || has_extension("GL_EXT_framebuffer_object")) {
+        gl_gen_framebuffers = (PFNGLGENFRAMEBUFFERSPROC)load_proc("glGenFramebuffers", "glGenFramebuffersEXT");
+        gl_delete_framebuffers = (PFNGLDELETEFRAMEBUFFERSPROC)load_proc("glDeleteFramebuffers", "glDeleteFramebuffersEXT");
+        gl_bind_framebuffer = (PFNGLBINDFRAMEBUFFERPROC)load_proc("glBindFramebuffer", "glBindFramebufferEXT");
+        gl_framebuffer_renderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC)load_proc("glFramebufferRenderbuffer", "glFramebufferRenderbufferEXT");
+        gl_check_framebuffer_status = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)load_proc("glCheckFramebufferStatus", "glCheckFramebufferStatusEXT");
+        gl_gen_renderbuffers = (PFNGLGENRENDERBUFFERSPROC)load_proc("glGenRenderbuffers", "glGenRenderbuffersEXT");
+        gl_delete_renderbuffers = (PFNGLDELETERENDERBUFFERSPROC)load_proc("glDeleteRenderbuffers", "glDeleteRenderbuffersEXT");
+        gl_bind_renderbuffer = (PFNGLBINDRENDERBUFFERPROC)load_proc("glBindRenderbuffer", "glBindRenderbufferEXT");
+        gl_renderbuffer_storage = (PFNGLRENDERBUFFERSTORAGEPROC)load_proc("glRenderbufferStorage", "glRenderbufferStorageEXT");
+        gl_generate_mipmap = (PFNGLGENERATEMIPMAPPROC)load_proc("glGenerateMipmap", "glGenerateMipmapEXT");
+        has_fbo = gl_gen_framebuffers && gl_delete_framebuffers && gl_bind_framebuffer && gl_framebuffer_renderbuffer &&
+                  gl_check_framebuffer_status && gl_gen_renderbuffers && gl_delete_renderbuffers &&
+                  gl_bind_renderbuffer && gl_renderbuffer_storage;
+    }
+
+    if (gl_version() >= 20) {
+        gl_create_shader = (PFNGLCREATESHADERPROC)load_proc("glCreateShader", NULL);
+        gl_delete_shader = (PFNGLDELETESHADERPROC)load_proc("glDeleteShader", NULL);
+        gl_shader_source = (PFNGLSHADERSOURCEPROC)load_proc("glShaderSource", NULL);
+        gl_compile_shader = (PFNGLCOMPILESHADERPROC)load_proc("glCompileShader", NULL);
+        gl_get_shaderiv = (PFNGLGETSHADERIVPROC)load_proc("glGetShaderiv", NULL);
+        gl_get_shader_info_log = (PFNGLGETSHADERINFOLOGPROC)load_proc("glGetShaderInfoLog", NULL);
+        gl_create_program = (PFNGLCREATEPROGRAMPROC)load_proc("glCreateProgram", NULL);
+        gl_delete_program = (PFNGLDELETEPROGRAMPROC)load_proc("glDeleteProgram", NULL);
+        gl_attach_shader = (PFNGLATTACHSHADERPROC)load_proc("glAttachShader", NULL);
+        gl_link_program = (PFNGLLINKPROGRAMPROC)load_proc("glLinkProgram", NULL);
+        gl_get_programiv = (PFNGLGETPROGRAMIVPROC)load_proc("glGetProgramiv", NULL);
+        gl_get_program_info_log = (PFNGLGETPROGRAMINFOLOGPROC)load_proc("glGetProgramInfoLog", NULL);
+        gl_use_program = (PFNGLUSEPROGRAMPROC)load_proc("glUseProgram", NULL);
+        gl_get_uniform_location = (PFNGLGETUNIFORMLOCATIONPROC)load_proc("glGetUniformLocation", NULL);
+        gl_get_attrib_location = (PFNGLGETATTRIBLOCATIONPROC)load_proc("glGetAttribLocation", NULL);
+        gl_uniform1i = (PFNGLUNIFORM1IPROC)load_proc("glUniform1i", NULL);
+        gl_uniform2f = (PFNGLUNIFORM2FPROC)load_proc("glUniform2f", NULL);
+        gl_uniform1f = (PFNGLUNIFORM1FPROC)load_proc("glUniform1f", NULL);
+        gl_uniform3f = (PFNGLUNIFORM3FPROC)load_proc("glUniform3f", NULL);
+        gl_uniform_matrix4fv = (PFNGLUNIFORMMATRIX4FVPROC)load_proc("glUniformMatrix4fv", NULL);
+        gl_active_texture = (PFNGLACTIVETEXTUREPROC)load_proc("glActiveTexture", NULL);
+        gl_enable_vertex_attrib_array = (PFNGLENABLEVERTEXATTRIBARRAYPROC)load_proc("glEnableVertexAttribArray", NULL);
+        gl_disable_vertex_attrib_array = (PFNGLDISABLEVERTEXATTRIBARRAYPROC)load_proc("glDisableVertexAttribArray", NULL);
+        gl_vertex_attrib_pointer = (PFNGLVERTEXATTRIBPOINTERPROC)load_proc("glVertexAttribPointer", NULL);
+        has_shaders = gl_create_shader && gl_delete_shader && gl_shader_source && gl_compile_shader &&
+                      gl_get_shaderiv && gl_get_shader_info_log && gl_create_program && gl_delete_program &&
+                      gl_attach_shader && gl_link_program && gl_get_programiv && gl_get_program_info_log &&
+                      gl_use_program && gl_get_uniform_location && gl_get_attrib_location && gl_uniform1i &&
+                      gl_uniform2f && gl_enable_vertex_attrib_array && gl_disable_vertex_attrib_array &&
+                      gl_vertex_attrib_pointer;
+    }
+
+    // GLSL 1.30 texelFetch and single-channel float textures, used for the clustered light lists.
+    has_float_textures = has_shaders && gl_version() >= 30 && gl_uniform1f && gl_uniform3f &&
+                         gl_uniform_matrix4fv && gl_active_texture;
+
+    if (has_vbo && has_shaders &&
+        (gl_version() >= 33 || (has_extension("GL_ARB_instanced_arrays") && has_extension("GL_ARB_draw_instanced")))) {
+        gl_draw_elements_instanced = (PFNGLDRAWELEMENTSINSTANCEDPROC)load_proc("glDrawElementsInstanced", "glDrawElementsInstancedARB");
+        gl_vertex_attrib_divisor = (PFNGLVERTEXATTRIBDIVISORPROC)load_proc("glVertexAttribDivisor", "glVertexAttribDivisorARB");
+        has_instancing = gl_draw_elements_instanced && gl_vertex_attrib_divisor;
+    }
+
+    has_auto_mipmap = gl_version() >= 14 || has_extension("GL_SGIS_generate_mipmap");
+
+    if (!has_instancing) {
+        printf("Instancing indisponivel, esferas desenhadas uma a uma\n");
+    }
+    if (!has_float_textures) {
+        printf("OpenGL 3.0 indisponivel, usando iluminacao fixa\n");
+    }
+    return true;
+}
+
+bool glload_has_vbo() {
+    return has_vbo;
+}
+
+bool glload_has_timer_query() {
+    return has_timer_query;
+}
+
+bool glload_has_fbo() {
+    return has_fbo;
+}
+
+bool glload_has_shaders() {
+    return has_shaders;
+}
+
+bool glload_has_instancing() {
+    return has_instancing;
+}
+
+bool glload_has_auto_mipmap() {
+    return has_auto_mipmap;
+}
+
+bool glload_has_pbo() {
+    return has_pbo;
+}
+
+bool glload_has_float_textures() {
+    return has_float_textures;
+}
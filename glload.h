@@ -0,0 +1,71 @@
+#ifndef GLLOAD_H
+#define GLLOAD_H
+
+#include <stdbool.h>
+#include <GL/glut.h>
+#include <GL/glext.h>
+
+bool glload_init();
+bool glload_has_vbo();
+bool glload_has_timer_query();
+bool glload_has_fbo();
+bool glload_has_shaders();
+bool glload_has_instancing();
+bool glload_has_auto_mipmap();
+bool glload_has_pbo();
+bool glload_has_float_textures();
+
+extern PFNGLGENBUFFERSPROC gl_gen_buffers;
+extern PFNGLDELETEBUFFERSPROC gl_delete_buffers;
+extern PFNGLBINDBUFFERPROC gl_bind_buffer;
+extern PFNGLBUFFERDATAPROC gl_buffer_data;
+extern PFNGLMAPBUFFERPROC gl_map_buffer;
+extern PFNGLUNMAPBUFFERPROC gl_unmap_buffer;
+
+extern PFNGLGENQUERIESPROC gl_gen_queries;
+extern PFNGLDELETEQUERIESPROC gl_delete_queries;
+extern PFNGLBEGINQUERYPROC gl_begin_query;
+extern PFNGLENDQUERYPROC gl_end_query;
+extern PFNGLGETQUERYOBJECTIVPROC gl_get_query_objectiv;
+extern PFNGLGETQUERYOBJECTUI64VPROC gl_get_query_objectui64v;
+
+extern PFNGLGENFRAMEBUFFERSPROC gl_gen_framebuffers;
+extern PFNGLDELETEFRAMEBUFFERSPROC gl_delete_framebuffers;
+extern PFNGLBINDFRAMEBUFFERPROC gl_bind_framebuffer;
+extern PFNGLFRAMEBUFFERRENDERBUFFERPROC gl_framebuffer_renderbuffer;
+extern PFNGLCHECKFRAMEBUFFERSTATUSPROC gl_check_framebuffer_status;
+extern PFNGLGENRENDERBUFFERSPROC gl_gen_renderbuffers;
+extern PFNGLDELETERENDERBUFFERSPROC gl_delete_renderbuffers;
+extern PFNGLBINDRENDERBUFFERPROC gl_bind_renderbuffer;
+extern PFNGLRENDERBUFFERSTORAGEPROC gl_renderbuffer_storage;
+extern PFNGLGENERATEMIPMAPPROC gl_generate_mipmap;
+
+extern PFNGLCREATESHADERPROC gl_create_shader;
+extern PFNGLDELETESHADERPROC gl_delete_shader;
+extern PFNGLSHADERSOURCEPROC gl_shader_source;
+extern PFNGLCOMPILESHADERPROC gl_compile_shader;
+extern PFNGLGETSHADERIVPROC gl_get_shaderiv;
+extern PFNGLGETSHADERINFOLOGPROC gl_get_shader_info_log;
+extern PFNGLCREATEPROGRAMPROC gl_create_program;
+extern PFNGLDELETEPROGRAMPROC gl_delete_program;
+extern PFNGLATTACHSHADERPROC gl_attach_shader;
+extern PFNGLLINKPROGRAMPROC gl_link_program;
+extern PFNGLGETPROGRAMIVPROC gl_get_programiv;
+extern PFNGLGETPROGRAMINFOLOGPROC gl_get_program_info_log;
+extern PFNGLUSEPROGRAMPROC gl_use_program;
+extern PFNGLGETUNIFORMLOCATIONPROC gl_get_uniform_location;
+extern PFNGLGETATTRIBLOCATIONPROC gl_get_attrib_location;
+extern PFNGLUNIFORM1IPROC gl_uniform1i;
+extern PFNGLUNIFORM2FPROC gl_uniform2f;
+extern PFNGLUNIFORM1FPROC gl_uniform1f;
+extern PFNGLUNIFORM3FPROC gl_uniform3f;
+extern PFNGLUNIFORMMATRIX4FVPROC gl_uniform_matrix4fv;
+extern PFNGLACTIVETEXTUREPROC gl_active_texture;
+extern PFNGLENABLEVERTEXATTRIBARRAYPROC gl_enable_vertex_attrib_array;
+extern PFNGLDISABLEVERTEXATTRIBARRAYPROC gl_disable_vertex_attrib_array;
+extern PFNGLVERTEXATTRIBPOINTERPROC gl_vertex_attrib_pointer;
+
+extern PFNGLDRAWELEMENTSINSTANCEDPROC gl_draw_elements_instanced;
+extern PFNGLVERTEXATTRIBDIVISORPROC gl_vertex_attrib_divisor;
+
+#endif
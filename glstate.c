@@ -0,0 +1,99 @@
+#include "glstate.h"
+#include <string.h>
+#include "glload.h"
+
+static const GLenum caps[GLSTATE_CAP_COUNT] = {
+    GL_LIGHTING, GL_TEXTURE_2D, GL_DEPTH_TEST, GL_BLEND, GL_NORMALIZE, GL_LIGHT1, GL_LIGHT2
+};
+
+// Nothing is known until the first call sets it.
+static bool cap_known[GLSTATE_CAP_COUNT];
+static bool cap_enabled[GLSTATE_CAP_COUNT];
+static bool texture_known[GLSTATE_TEXTURE_UNITS];
+static GLuint texture_bound[GLSTATE_TEXTURE_UNITS];
+static bool program_known = false;
+static GLuint program_bound = 0;
+static bool material_known = false;
+static GlMaterial material_current;
+static GlStateStats stats;
+
+void glstate_invalidate() {
+    memset(cap_known, 0, sizeof(cap_known));
+    memset(texture_known, 0, sizeof(texture_known));
+    program_known = false;
+    material_known = false;
+}
+
+void glstate_set(GlStateCap cap, bool enabled) {
+    if (cap_known[cap] && cap_enabled[cap] == enabled) {
+        stats.skipped++;
+        return;
+    }
+    if (enabled) glEnable(caps[cap]);
+    else glDisable(caps[cap]);
+    cap_known[cap] = true;
+    cap_enabled[cap] = enabled;
+    stats.issued++;
+}
+
+void glstate_bind_texture(int unit, GLuint texture) {
+    if (texture_known[unit] && texture_bound[unit] == texture) {
+        stats.skipped++;
+        return;
+    }
+    if (unit != 0) {
+        gl_active_texture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        gl_active_texture(GL_TEXTURE0);
+        stats.issued += 3;
+    } else {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        stats.issued++;
+    }
+    texture_known[unit] = true;
+    texture_bound[unit] = texture;
+}
+
+void glstate_use_program(GLuint program) {
+    if (program_known && program_bound == program) {
+        stats.skipped++;
+        return;
+    }
+    gl_use_program(program);
+    program_known = true;
+    program_bound = program;
+    stats.issued++;
+}
+
+void glstate_material(const GlMaterial* material) {
+    bool known = material_known;
+    if (!known || memcmp(material->specular, material_current.specular, sizeof(material->specular)) != 0) {
+        glMaterialfv(GL_FRONT, GL_SPECULAR, material->specular);
+        stats.issued++;
+    } else {
+        stats.skipped++;
+    }
+    if (!known || material->shininess != material_current.shininess) {
+        glMaterialf(GL_FRONT, GL_SHININESS, material->shininess);
+        stats.issued++;
+    } else {
+        stats.skipped++;
+    }
+    if (!known || memcmp(material->emission, material_current.emission, sizeof(material->emission)) != 0) {
+        glMaterialfv(GL_FRONT, GL_EMISSION, material->emission);
+        stats.issued++;
+    } else {
+        stats.skipped++;
+    }
+    material_known = true;
+    material_current = *material;
+}
+
+void glstate_begin_frame() {
+    stats.issued = 0;
+    stats.skipped = 0;
+}
+
+void glstate_get_stats(GlStateStats* out) {
+    *out = stats;
+}
@@ -0,0 +1,43 @@
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+#include <stdbool.h>
+#include <GL/glut.h>
+
+#define GLSTATE_TEXTURE_UNITS 8
+
+typedef enum {
+    GLSTATE_LIGHTING,
+    GLSTATE_TEXTURE_2D,
+    GLSTATE_DEPTH_TEST,
+    GLSTATE_BLEND,
+    GLSTATE_NORMALIZE,
+    GLSTATE_LIGHT1,
+    GLSTATE_LIGHT2,
+    GLSTATE_CAP_COUNT
+} GlStateCap;
+
+typedef struct {
+    GLfloat specular[4];
+    GLfloat shininess;
+    GLfloat emission[4];
+} GlMaterial;
+
+typedef struct {
+    int issued, skipped;
+} GlStateStats;
+
+// Shadow copy of the GL state the renderer changes most often; a call whose
+// value already matches is dropped. Code that changes this state directly
+// must restore it, or call glstate_invalidate afterwards.
+void glstate_invalidate();
+void glstate_set(GlStateCap cap, bool enabled);
+// Texture units other than 0 are bound without leaving them active.
+void glstate_bind_texture(int unit, GLuint texture);
+void glstate_use_program(GLuint program);
+void glstate_material(const GlMaterial* material);
+
+void glstate_begin_frame();
+void glstate_get_stats(GlStateStats* stats);
+
+#endif
@@ -0,0 +1,61 @@
+#include "gpu_timer.h"
+#include "glload.h"
+
+#define GPU_TIMER_FRAMES 4
+
+static GLuint queries[GPU_TIMER_FRAMES][PROFILE_PHASE_COUNT];
+static bool issued[GPU_TIMER_FRAMES][PROFILE_PHASE_COUNT];
+static int current_frame = 0;
+static bool available = false;
+static bool query_active = false;
+
+void gpu_timer_init() {
+    available = glload_has_timer_query();
+    if (!available) return;
+    for (int f = 0; f < GPU_TIMER_FRAMES; f++) {
+        gl_gen_queries(PROFILE_PHASE_COUNT, queries[f]);
+    }
+}
+
+void gpu_timer_begin(ProfilePhase phase) {
+    profiler_begin(phase);
+    if (!available || query_active || !profiler_is_enabled()) return;
+    gl_begin_query(GL_TIME_ELAPSED, queries[current_frame][phase]);
+    issued[current_frame][phase] = true;
+    query_active = true;
+}
+
+void gpu_timer_end(ProfilePhase phase) {
+    if (query_active && issued[current_frame][phase]) {
+        gl_end_query(GL_TIME_ELAPSED);
+        query_active = false;
+    }
+    profiler_end(phase);
+}
+
+void gpu_timer_end_frame() {
+    if (!available) return;
+
+    // Results are read GPU_TIMER_FRAMES - 1 frames late so the CPU never waits on them.
+    current_frame = (current_frame + 1) % GPU_TIMER_FRAMES;
+    for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        if (!issued[current_frame][i]) continue;
+        issued[current_frame][i] = false;
+
+        GLint ready = 0;
+        gl_get_query_objectiv(queries[current_frame][i], GL_QUERY_RESULT_AVAILABLE, &ready);
+        if (!ready) continue;
+
+        GLuint64 nanoseconds = 0;
+        gl_get_query_objectui64v(queries[current_frame][i], GL_QUERY_RESULT, &nanoseconds);
+        profiler_add_gpu_sample((ProfilePhase)i, nanoseconds / 1e9);
+    }
+}
+
+void gpu_timer_cleanup() {
+    if (!available) return;
+    for (int f = 0; f < GPU_TIMER_FRAMES; f++) {
+        gl_delete_queries(PROFILE_PHASE_COUNT, queries[f]);
+    }
+    available = false;
+}
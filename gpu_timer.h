@@ -0,0 +1,13 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include "profiler.h"
+
+// Times a render phase on the CPU and, when timer queries exist, on the GPU.
+void gpu_timer_init();
+void gpu_timer_begin(ProfilePhase phase);
+void gpu_timer_end(ProfilePhase phase);
+void gpu_timer_end_frame();
+void gpu_timer_cleanup();
+
+#endif
@@ -0,0 +1,30 @@
+#include "input_queue.h"
+#include "thread.h"
+
+// Positions run over twice the size so a full ring differs from an empty one.
+#define POSITION_MASK (2 * INPUT_QUEUE_SIZE - 1)
+
+void input_queue_init(InputQueue* queue) {
+    queue->head = 0;
+    queue->tail = 0;
+}
+
+bool input_queue_push(InputQueue* queue, const InputEvent* event) {
+    int tail = queue->tail;
+    int head = thread_atomic_load(&queue->head);
+    if (((tail - head) & POSITION_MASK) == INPUT_QUEUE_SIZE) return false;
+    queue->events[tail & (INPUT_QUEUE_SIZE - 1)] = *event;
+    thread_atomic_store(&queue->tail, (tail + 1) & POSITION_MASK);
+    return true;
+}
+
+bool input_queue_peek(InputQueue* queue, InputEvent* event) {
+    int head = queue->head;
+    if (head == thread_atomic_load(&queue->tail)) return false;
+    *event = queue->events[head & (INPUT_QUEUE_SIZE - 1)];
+    return true;
+}
+
+void input_queue_pop(InputQueue* queue) {
+    thread_atomic_store(&queue->head, (queue->head + 1) & POSITION_MASK);
+}
@@ -0,0 +1,36 @@
+#ifndef INPUT_QUEUE_H
+#define INPUT_QUEUE_H
+
+#include <stdbool.h>
+#include "sim.h"
+
+#define INPUT_QUEUE_SIZE 256
+
+typedef enum {
+    INPUT_EVENT_KEY,
+    INPUT_EVENT_LOOK,
+    INPUT_EVENT_COMMAND
+} InputEventType;
+
+typedef struct {
+    double time;
+    InputEventType type;
+    unsigned char key;
+    bool pressed;
+    float turn, tilt;
+    SimCommand command;
+} InputEvent;
+
+// Single-producer, single-consumer ring: the window thread pushes, the
+// simulation thread peeks and pops. A full queue drops the new event.
+typedef struct {
+    InputEvent events[INPUT_QUEUE_SIZE];
+    volatile int head, tail;
+} InputQueue;
+
+void input_queue_init(InputQueue* queue);
+bool input_queue_push(InputQueue* queue, const InputEvent* event);
+bool input_queue_peek(InputQueue* queue, InputEvent* event);
+void input_queue_pop(InputQueue* queue);
+
+#endif
@@ -0,0 +1,140 @@
+#include <stddef.h>
+#include <stdint.h>
+#include "jobs.h"
+#include "thread.h"
+
+// Padded so the cursors threads hammer do not share a cache line.
+typedef struct {
+    volatile int next;
+    int end;
+    char padding[56];
+} JobSlice;
+
+static Thread* workers[JOBS_MAX_THREADS];
+static int worker_count = 0;
+static ThreadMutex* pool_mutex = NULL;
+// Held for a whole loop, so the simulation and render threads can both start them.
+static ThreadMutex* loop_mutex = NULL;
+static ThreadCond* work_cond = NULL;
+static ThreadCond* done_cond = NULL;
+static int generation = 0, workers_done = 0;
+static bool stopping = false;
+
+static JobSlice slices[JOBS_MAX_THREADS];
+static JobRangeFunc job_run = NULL;
+static void* job_user = NULL;
+static int job_grain = 1;
+static volatile int steals = 0;
+
+static void run_slices(int self) {
+    int slice_count = worker_count + 1;
+    for (int k = 0; k < slice_count; k++) {
+        JobSlice* slice = &slices[(self + k) % slice_count];
+        for (;;) {
+            int begin = thread_atomic_add(&slice->next, job_grain);
+            if (begin >= slice->end) break;
+            int end = begin + job_grain < slice->end ? begin + job_grain : slice->end;
+            job_run(begin, end, job_user);
+            if (k > 0) thread_atomic_add(&steals, 1);
+        }
+    }
+}
+
+static void worker_thread(void* arg) {
+    int self = (int)(intptr_t)arg;
+    thread_mutex_lock(pool_mutex);
+    int seen = 0;
+    while (!stopping) {
+        if (generation == seen) {
+            thread_cond_wait(work_cond, pool_mutex);
+            continue;
+        }
+        seen = generation;
+        thread_mutex_unlock(pool_mutex);
+        run_slices(self);
+        thread_mutex_lock(pool_mutex);
+        if (++workers_done == worker_count) thread_cond_signal(done_cond);
+    }
+    thread_mutex_unlock(pool_mutex);
+}
+
+bool jobs_init(int thread_count) {
+    if (pool_mutex) return true;
+    pool_mutex = thread_mutex_create();
+    loop_mutex = thread_mutex_create();
+    work_cond = thread_cond_create();
+    done_cond = thread_cond_create();
+    if (!pool_mutex || !loop_mutex || !work_cond || !done_cond) {
+        jobs_shutdown();
+        return false;
+    }
+
+    stopping = false;
+    generation = 0;
+    steals = 0;
+    int wanted = (thread_count > 0 ? thread_count : thread_cpu_count()) - 1;
+    if (wanted > JOBS_MAX_THREADS - 1) wanted = JOBS_MAX_THREADS - 1;
+    for (worker_count = 0; worker_count < wanted; worker_count++) {
+        workers[worker_count] = thread_start(worker_thread, (void*)(intptr_t)(worker_count + 1));
+        if (!workers[worker_count]) break;
+    }
+    return true;
+}
+
+int jobs_thread_count() {
+    return worker_count + 1;
+}
+
+void jobs_parallel_for(int count, int grain, JobRangeFunc run, void* user) {
+    if (count <= 0) return;
+    if (grain < 1) grain = 1;
+    if (worker_count == 0 || count <= grain) {
+        run(0, count, user);
+        return;
+    }
+
+    thread_mutex_lock(loop_mutex);
+    int slice_count = worker_count + 1;
+    for (int i = 0; i < slice_count; i++) {
+        slices[i].next = (int)((long long)count * i / slice_count);
+        slices[i].end = (int)((long long)count * (i + 1) / slice_count);
+    }
+    thread_mutex_lock(pool_mutex);
+    job_run = run;
+    job_user = user;
+    job_grain = grain;
+    workers_done = 0;
+    generation++;
+    thread_cond_broadcast(work_cond);
+    thread_mutex_unlock(pool_mutex);
+
+    run_slices(0);
+
+    thread_mutex_lock(pool_mutex);
+    while (workers_done < worker_count) thread_cond_wait(done_cond, pool_mutex);
+    thread_mutex_unlock(pool_mutex);
+    thread_mutex_unlock(loop_mutex);
+}
+
+int jobs_steal_count() {
+    return thread_atomic_load(&steals);
+}
+
+void jobs_shutdown() {
+    if (pool_mutex) {
+        thread_mutex_lock(pool_mutex);
+        stopping = true;
+        thread_cond_broadcast(work_cond);
+        thread_mutex_unlock(pool_mutex);
+    }
+    for (int i = 0; i < worker_count; i++) thread_join(workers[i]);
+    worker_count = 0;
+    if (pool_mutex) thread_mutex_destroy(pool_mutex);
+    if (loop_mutex) thread_mutex_destroy(loop_mutex);
+    if (work_cond) thread_cond_destroy(work_cond);
+    if (done_cond) thread_cond_destroy(done_cond);
+    pool_mutex = NULL;
+    loop_mutex = NULL;
+    work_cond = NULL;
+    done_cond = NULL;
+}
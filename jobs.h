@@ -0,0 +1,22 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdbool.h>
+
+#define JOBS_MAX_THREADS 64
+
+typedef void (*JobRangeFunc)(int begin, int end, void* user);
+
+// Parallel loops over a pool of worker threads. Each loop's items are split
+// into one slice per thread; a thread works through its own slice a grain
+// at a time and, once that runs dry, steals grains from the other slices.
+// Any thread may start loops; they run one at a time. Without jobs_init, loops
+// run inline. jobs_init does nothing once the pool is running.
+bool jobs_init(int thread_count);
+int jobs_thread_count();
+void jobs_parallel_for(int count, int grain, JobRangeFunc run, void* user);
+// Grains taken from another thread's slice since jobs_init.
+int jobs_steal_count();
+void jobs_shutdown();
+
+#endif
@@ -0,0 +1,305 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "lightmap.h"
+#include "platform.h"
+#include "thread.h"
+
+#define LIGHTMAP_VERSION 1
+#define LIGHTMAP_PATH_MAX 1024
+#define LIGHTMAP_CHUNK_BYTES ((size_t)LIGHTMAP_WIDTH * LIGHTMAP_HEIGHT)
+
+static const char lightmap_magic[4] = {'M', 'Z', 'L', 'M'};
+
+// Face normals and tangent frames of the six layers, in atlas order.
+static const float face_normals[LIGHTMAP_FACES][3] = {
+    {0, 1, 0}, {0, -1, 0}, {1, 0, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 0, -1}
+};
+static const float face_tangents[LIGHTMAP_FACES][3] = {
+    {1, 0, 0}, {1, 0, 0}, {0, 0, 1}, {0, 0, 1}, {1, 0, 0}, {1, 0, 0}
+};
+
+typedef struct {
+    const World* world;
+    Lightmap* lightmap;
+    float rays[LIGHTMAP_RAYS][3];
+    int next_task, task_count;
+    ThreadMutex* mutex;
+} BakeJob;
+
+// Same solidity as the wall meshes: the exit cell is open.
+static bool is_solid(const World* world, int x, int z) {
+    if (world_is_exit(world, x, z)) return false;
+    return world_get(world, x, z) == 1;
+}
+
+uint64_t lightmap_hash(const World* world) {
+    uint64_t hash = 1469598103934665603ull;
+    int header[5] = {world->width, world->height, LIGHTMAP_TEXELS, LIGHTMAP_RAYS, (int)(LIGHTMAP_AO_DISTANCE * 1000.0f)};
+    const unsigned char* bytes = (const unsigned char*)header;
+    for (size_t i = 0; i < sizeof(header); i++) hash = (hash ^ bytes[i]) * 1099511628211ull;
+    for (int x = 0; x < world->width; x++) {
+        for (int z = 0; z < world->height; z++) {
+            hash = (hash ^ (unsigned char)is_solid(world, x, z)) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+// Cosine-weighted hemisphere directions around +Y from a Hammersley set; the
+// same set is used for every texel so neighbouring texels stay noise-free.
+static void build_rays(float rays[LIGHTMAP_RAYS][3]) {
+    for (int i = 0; i < LIGHTMAP_RAYS; i++) {
+        unsigned int bits = (unsigned int)i;
+        bits = (bits << 16) | (bits >> 16);
+        bits = ((bits & 0x55555555u) << 1) | ((bits & 0xAAAAAAAAu) >> 1);
+        bits = ((bits & 0x33333333u) << 2) | ((bits & 0xCCCCCCCCu) >> 2);
+        bits = ((bits & 0x0F0F0F0Fu) << 4) | ((bits & 0xF0F0F0F0u) >> 4);
+        bits = ((bits & 0x00FF00FFu) << 8) | ((bits & 0xFF00FF00u) >> 8);
+        float u = (i + 0.5f) / LIGHTMAP_RAYS;
+        float v = bits * 2.3283064365386963e-10f;
+        float r = sqrtf(u);
+        float phi = 2.0f * (float)PI * v;
+        rays[i][0] = r * cosf(phi);
+        rays[i][1] = sqrtf(1.0f - u);
+        rays[i][2] = r * sinf(phi);
+    }
+}
+
+// Walks the cell grid with a 2D DDA while tracking the floor and ceiling
+// planes. Returns the distance to the first hit, or max_t if nothing is closer.
+static float trace(const World* world, const float* origin, const float* dir, float max_t) {
+    float ox = origin[0] / CUBE_SIZE, oz = origin[2] / CUBE_SIZE;
+    float dx = dir[0] / CUBE_SIZE, dz = dir[2] / CUBE_SIZE;
+    int cx = (int)floorf(ox), cz = (int)floorf(oz);
+    int step_x = dx > 0.0f ? 1 : -1, step_z = dz > 0.0f ? 1 : -1;
+    float delta_x = dx != 0.0f ? fabsf(1.0f / dx) : INFINITY;
+    float delta_z = dz != 0.0f ? fabsf(1.0f / dz) : INFINITY;
+    float next_x = dx != 0.0f ? ((dx > 0.0f ? cx + 1 - ox : ox - cx) * delta_x) : INFINITY;
+    float next_z = dz != 0.0f ? ((dz > 0.0f ? cz + 1 - oz : oz - cz) * delta_z) : INFINITY;
+
+    float plane_t = INFINITY;
+    if (dir[1] > 0.0f) plane_t = (WALL_HEIGHT - origin[1]) / dir[1];
+    else if (dir[1] < 0.0f) plane_t = -origin[1] / dir[1];
+    if (plane_t < max_t) max_t = plane_t;
+
+    for (;;) {
+        float t = next_x < next_z ? next_x : next_z;
+        if (t >= max_t) return max_t;
+        if (next_x < next_z) {
+            cx += step_x;
+            next_x += delta_x;
+        } else {
+            cz += step_z;
+            next_z += delta_z;
+        }
+        if (is_solid(world, cx, cz)) return t;
+    }
+}
+
+static bool face_exists(const World* world, int face, int x, int z) {
+    switch (face) {
+        case 0: case 1: return !is_solid(world, x, z);
+        case 2: return is_solid(world, x, z) && !is_solid(world, x + 1, z);
+        case 3: return is_solid(world, x, z) && !is_solid(world, x - 1, z);
+        case 4: return is_solid(world, x, z) && !is_solid(world, x, z + 1);
+        default: return is_solid(world, x, z) && !is_solid(world, x, z - 1);
+    }
+}
+
+// World position of texel (u, v) of a cell's face; u runs along the tangent, v
+// along the wall height or the z axis for floor and ceiling.
+static void face_point(int face, int x, int z, float u, float v, float* p) {
+    switch (face) {
+        case 0: p[0] = x + u; p[1] = 0.0f; p[2] = z + v; break;
+        case 1: p[0] = x + u; p[1] = WALL_HEIGHT; p[2] = z + v; break;
+        case 2: p[0] = x + 1.0f; p[1] = v * WALL_HEIGHT; p[2] = z + u; break;
+        case 3: p[0] = (float)x; p[1] = v * WALL_HEIGHT; p[2] = z + u; break;
+        case 4: p[0] = x + u; p[1] = v * WALL_HEIGHT; p[2] = z + 1.0f; break;
+        default: p[0] = x + u; p[1] = v * WALL_HEIGHT; p[2] = (float)z; break;
+    }
+    p[0] *= CUBE_SIZE;
+    p[2] *= CUBE_SIZE;
+}
+
+static unsigned char bake_texel(const BakeJob* job, int face, const float* point) {
+    const float* n = face_normals[face];
+    const float* t = face_tangents[face];
+    float b[3] = {n[1] * t[2] - n[2] * t[1], n[2] * t[0] - n[0] * t[2], n[0] * t[1] - n[1] * t[0]};
+    float origin[3];
+    for (int k = 0; k < 3; k++) origin[k] = point[k] + n[k] * 1e-3f;
+
+    float occlusion = 0.0f;
+    for (int i = 0; i < LIGHTMAP_RAYS; i++) {
+        const float* r = job->rays[i];
+        float dir[3];
+        for (int k = 0; k < 3; k++) dir[k] = t[k] * r[0] + n[k] * r[1] + b[k] * r[2];
+        float hit = trace(job->world, origin, dir, LIGHTMAP_AO_DISTANCE);
+        float closeness = 1.0f - hit / LIGHTMAP_AO_DISTANCE;
+        occlusion += closeness * closeness;
+    }
+    float visibility = 1.0f - occlusion / LIGHTMAP_RAYS;
+    return (unsigned char)(visibility * 255.0f + 0.5f);
+}
+
+// One task is one row of cells of one face layer of one chunk.
+static void bake_task(BakeJob* job, int task) {
+    int row = task % CHUNK_SIZE;
+    int face = task / CHUNK_SIZE % LIGHTMAP_FACES;
+    int chunk = task / (CHUNK_SIZE * LIGHTMAP_FACES);
+    int cx = chunk / job->lightmap->chunks_z, cz = chunk % job->lightmap->chunks_z;
+    unsigned char* atlas = job->lightmap->texels + chunk * LIGHTMAP_CHUNK_BYTES;
+    int layer_x = (face % 3) * LIGHTMAP_LAYER_SIZE, layer_y = (face / 3) * LIGHTMAP_LAYER_SIZE;
+
+    int x = cx * CHUNK_SIZE + row;
+    for (int lz = 0; lz < CHUNK_SIZE; lz++) {
+        int z = cz * CHUNK_SIZE + lz;
+        if (x >= job->world->width || z >= job->world->height || !face_exists(job->world, face, x, z)) continue;
+        for (int j = 0; j < LIGHTMAP_TEXELS; j++) {
+            unsigned char* out = atlas + (size_t)(layer_y + lz * LIGHTMAP_TEXELS + j) * LIGHTMAP_WIDTH +
+                                 layer_x + row * LIGHTMAP_TEXELS;
+            for (int i = 0; i < LIGHTMAP_TEXELS; i++) {
+                float point[3];
+                face_point(face, x, z, (i + 0.5f) / LIGHTMAP_TEXELS, (j + 0.5f) / LIGHTMAP_TEXELS, point);
+                out[i] = bake_texel(job, face, point);
+            }
+        }
+    }
+}
+
+static void bake_worker(void* arg) {
+    BakeJob* job = arg;
+    for (;;) {
+        thread_mutex_lock(job->mutex);
+        int task = job->next_task++;
+        thread_mutex_unlock(job->mutex);
+        if (task >= job->task_count) return;
+        bake_task(job, task);
+    }
+}
+
+// Returns the number of threads that baked, counting the caller, or 0 on failure.
+static int bake(Lightmap* lightmap, const World* world) {
+    BakeJob job;
+    job.world = world;
+    job.lightmap = lightmap;
+    job.next_task = 0;
+    job.task_count = lightmap->chunks_x * lightmap->chunks_z * LIGHTMAP_FACES * CHUNK_SIZE;
+    job.mutex = thread_mutex_create();
+    if (!job.mutex) return 0;
+    build_rays(job.rays);
+
+    // The caller bakes too, so one thread fewer than there are cores is started.
+    int thread_count = thread_cpu_count() - 1;
+    Thread** threads = thread_count > 0 ? calloc(thread_count, sizeof(Thread*)) : NULL;
+    int started = 0;
+    for (int i = 0; threads && i < thread_count; i++) {
+        threads[i] = thread_start(bake_worker, &job);
+        if (threads[i]) started++;
+    }
+    bake_worker(&job);
+    for (int i = 0; threads && i < thread_count; i++) {
+        if (threads[i]) thread_join(threads[i]);
+    }
+    free(threads);
+    thread_mutex_destroy(job.mutex);
+    return started + 1;
+}
+
+// The cache is machine-local, so the header is written in native byte order.
+static bool load_cache(Lightmap* lightmap, const char* path) {
+    MappedFile file;
+    if (!platform_map_file(path, &file)) return false;
+
+    size_t bytes = (size_t)lightmap->chunks_x * lightmap->chunks_z * LIGHTMAP_CHUNK_BYTES;
+    uint32_t header[6];
+    uint64_t hash;
+    bool ok = file.size == sizeof(header) + sizeof(hash) + bytes;
+    if (ok) {
+        memcpy(header, file.data, sizeof(header));
+        memcpy(&hash, file.data + sizeof(header), sizeof(hash));
+        ok = memcmp(header, lightmap_magic, 4) == 0 && header[1] == LIGHTMAP_VERSION &&
+             header[2] == LIGHTMAP_TEXELS && header[3] == LIGHTMAP_RAYS &&
+             header[4] == (uint32_t)lightmap->chunks_x && header[5] == (uint32_t)lightmap->chunks_z &&
+             hash == lightmap->hash;
+    }
+    if (ok) memcpy(lightmap->texels, file.data + sizeof(header) + sizeof(hash), bytes);
+    platform_unmap_file(&file);
+    return ok;
+}
+
+static void save_cache(const Lightmap* lightmap, const char* path) {
+    char temp_path[LIGHTMAP_PATH_MAX + 4];
+    int length = snprintf(temp_path, sizeof(temp_path), "%s.tmp", path);
+    FILE* out = length >= 0 && length < (int)sizeof(temp_path) ? fopen(temp_path, "wb") : NULL;
+    if (!out) {
+        fprintf(stderr, "Nao foi possivel gravar o cache do lightmap: %s\n", path);
+        return;
+    }
+
+    uint32_t header[6] = {0, LIGHTMAP_VERSION, LIGHTMAP_TEXELS, LIGHTMAP_RAYS,
+                          (uint32_t)lightmap->chunks_x, (uint32_t)lightmap->chunks_z};
+    memcpy(header, lightmap_magic, 4);
+    size_t bytes = (size_t)lightmap->chunks_x * lightmap->chunks_z * LIGHTMAP_CHUNK_BYTES;
+    bool ok = fwrite(header, sizeof(header), 1, out) == 1 &&
+              fwrite(&lightmap->hash, sizeof(lightmap->hash), 1, out) == 1 &&
+              fwrite(lightmap->texels, 1, bytes, out) == bytes;
+    ok = fclose(out) == 0 && ok;
+    if (ok) {
+        remove(path);
+        ok = rename(temp_path, path) == 0;
+    }
+    if (!ok) {
+        remove(temp_path);
+        fprintf(stderr, "Falha ao gravar o cache do lightmap: %s\n", path);
+    }
+}
+
+bool lightmap_load_or_bake(Lightmap* lightmap, const World* world, const char* cache_directory) {
+    memset(lightmap, 0, sizeof(*lightmap));
+    if (world->chunks_x * world->chunks_z > LIGHTMAP_MAX_CHUNKS) {
+        printf("Lightmap desativado: %d chunks, maximo %d\n", world->chunks_x * world->chunks_z, LIGHTMAP_MAX_CHUNKS);
+        return false;
+    }
+
+    lightmap->chunks_x = world->chunks_x;
+    lightmap->chunks_z = world->chunks_z;
+    lightmap->hash = lightmap_hash(world);
+    size_t bytes = (size_t)lightmap->chunks_x * lightmap->chunks_z * LIGHTMAP_CHUNK_BYTES;
+    lightmap->texels = malloc(bytes);
+    if (!lightmap->texels) return false;
+
+    char path[LIGHTMAP_PATH_MAX];
+    int length = snprintf(path, sizeof(path), "%s/%016llx.lmap", cache_directory, (unsigned long long)lightmap->hash);
+    // Without a usable path the lightmap is still baked, just not cached.
+    bool cached = length >= 0 && length < (int)sizeof(path);
+    if (!cached) fprintf(stderr, "Caminho do cache do lightmap longo demais: %s\n", cache_directory);
+    double start = platform_time_seconds();
+    if (cached && load_cache(lightmap, path)) {
+        printf("Lightmap %s carregado do cache em %.1f ms\n", path, (platform_time_seconds() - start) * 1000.0);
+        return true;
+    }
+
+    // Texels of faces that never get drawn stay fully lit.
+    memset(lightmap->texels, 255, bytes);
+    int threads = bake(lightmap, world);
+    if (!threads) {
+        lightmap_free(lightmap);
+        return false;
+    }
+    printf("Lightmap de %d chunks assado em %.0f ms com %d threads\n", lightmap->chunks_x * lightmap->chunks_z,
+           (platform_time_seconds() - start) * 1000.0, threads);
+    if (cached && platform_make_directory(cache_directory)) save_cache(lightmap, path);
+    return true;
+}
+
+const unsigned char* lightmap_chunk(const Lightmap* lightmap, int cx, int cz) {
+    if (!lightmap->texels || cx < 0 || cz < 0 || cx >= lightmap->chunks_x || cz >= lightmap->chunks_z) return NULL;
+    return lightmap->texels + (size_t)(cx * lightmap->chunks_z + cz) * LIGHTMAP_CHUNK_BYTES;
+}
+
+void lightmap_free(Lightmap* lightmap) {
+    free(lightmap->texels);
+    memset(lightmap, 0, sizeof(*lightmap));
+}
@@ -0,0 +1,32 @@
+#ifndef LIGHTMAP_H
+#define LIGHTMAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+#include "world.h"
+
+// Each chunk bakes into one 8-bit atlas of six layers laid out 3x2: floor,
+// ceiling and the walls facing +X, -X, +Z and -Z. A layer holds one
+// LIGHTMAP_TEXELS^2 tile per cell; wall tiles belong to the solid cell and
+// span the full wall height.
+#define LIGHTMAP_FACES 6
+#define LIGHTMAP_LAYER_SIZE (CHUNK_SIZE * LIGHTMAP_TEXELS)
+#define LIGHTMAP_WIDTH (3 * LIGHTMAP_LAYER_SIZE)
+#define LIGHTMAP_HEIGHT (2 * LIGHTMAP_LAYER_SIZE)
+#define LIGHTMAP_CACHE_DIRECTORY "lightmaps"
+
+typedef struct {
+    uint64_t hash;
+    int chunks_x, chunks_z;
+    unsigned char* texels;
+} Lightmap;
+
+// Loads the ambient occlusion baked for this maze from cache_directory, or
+// bakes it on every core and caches it. Fails for mazes over LIGHTMAP_MAX_CHUNKS.
+bool lightmap_load_or_bake(Lightmap* lightmap, const World* world, const char* cache_directory);
+const unsigned char* lightmap_chunk(const Lightmap* lightmap, int cx, int cz);
+uint64_t lightmap_hash(const World* world);
+void lightmap_free(Lightmap* lightmap);
+
+#endif
@@ -0,0 +1,334 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "lights.h"
+#include "glload.h"
+#include "shader.h"
+#include "frustum.h"
+#include "config.h"
+#include "lightmap.h"
+#include "glstate.h"
+
+#define LIGHT_INDEX_ROW_SHIFT 10
+#define LIGHT_INDEX_ROW (1 << LIGHT_INDEX_ROW_SHIFT)
+#define STRINGIFY_VALUE(x) #x
+#define STRINGIFY(x) STRINGIFY_VALUE(x)
+
+static const char* vertex_source =
+    "#version 130\n"
+    "uniform mat4 view_inverse;\n"
+    "out vec3 world_position;\n"
+    "out vec3 world_normal;\n"
+    "void main() {\n"
+    "    vec4 eye = gl_ModelViewMatrix * gl_Vertex;\n"
+    "    world_position = (view_inverse * eye).xyz;\n"
+    "    world_normal = mat3(view_inverse) * (gl_NormalMatrix * gl_Normal);\n"
+    "    gl_FrontColor = gl_Color;\n"
+    "    gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+    "    gl_Position = gl_ProjectionMatrix * eye;\n"
+    "}\n";
+
+// Same terms as the fixed-function path: clamped ambient, darkened by the baked
+// occlusion, plus attenuated diffuse from every light in the fragment's column,
+// modulated by the texture. The window only fades the tail the constant/linear/
+// quadratic curve leaves past LIGHT_RADIUS, so lights can be binned.
+static const char* fragment_source =
+    "#version 130\n"
+    "uniform sampler2D diffuse_texture;\n"
+    "uniform sampler2D light_data;\n"
+    "uniform sampler2D cluster_grid;\n"
+    "uniform sampler2D light_indices;\n"
+    "uniform vec2 cluster_origin;\n"
+    "uniform float cluster_size;\n"
+    "uniform float light_radius;\n"
+    "uniform vec3 ambient_base;\n"
+    "uniform float ambient_red;\n"
+    "uniform sampler2D lightmap;\n"
+    "uniform vec2 lightmap_origin;\n"
+    "uniform float lightmap_texels;\n"
+    "uniform float layer_size;\n"
+    "uniform vec2 cell_size;\n"
+    "in vec3 world_position;\n"
+    "in vec3 world_normal;\n"
+    "float baked_occlusion(vec3 n) {\n"
+    "    vec3 p = vec3(world_position.x / cell_size.x, world_position.y / cell_size.y, world_position.z / cell_size.x);\n"
+    "    vec2 cell, local;\n"
+    "    float layer;\n"
+    "    if (abs(n.y) > 0.5) {\n"
+    "        cell = floor(p.xz);\n"
+    "        local = p.xz - cell;\n"
+    "        layer = n.y > 0.0 ? 0.0 : 1.0;\n"
+    "    } else if (abs(n.x) > 0.5) {\n"
+    "        cell = floor(vec2(p.x - n.x * 0.5, p.z));\n"
+    "        local = vec2(p.z - cell.y, p.y);\n"
+    "        layer = n.x > 0.0 ? 2.0 : 3.0;\n"
+    "    } else {\n"
+    "        cell = floor(vec2(p.x, p.z - n.z * 0.5));\n"
+    "        local = vec2(p.x - cell.x, p.y);\n"
+    "        layer = n.z > 0.0 ? 4.0 : 5.0;\n"
+    "    }\n"
+    "    vec2 texel = (cell - lightmap_origin) * lightmap_texels +\n"
+    "                 clamp(local * lightmap_texels, 0.5, lightmap_texels - 0.5) +\n"
+    "                 vec2(mod(layer, 3.0), floor(layer / 3.0)) * layer_size;\n"
+    "    return texture(lightmap, texel / vec2(3.0 * layer_size, 2.0 * layer_size)).r;\n"
+    "}\n"
+    "void main() {\n"
+    "    vec3 n = normalize(world_normal);\n"
+    "    vec3 light = (ambient_base + vec3(ambient_red, 0.0, 0.0)) * baked_occlusion(n);\n"
+    "    ivec2 cluster = ivec2(floor((world_position.xz - cluster_origin) / cluster_size));\n"
+    "    if (all(greaterThanEqual(cluster, ivec2(0))) && all(lessThan(cluster, ivec2(" STRINGIFY(LIGHT_CLUSTER_DIM) ")))) {\n"
+    "        vec2 range = texelFetch(cluster_grid, cluster, 0).xy;\n"
+    "        int first = int(range.x);\n"
+    "        int last = first + int(range.y);\n"
+    "        for (int k = first; k < last; k++) {\n"
+    "            int i = int(texelFetch(light_indices, ivec2(k & (" STRINGIFY(LIGHT_INDEX_ROW) " - 1), k >> " STRINGIFY(LIGHT_INDEX_ROW_SHIFT) "), 0).r);\n"
+    "            vec4 position = texelFetch(light_data, ivec2(0, i), 0);\n"
+    "            vec4 color = texelFetch(light_data, ivec2(1, i), 0);\n"
+    "            vec3 to_light = position.xyz - world_position;\n"
+    "            float d = length(to_light);\n"
+    "            float r2 = d * d / (light_radius * light_radius);\n"
+    "            float fade = clamp(1.0 - r2 * r2, 0.0, 1.0);\n"
+    "            float attenuation = fade * fade / (1.0 + position.w * d + color.w * d * d);\n"
+    "            light += attenuation * max(dot(n, to_light / d), 0.0) * color.rgb;\n"
+    "        }\n"
+    "    }\n"
+    "    vec4 base = gl_Color * texture(diffuse_texture, gl_TexCoord[0].st);\n"
+    "    gl_FragColor = vec4(min(light, 1.0) * base.rgb, base.a);\n"
+    "}\n";
+
+static bool available = false;
+static GLuint program = 0;
+static GLuint light_texture = 0, cluster_texture = 0, index_texture = 0;
+static GLuint unlit_lightmap = 0;
+static GLint view_inverse_location = -1, origin_location = -1;
+static GLint ambient_base_location = -1, ambient_red_location = -1, lightmap_origin_location = -1;
+
+static PointLight lights[LIGHTS_MAX];
+static int light_count = 0;
+static float light_texels[LIGHTS_MAX * 8];
+static int visible_count = 0;
+static float cluster_texels[LIGHT_CLUSTER_DIM * LIGHT_CLUSTER_DIM * 2];
+static int cluster_count[LIGHT_CLUSTER_DIM * LIGHT_CLUSTER_DIM];
+static int cluster_offset[LIGHT_CLUSTER_DIM * LIGHT_CLUSTER_DIM];
+static int cluster_used[LIGHT_CLUSTER_DIM * LIGHT_CLUSTER_DIM];
+static float index_texels[LIGHT_INDEX_MAX];
+static int entry_count = 0, max_per_cluster = 0;
+static float origin_x, origin_z;
+static float ambient_base[3] = {0.0f, 0.0f, 0.0f};
+static float ambient_red = 0.0f;
+
+static GLuint create_float_texture(GLint internal_format, GLenum format, int width, int height) {
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, GL_FLOAT, NULL);
+    return texture;
+}
+
+void lights_init() {
+    available = false;
+    if (!glload_has_float_textures()) return;
+    program = shader_build("luzes", vertex_source, fragment_source);
+    if (!program) return;
+
+    gl_use_program(program);
+    gl_uniform1i(gl_get_uniform_location(program, "diffuse_texture"), 0);
+    gl_uniform1i(gl_get_uniform_location(program, "light_data"), 1);
+    gl_uniform1i(gl_get_uniform_location(program, "cluster_grid"), 2);
+    gl_uniform1i(gl_get_uniform_location(program, "light_indices"), 3);
+    gl_uniform1f(gl_get_uniform_location(program, "cluster_size"), LIGHT_CLUSTER_CELLS * CUBE_SIZE);
+    gl_uniform1f(gl_get_uniform_location(program, "light_radius"), LIGHT_RADIUS);
+    gl_uniform1i(gl_get_uniform_location(program, "lightmap"), 4);
+    gl_uniform1f(gl_get_uniform_location(program, "lightmap_texels"), LIGHTMAP_TEXELS);
+    gl_uniform1f(gl_get_uniform_location(program, "layer_size"), LIGHTMAP_LAYER_SIZE);
+    gl_uniform2f(gl_get_uniform_location(program, "cell_size"), CUBE_SIZE, WALL_HEIGHT);
+    lightmap_origin_location = gl_get_uniform_location(program, "lightmap_origin");
+    view_inverse_location = gl_get_uniform_location(program, "view_inverse");
+    origin_location = gl_get_uniform_location(program, "cluster_origin");
+    ambient_base_location = gl_get_uniform_location(program, "ambient_base");
+    ambient_red_location = gl_get_uniform_location(program, "ambient_red");
+    gl_use_program(0);
+
+    GLint bound = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+    light_texture = create_float_texture(GL_RGBA32F, GL_RGBA, 2, LIGHTS_MAX);
+    cluster_texture = create_float_texture(GL_RG32F, GL_RG, LIGHT_CLUSTER_DIM, LIGHT_CLUSTER_DIM);
+    index_texture = create_float_texture(GL_R32F, GL_RED, LIGHT_INDEX_ROW, LIGHT_INDEX_MAX / LIGHT_INDEX_ROW);
+    static const unsigned char unoccluded = 255;
+    glGenTextures(1, &unlit_lightmap);
+    glBindTexture(GL_TEXTURE_2D, unlit_lightmap);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE8, 1, 1, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, &unoccluded);
+    glBindTexture(GL_TEXTURE_2D, bound);
+    available = true;
+}
+
+bool lights_available() {
+    return available;
+}
+
+void lights_begin_frame(float eye_x, float eye_z) {
+    float size = LIGHT_CLUSTER_CELLS * CUBE_SIZE;
+    origin_x = (floorf(eye_x / size) - LIGHT_CLUSTER_DIM / 2) * size;
+    origin_z = (floorf(eye_z / size) - LIGHT_CLUSTER_DIM / 2) * size;
+    light_count = 0;
+}
+
+bool lights_add(const PointLight* light) {
+    if (light_count == LIGHTS_MAX) return false;
+    lights[light_count++] = *light;
+    return true;
+}
+
+static bool light_touches_cluster(const float* position, int cx, int cz) {
+    float size = LIGHT_CLUSTER_CELLS * CUBE_SIZE;
+    float min_x = origin_x + cx * size, min_z = origin_z + cz * size;
+    float dx = fmaxf(fmaxf(min_x - position[0], 0.0f), position[0] - (min_x + size));
+    float dz = fmaxf(fmaxf(min_z - position[2], 0.0f), position[2] - (min_z + size));
+    return dx * dx + dz * dz <= LIGHT_RADIUS * LIGHT_RADIUS;
+}
+
+static bool light_cluster_range(const float* position, int* x0, int* z0, int* x1, int* z1) {
+    float size = LIGHT_CLUSTER_CELLS * CUBE_SIZE;
+    *x0 = (int)floorf((position[0] - LIGHT_RADIUS - origin_x) / size);
+    *z0 = (int)floorf((position[2] - LIGHT_RADIUS - origin_z) / size);
+    *x1 = (int)floorf((position[0] + LIGHT_RADIUS - origin_x) / size);
+    *z1 = (int)floorf((position[2] + LIGHT_RADIUS - origin_z) / size);
+    if (*x1 < 0 || *z1 < 0 || *x0 >= LIGHT_CLUSTER_DIM || *z0 >= LIGHT_CLUSTER_DIM) return false;
+    if (*x0 < 0) *x0 = 0;
+    if (*z0 < 0) *z0 = 0;
+    if (*x1 >= LIGHT_CLUSTER_DIM) *x1 = LIGHT_CLUSTER_DIM - 1;
+    if (*z1 >= LIGHT_CLUSTER_DIM) *z1 = LIGHT_CLUSTER_DIM - 1;
+    return true;
+}
+
+// Two passes over the visible lights, like the collectible buckets: count each
+// column's lights, prefix-sum into offsets, then scatter the light indices.
+void lights_build() {
+    if (!available) return;
+
+    visible_count = 0;
+    for (int i = 0; i < light_count; i++) {
+        const PointLight* l = &lights[i];
+        if (!frustum_test_box(l->x - LIGHT_RADIUS, l->y - LIGHT_RADIUS, l->z - LIGHT_RADIUS,
+                              l->x + LIGHT_RADIUS, l->y + LIGHT_RADIUS, l->z + LIGHT_RADIUS)) continue;
+        float* texel = &light_texels[visible_count++ * 8];
+        texel[0] = l->x; texel[1] = l->y; texel[2] = l->z; texel[3] = l->linear;
+        texel[4] = l->r; texel[5] = l->g; texel[6] = l->b; texel[7] = l->quadratic;
+    }
+
+    memset(cluster_count, 0, sizeof(cluster_count));
+    entry_count = 0;
+    for (int i = 0; i < visible_count; i++) {
+        const float* position = &light_texels[i * 8];
+        int x0, z0, x1, z1;
+        if (!light_cluster_range(position, &x0, &z0, &x1, &z1)) continue;
+        for (int cz = z0; cz <= z1; cz++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                if (entry_count == LIGHT_INDEX_MAX || !light_touches_cluster(position, cx, cz)) continue;
+                cluster_count[cz * LIGHT_CLUSTER_DIM + cx]++;
+                entry_count++;
+            }
+        }
+    }
+
+    int offset = 0;
+    max_per_cluster = 0;
+    for (int c = 0; c < LIGHT_CLUSTER_DIM * LIGHT_CLUSTER_DIM; c++) {
+        cluster_offset[c] = offset;
+        cluster_used[c] = 0;
+        cluster_texels[c * 2] = (float)offset;
+        cluster_texels[c * 2 + 1] = (float)cluster_count[c];
+        if (cluster_count[c] > max_per_cluster) max_per_cluster = cluster_count[c];
+        offset += cluster_count[c];
+    }
+
+    for (int i = 0; i < visible_count; i++) {
+        const float* position = &light_texels[i * 8];
+        int x0, z0, x1, z1;
+        if (!light_cluster_range(position, &x0, &z0, &x1, &z1)) continue;
+        for (int cz = z0; cz <= z1; cz++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                int c = cz * LIGHT_CLUSTER_DIM + cx;
+                if (cluster_used[c] == cluster_count[c] || !light_touches_cluster(position, cx, cz)) continue;
+                index_texels[cluster_offset[c] + cluster_used[c]++] = (float)i;
+            }
+        }
+    }
+
+    GLint bound = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+    if (visible_count > 0) {
+        glBindTexture(GL_TEXTURE_2D, light_texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 2, visible_count, GL_RGBA, GL_FLOAT, light_texels);
+    }
+    glBindTexture(GL_TEXTURE_2D, cluster_texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, LIGHT_CLUSTER_DIM, LIGHT_CLUSTER_DIM, GL_RG, GL_FLOAT, cluster_texels);
+    if (entry_count > 0) {
+        glBindTexture(GL_TEXTURE_2D, index_texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, LIGHT_INDEX_ROW, (entry_count + LIGHT_INDEX_ROW - 1) / LIGHT_INDEX_ROW,
+                        GL_RED, GL_FLOAT, index_texels);
+    }
+    glBindTexture(GL_TEXTURE_2D, bound);
+}
+
+void lights_set_ambient(const float base[3], float red_boost) {
+    memcpy(ambient_base, base, sizeof(ambient_base));
+    ambient_red = red_boost;
+}
+
+void lights_bind() {
+    if (!available) return;
+
+    // The view is a rigid transform, so its inverse is the transposed rotation
+    // and the negated, rotated translation.
+    GLfloat view[16], inverse[16];
+    glGetFloatv(GL_MODELVIEW_MATRIX, view);
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) inverse[c * 4 + r] = view[r * 4 + c];
+        inverse[r * 4 + 3] = 0.0f;
+        inverse[12 + r] = -(view[r * 4] * view[12] + view[r * 4 + 1] * view[13] + view[r * 4 + 2] * view[14]);
+    }
+    inverse[15] = 1.0f;
+
+    glstate_use_program(program);
+    gl_uniform_matrix4fv(view_inverse_location, 1, GL_FALSE, inverse);
+    gl_uniform2f(origin_location, origin_x, origin_z);
+    gl_uniform3f(ambient_base_location, ambient_base[0], ambient_base[1], ambient_base[2]);
+    gl_uniform1f(ambient_red_location, ambient_red);
+
+    glstate_bind_texture(1, light_texture);
+    glstate_bind_texture(2, cluster_texture);
+    glstate_bind_texture(3, index_texture);
+}
+
+void lights_set_lightmap(GLuint lightmap, int cell_x, int cell_z) {
+    if (!available) return;
+    gl_uniform2f(lightmap_origin_location, (float)cell_x, (float)cell_z);
+    glstate_bind_texture(4, lightmap ? lightmap : unlit_lightmap);
+}
+
+void lights_unbind() {
+    if (available) glstate_use_program(0);
+}
+
+void lights_get_stats(LightStats* stats) {
+    stats->lights = light_count;
+    stats->visible = visible_count;
+    stats->entries = entry_count;
+    stats->max_per_cluster = max_per_cluster;
+}
+
+void lights_cleanup() {
+    if (program) gl_delete_program(program);
+    if (light_texture) glDeleteTextures(1, &light_texture);
+    if (cluster_texture) glDeleteTextures(1, &cluster_texture);
+    if (index_texture) glDeleteTextures(1, &index_texture);
+    if (unlit_lightmap) glDeleteTextures(1, &unlit_lightmap);
+    program = 0;
+    light_texture = cluster_texture = index_texture = unlit_lightmap = 0;
+    available = false;
+}
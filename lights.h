@@ -0,0 +1,40 @@
+#ifndef LIGHTS_H
+#define LIGHTS_H
+
+#include <stdbool.h>
+#include <GL/glut.h>
+
+#define LIGHTS_MAX 1024
+#define LIGHT_CLUSTER_DIM 32
+#define LIGHT_INDEX_MAX (32 * 1024)
+
+typedef struct {
+    float x, y, z;
+    float r, g, b;
+    float linear, quadratic;
+} PointLight;
+
+typedef struct {
+    int lights, visible;
+    int entries, max_per_cluster;
+} LightStats;
+
+// Point lights are culled against the frustum and binned on the CPU into a
+// LIGHT_CLUSTER_DIM^2 grid of maze columns around the eye. The per-pixel
+// shader reads its column's light list from float textures.
+void lights_init();
+bool lights_available();
+void lights_begin_frame(float eye_x, float eye_z);
+bool lights_add(const PointLight* light);
+void lights_build();
+void lights_set_ambient(const float base[3], float red_boost);
+// Binds the lit program for geometry drawn in world space under the current view matrix.
+void lights_bind();
+// Selects the chunk atlas the next draws sample their baked occlusion from;
+// 0 leaves them unoccluded. cell_x/cell_z is the chunk's first cell.
+void lights_set_lightmap(GLuint lightmap, int cell_x, int cell_z);
+void lights_unbind();
+void lights_get_stats(LightStats* stats);
+void lights_cleanup();
+
+#endif
@@ -1,6 +1,14 @@
 #include <GL/glut.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "game.h"
-#include "player.h"
+#include "render.h"
+#include "mazegen.h"
+#include "benchmark.h"
+#include "profiler.h"
+#include "texture.h"
+#include "jobs.h"
 
 void display_callback() {
     game_render();
@@ -11,44 +19,133 @@ void reshape_callback(int w, int h) {
 }
 
 void keyboard_callback(unsigned char key, int x, int y) {
-    player_handle_keyboard(key, true);
+    game_handle_keyboard(key, true);
 }
 
 void keyboard_up_callback(unsigned char key, int x, int y) {
-    player_handle_keyboard(key, false);
+    game_handle_keyboard(key, false);
+}
+
+void special_callback(int key, int x, int y) {
+    game_handle_special_key(key);
 }
 
 void mouse_motion_callback(int x, int y) {
-    player_handle_mouse_motion(x, y);
+    game_handle_mouse_motion(x, y);
 }
 
 void mouse_click_callback(int button, int state, int x, int y) {
     game_handle_mouse_click(button, state, x, y);
 }
 
-void update_callback(int value) {
-    game_update();
-    glutTimerFunc(16, update_callback, 0);
+void idle_callback() {
+    glutPostRedisplay();
+}
+
+typedef struct {
+    LevelConfig level;
+    int gen_bench;
+    int path_bench;
+    const char* record_path;
+    const char* replay_path;
+    bool render_bench;
+    RenderBenchConfig bench;
+} Options;
+
+static bool parse_arguments(int argc, char** argv, Options* options) {
+    LevelConfig* level = &options->level;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(arg, "--gen-bench") == 0) {
+            options->gen_bench = 0;
+            if (has_value && argv[i + 1][0] != '-') options->gen_bench = atoi(argv[++i]);
+        } else if (strcmp(arg, "--path-bench") == 0) {
+            options->path_bench = 0;
+            if (has_value && argv[i + 1][0] != '-') options->path_bench = atoi(argv[++i]);
+        } else if (strcmp(arg, "--benchmark") == 0) {
+            options->render_bench = true;
+            if (has_value && argv[i + 1][0] != '-') options->bench.frames = atoi(argv[++i]);
+        } else if (strcmp(arg, "--light-bench") == 0) {
+            options->render_bench = true;
+            options->bench.max_lights = LIGHTS_MAX;
+            if (has_value && argv[i + 1][0] != '-') options->bench.max_lights = atoi(argv[++i]);
+        } else if (strcmp(arg, "--benchmark-out") == 0 && has_value) {
+            options->bench.output = argv[++i];
+        } else if (strcmp(arg, "--size") == 0 && has_value) {
+            level->size = atoi(argv[++i]);
+        } else if (strcmp(arg, "--seed") == 0 && has_value) {
+            level->seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--algo") == 0 && has_value) {
+            if (!mazegen_parse_algorithm(argv[++i], &level->algorithm)) {
+                fprintf(stderr, "Algoritmo desconhecido: %s\n", argv[i]);
+                return false;
+            }
+        } else if (strcmp(arg, "--collectibles") == 0 && has_value) {
+            level->collectibles = atoi(argv[++i]);
+        } else if (strcmp(arg, "--chasers") == 0 && has_value) {
+            level->chasers = atoi(argv[++i]);
+        } else if (strcmp(arg, "--record") == 0 && has_value) {
+            options->record_path = argv[++i];
+        } else if (strcmp(arg, "--replay") == 0 && has_value) {
+            options->replay_path = argv[++i];
+        } else if (strcmp(arg, "--profile") == 0 && has_value) {
+            profiler_set_dump_path(argv[++i]);
+        } else if (strcmp(arg, "--renderer") == 0 && has_value) {
+            RenderBackend backend;
+            if (!render_parse_backend(argv[++i], &backend)) {
+                fprintf(stderr, "Renderizador desconhecido: %s\n", argv[i]);
+                return false;
+            }
+            render_set_backend(backend);
+        } else if (strcmp(arg, "--texture-budget") == 0 && has_value) {
+            texture_set_budget((size_t)atoi(argv[++i]) * 1024 * 1024);
+        }
+    }
+    return true;
 }
 
 int main(int argc, char** argv) {
+    Options options = {{0, 1, MAZEGEN_BACKTRACKER, 0, 0}, -1, -1, NULL, NULL, false, {1000, 30, 1280, 720, NULL, 0}};
+    if (!parse_arguments(argc, argv, &options)) {
+        return -1;
+    }
+    if (options.gen_bench >= 0) {
+        return benchmark_maze_generation(options.gen_bench);
+    }
+    if (options.path_bench >= 0) {
+        return benchmark_pathfinding(options.path_bench);
+    }
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH);
     glutInitWindowSize(1280, 720);
     glutCreateWindow("MAZE OF LOST SOULS");
 
-    if (!game_init()) {
+    if (!game_init(&options.level, options.record_path, options.replay_path)) {
         return -1;
     }
+    if (options.render_bench) {
+        if (options.bench.frames <= 0) options.bench.frames = 1000;
+        int result = game_run_benchmark(&options.bench);
+        render_cleanup();
+        jobs_shutdown();
+        return result;
+    }
 
     glutDisplayFunc(display_callback);
     glutReshapeFunc(reshape_callback);
     glutKeyboardFunc(keyboard_callback);
     glutKeyboardUpFunc(keyboard_up_callback);
+    glutSpecialFunc(special_callback);
     glutPassiveMotionFunc(mouse_motion_callback);
     glutMouseFunc(mouse_click_callback);
-    glutTimerFunc(16, update_callback, 0);
+    glutIdleFunc(idle_callback);
 
+    profiler_set_enabled(true);
+    if (!game_start()) {
+        return -1;
+    }
     glutMainLoop();
 
     game_cleanup();
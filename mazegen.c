@@ -0,0 +1,340 @@
+#include <stdlib.h>
+#include <string.h>
+#include "mazegen.h"
+#include "config.h"
+
+static const char* algorithm_names[MAZEGEN_ALGORITHM_COUNT] = {"backtracker", "wilson", "eller"};
+static const int dir_x[4] = {1, -1, 0, 0};
+static const int dir_z[4] = {0, 0, 1, -1};
+
+void maze_rng_seed(MazeRng* rng, uint64_t seed) {
+    rng->state = seed;
+}
+
+uint32_t maze_rng_next(MazeRng* rng) {
+    uint64_t z = (rng->state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return (uint32_t)((z ^ (z >> 31)) >> 32);
+}
+
+uint32_t maze_rng_range(MazeRng* rng, uint32_t n) {
+    return (uint32_t)(((uint64_t)maze_rng_next(rng) * n) >> 32);
+}
+
+static void carve_room(World* world, int i, int j) {
+    world_set(world, 2 * i + 1, 2 * j + 1, 0);
+}
+
+static bool is_room_carved(const World* world, int i, int j) {
+    return world_get(world, 2 * i + 1, 2 * j + 1) != 1;
+}
+
+static void carve_between(World* world, int i, int j, int d) {
+    world_set(world, 2 * i + 1 + dir_x[d], 2 * j + 1 + dir_z[d], 0);
+}
+
+static size_t generate_backtracker(World* world, int rw, int rh, MazeRng* rng) {
+    size_t rooms = (size_t)rw * rh;
+    uint32_t* stack = malloc(rooms * sizeof(uint32_t));
+    if (!stack) return 0;
+
+    int top = 0;
+    carve_room(world, 0, 0);
+    stack[top++] = 0;
+
+    while (top > 0) {
+        uint32_t current = stack[top - 1];
+        int i = current / rh, j = current % rh;
+
+        int options[4], count = 0;
+        for (int d = 0; d < 4; d++) {
+            int ni = i + dir_x[d], nj = j + dir_z[d];
+            if (ni < 0 || ni >= rw || nj < 0 || nj >= rh) continue;
+            if (!is_room_carved(world, ni, nj)) options[count++] = d;
+        }
+
+        if (count == 0) {
+            top--;
+            continue;
+        }
+
+        int d = options[maze_rng_range(rng, count)];
+        int ni = i + dir_x[d], nj = j + dir_z[d];
+        carve_between(world, i, j, d);
+        carve_room(world, ni, nj);
+        stack[top++] = (uint32_t)ni * rh + nj;
+    }
+
+    free(stack);
+    return rooms * sizeof(uint32_t);
+}
+
+static size_t generate_wilson(World* world, int rw, int rh, MazeRng* rng) {
+    size_t rooms = (size_t)rw * rh;
+    unsigned char* walk_dir = malloc(rooms);
+    if (!walk_dir) return 0;
+
+    carve_room(world, maze_rng_range(rng, rw), maze_rng_range(rng, rh));
+
+    for (int si = 0; si < rw; si++) {
+        for (int sj = 0; sj < rh; sj++) {
+            if (is_room_carved(world, si, sj)) continue;
+
+            int i = si, j = sj;
+            while (!is_room_carved(world, i, j)) {
+                int d, ni, nj;
+                do {
+                    d = maze_rng_range(rng, 4);
+                    ni = i + dir_x[d];
+                    nj = j + dir_z[d];
+                } while (ni < 0 || ni >= rw || nj < 0 || nj >= rh);
+                walk_dir[(size_t)i * rh + j] = (unsigned char)d;
+                i = ni;
+                j = nj;
+            }
+
+            // Retracing the recorded directions drops any loops the walk made.
+            i = si;
+            j = sj;
+            while (!is_room_carved(world, i, j)) {
+                int d = walk_dir[(size_t)i * rh + j];
+                carve_room(world, i, j);
+                carve_between(world, i, j, d);
+                i += dir_x[d];
+                j += dir_z[d];
+            }
+        }
+    }
+
+    free(walk_dir);
+    return rooms;
+}
+
+typedef struct {
+    int* set_of;
+    int* next;
+    int* head;
+    int* size;
+    int* remaining;
+    int* free_ids;
+    int free_count;
+    unsigned char* has_down;
+    unsigned char* down;
+} EllerSets;
+
+static void eller_merge(EllerSets* sets, int a, int b) {
+    if (sets->size[a] < sets->size[b]) {
+        int t = a; a = b; b = t;
+    }
+
+    int last = -1;
+    for (int m = sets->head[b]; m >= 0; m = sets->next[m]) {
+        sets->set_of[m] = a;
+        last = m;
+    }
+    sets->next[last] = sets->head[a];
+    sets->head[a] = sets->head[b];
+    sets->size[a] += sets->size[b];
+    sets->size[b] = 0;
+    sets->free_ids[sets->free_count++] = b;
+}
+
+size_t mazegen_eller_stream(int width, int height, uint32_t seed, int collectibles, MazeRowFunc emit, void* user) {
+    int rw = (width - 1) / 2, rh = (height - 1) / 2;
+    if (rw <= 0 || rh <= 0) return 0;
+
+    MazeRng rng;
+    maze_rng_seed(&rng, seed);
+
+    EllerSets sets;
+    size_t int_bytes = (size_t)rw * sizeof(int);
+    int* ints = malloc(int_bytes * 6);
+    unsigned char* bytes = malloc((size_t)rw * 2 + (size_t)width * 2);
+    if (!ints || !bytes) {
+        free(ints);
+        free(bytes);
+        return 0;
+    }
+
+    sets.set_of = ints;
+    sets.next = ints + rw;
+    sets.head = ints + rw * 2;
+    sets.size = ints + rw * 3;
+    sets.remaining = ints + rw * 4;
+    sets.free_ids = ints + rw * 5;
+    sets.has_down = bytes;
+    sets.down = bytes + rw;
+    unsigned char* room_row = bytes + rw * 2;
+    unsigned char* below_row = room_row + width;
+
+    sets.free_count = 0;
+    for (int id = rw - 1; id >= 0; id--) sets.free_ids[sets.free_count++] = id;
+    for (int c = 0; c < rw; c++) sets.set_of[c] = -1;
+
+    uint32_t collectible_threshold = 0;
+    if (collectibles > 0) {
+        double p = (double)collectibles / ((double)rw * rh);
+        collectible_threshold = p >= 1.0 ? UINT32_MAX : (uint32_t)(p * 4294967296.0);
+    }
+
+    memset(below_row, 1, width);
+    emit(0, below_row, width, user);
+
+    for (int j = 0; j < rh; j++) {
+        bool last = j == rh - 1;
+        memset(room_row, 1, width);
+        memset(below_row, 1, width);
+
+        for (int c = 0; c < rw; c++) {
+            room_row[2 * c + 1] = 0;
+            if (sets.set_of[c] < 0) {
+                int id = sets.free_ids[--sets.free_count];
+                sets.set_of[c] = id;
+                sets.head[id] = c;
+                sets.next[c] = -1;
+                sets.size[id] = 1;
+            }
+        }
+
+        for (int c = 0; c + 1 < rw; c++) {
+            int a = sets.set_of[c], b = sets.set_of[c + 1];
+            if (a != b && (last || (maze_rng_next(&rng) & 1))) {
+                room_row[2 * c + 2] = 0;
+                eller_merge(&sets, a, b);
+            }
+        }
+
+        if (!last) {
+            for (int c = 0; c < rw; c++) {
+                int id = sets.set_of[c];
+                sets.remaining[id] = sets.size[id];
+                sets.has_down[id] = 0;
+            }
+            // Every set must reach the next row at least once, otherwise it would be sealed off.
+            for (int c = 0; c < rw; c++) {
+                int id = sets.set_of[c];
+                sets.remaining[id]--;
+                sets.down[c] = (maze_rng_next(&rng) & 1) || (sets.remaining[id] == 0 && !sets.has_down[id]);
+                if (sets.down[c]) {
+                    sets.has_down[id] = 1;
+                    below_row[2 * c + 1] = 0;
+                }
+            }
+
+            for (int c = 0; c < rw; c++) {
+                int id = sets.set_of[c];
+                sets.head[id] = -1;
+                sets.size[id] = 0;
+            }
+            for (int c = 0; c < rw; c++) {
+                if (!sets.down[c]) {
+                    sets.set_of[c] = -1;
+                    continue;
+                }
+                int id = sets.set_of[c];
+                sets.next[c] = sets.head[id];
+                sets.head[id] = c;
+                sets.size[id]++;
+            }
+        }
+
+        if (collectible_threshold > 0) {
+            for (int c = 0; c < rw; c++) {
+                if ((c == 0 && j == 0) || (c == rw - 1 && last)) continue;
+                if (maze_rng_next(&rng) < collectible_threshold) room_row[2 * c + 1] = 2;
+            }
+        }
+
+        emit(2 * j + 1, room_row, width, user);
+        emit(2 * j + 2, below_row, width, user);
+    }
+
+    memset(below_row, 1, width);
+    for (int z = 2 * rh + 1; z < height; z++) {
+        emit(z, below_row, width, user);
+    }
+
+    free(ints);
+    free(bytes);
+    return int_bytes * 6 + (size_t)rw * 2 + (size_t)width * 2;
+}
+
+static void write_world_row(int z, const unsigned char* row, int width, void* user) {
+    World* world = user;
+    for (int x = 0; x < width; x++) {
+        if (row[x] != 1) world_set(world, x, z, row[x]);
+    }
+}
+
+static void place_collectibles(World* world, int rw, int rh, int count, MazeRng* rng) {
+    size_t rooms = (size_t)rw * rh;
+    if (rooms <= 2) return;
+    if ((size_t)count > rooms - 2) count = (int)(rooms - 2);
+
+    int placed = 0;
+    while (placed < count) {
+        int i = maze_rng_range(rng, rw), j = maze_rng_range(rng, rh);
+        int x = 2 * i + 1, z = 2 * j + 1;
+        if ((i == 0 && j == 0) || world_is_exit(world, x, z)) continue;
+        if (world_get(world, x, z) != 0) continue;
+        world_set(world, x, z, 2);
+        placed++;
+    }
+}
+
+int mazegen_default_collectibles(int size) {
+    int rooms = ((size - 1) / 2) * ((size - 1) / 2);
+    int count = rooms / 40;
+    return count < 2 ? 2 : count;
+}
+
+bool mazegen_generate(World* world, const LevelConfig* level, size_t* work_bytes) {
+    int size = level->size < 5 ? 5 : level->size;
+    if (!world_create(world, size, size)) return false;
+
+    int rw = (size - 1) / 2, rh = (size - 1) / 2;
+    world->exit_x = 2 * (rw - 1) + 1;
+    world->exit_z = 2 * (rh - 1) + 1;
+    world->start_x = 1.5f * CUBE_SIZE;
+    world->start_z = 1.5f * CUBE_SIZE;
+
+    MazeRng rng;
+    maze_rng_seed(&rng, level->seed);
+    size_t bytes = 0;
+
+    switch (level->algorithm) {
+        case MAZEGEN_WILSON:
+            bytes = generate_wilson(world, rw, rh, &rng);
+            break;
+        case MAZEGEN_ELLER:
+            bytes = mazegen_eller_stream(size, size, level->seed, level->collectibles, write_world_row, world);
+            break;
+        default:
+            bytes = generate_backtracker(world, rw, rh, &rng);
+            break;
+    }
+
+    if (level->algorithm != MAZEGEN_ELLER) {
+        place_collectibles(world, rw, rh, level->collectibles, &rng);
+    } else if (level->collectibles > 0 && world_count_tiles(world, 2) == 0) {
+        place_collectibles(world, rw, rh, 1, &rng);
+    }
+
+    if (work_bytes) *work_bytes = bytes;
+    return bytes > 0;
+}
+
+bool mazegen_parse_algorithm(const char* name, MazeAlgorithm* algorithm) {
+    for (int i = 0; i < MAZEGEN_ALGORITHM_COUNT; i++) {
+        if (strcmp(name, algorithm_names[i]) == 0) {
+            *algorithm = (MazeAlgorithm)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* mazegen_algorithm_name(MazeAlgorithm algorithm) {
+    return algorithm < MAZEGEN_ALGORITHM_COUNT ? algorithm_names[algorithm] : "?";
+}
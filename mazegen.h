@@ -0,0 +1,41 @@
+#ifndef MAZEGEN_H
+#define MAZEGEN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "world.h"
+
+typedef enum {
+    MAZEGEN_BACKTRACKER,
+    MAZEGEN_WILSON,
+    MAZEGEN_ELLER,
+    MAZEGEN_ALGORITHM_COUNT
+} MazeAlgorithm;
+
+typedef struct {
+    int size;
+    uint32_t seed;
+    MazeAlgorithm algorithm;
+    int collectibles;
+    int chasers;
+} LevelConfig;
+
+typedef struct {
+    uint64_t state;
+} MazeRng;
+
+typedef void (*MazeRowFunc)(int z, const unsigned char* row, int width, void* user);
+
+void maze_rng_seed(MazeRng* rng, uint64_t seed);
+uint32_t maze_rng_next(MazeRng* rng);
+uint32_t maze_rng_range(MazeRng* rng, uint32_t n);
+
+bool mazegen_generate(World* world, const LevelConfig* level, size_t* work_bytes);
+size_t mazegen_eller_stream(int width, int height, uint32_t seed, int collectibles, MazeRowFunc emit, void* user);
+
+int mazegen_default_collectibles(int size);
+bool mazegen_parse_algorithm(const char* name, MazeAlgorithm* algorithm);
+const char* mazegen_algorithm_name(MazeAlgorithm algorithm);
+
+#endif
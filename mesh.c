@@ -0,0 +1,347 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mesh.h"
+#include "glload.h"
+
+static bool is_solid(const World* world, int x, int z) {
+    if (world_is_exit(world, x, z)) return false;
+    return world_get(world, x, z) == 1;
+}
+
+static void mesh_reserve(Mesh* mesh, int vertices, int indices) {
+    if (mesh->vertex_count + vertices > mesh->vertex_capacity) {
+        mesh->vertex_capacity = (mesh->vertex_count + vertices) * 2;
+        mesh->vertices = realloc(mesh->vertices, mesh->vertex_capacity * sizeof(MeshVertex));
+    }
+    if (mesh->index_count + indices > mesh->index_capacity) {
+        mesh->index_capacity = (mesh->index_count + indices) * 2;
+        mesh->indices = realloc(mesh->indices, mesh->index_capacity * sizeof(GLuint));
+    }
+}
+
+static void add_quad(Mesh* mesh, const float corners[4][3], const float uvs[4][2], float nx, float ny, float nz) {
+    mesh_reserve(mesh, 4, 6);
+
+    GLuint base = mesh->vertex_count;
+    for (int i = 0; i < 4; i++) {
+        MeshVertex* v = &mesh->vertices[mesh->vertex_count++];
+        v->x = corners[i][0]; v->y = corners[i][1]; v->z = corners[i][2];
+        v->nx = nx; v->ny = ny; v->nz = nz;
+        v->u = uvs[i][0]; v->v = uvs[i][1];
+    }
+
+    static const GLuint order[6] = {0, 1, 2, 0, 2, 3};
+    for (int i = 0; i < 6; i++) {
+        mesh->indices[mesh->index_count++] = base + order[i];
+    }
+}
+
+typedef struct {
+    int x0, z0, x1, z1;
+} MeshRect;
+
+static MeshRect* rect_buffer = NULL;
+static int rect_capacity = 0;
+
+static int greedy_rects(unsigned char* mask, int w, int h) {
+    int count = 0;
+    for (int x = 0; x < w; x++) {
+        for (int z = 0; z < h; z++) {
+            if (!mask[x * h + z]) continue;
+
+            int z1 = z + 1;
+            while (z1 < h && mask[x * h + z1]) z1++;
+
+            int x1 = x + 1;
+            for (; x1 < w; x1++) {
+                int k = z;
+                while (k < z1 && mask[x1 * h + k]) k++;
+                if (k < z1) break;
+            }
+
+            for (int i = x; i < x1; i++) {
+                memset(&mask[i * h + z], 0, z1 - z);
+            }
+
+            if (count == rect_capacity) {
+                rect_capacity = rect_capacity ? rect_capacity * 2 : 64;
+                rect_buffer = realloc(rect_buffer, rect_capacity * sizeof(MeshRect));
+            }
+            rect_buffer[count].x0 = x; rect_buffer[count].z0 = z;
+            rect_buffer[count].x1 = x1; rect_buffer[count].z1 = z1;
+            count++;
+        }
+    }
+    return count;
+}
+
+static void add_wall_run(Mesh* mesh, int axis, int dir, int plane, int a0, int a1) {
+    float p = plane * CUBE_SIZE;
+    float s0 = a0 * CUBE_SIZE, s1 = a1 * CUBE_SIZE;
+    float y0 = 0.0f, y1 = WALL_HEIGHT;
+    float len = (float)(a1 - a0);
+    float t[4][2] = {{0, 0}, {len, 0}, {len, 1}, {0, 1}};
+
+    if (axis == 0 && dir > 0) {
+        float c[4][3] = {{s0, y0, p}, {s1, y0, p}, {s1, y1, p}, {s0, y1, p}};
+        add_quad(mesh, c, t, 0, 0, 1);
+    } else if (axis == 0) {
+        float c[4][3] = {{s1, y0, p}, {s0, y0, p}, {s0, y1, p}, {s1, y1, p}};
+        add_quad(mesh, c, t, 0, 0, -1);
+    } else if (dir > 0) {
+        float c[4][3] = {{p, y0, s1}, {p, y0, s0}, {p, y1, s0}, {p, y1, s1}};
+        add_quad(mesh, c, t, 1, 0, 0);
+    } else {
+        float c[4][3] = {{p, y0, s0}, {p, y0, s1}, {p, y1, s1}, {p, y1, s0}};
+        add_quad(mesh, c, t, -1, 0, 0);
+    }
+}
+
+static void build_wall_block(Mesh* mesh, const World* world, int bx0, int bz0, int bx1, int bz1) {
+    // Each side plane is merged into runs along its own axis, since every run spans the full wall height.
+    unsigned char row[MESH_BLOCK_SIZE];
+    for (int dir = -1; dir <= 1; dir += 2) {
+        for (int z = bz0; z < bz1; z++) {
+            for (int x = bx0; x < bx1; x++) {
+                row[x - bx0] = is_solid(world, x, z) && !is_solid(world, x, z + dir);
+                mesh->unmerged_quads += row[x - bx0];
+            }
+            int count = greedy_rects(row, bx1 - bx0, 1);
+            for (int i = 0; i < count; i++) {
+                add_wall_run(mesh, 0, dir, dir > 0 ? z + 1 : z, bx0 + rect_buffer[i].x0, bx0 + rect_buffer[i].x1);
+            }
+        }
+        for (int x = bx0; x < bx1; x++) {
+            for (int z = bz0; z < bz1; z++) {
+                row[z - bz0] = is_solid(world, x, z) && !is_solid(world, x + dir, z);
+                mesh->unmerged_quads += row[z - bz0];
+            }
+            int count = greedy_rects(row, 1, bz1 - bz0);
+            for (int i = 0; i < count; i++) {
+                add_wall_run(mesh, 1, dir, dir > 0 ? x + 1 : x, bz0 + rect_buffer[i].z0, bz0 + rect_buffer[i].z1);
+            }
+        }
+    }
+}
+
+static void build_plane_block(Mesh* mesh, const World* world, int bx0, int bz0, int bx1, int bz1,
+                              float y, float ny, bool with_hole) {
+    unsigned char mask[MESH_BLOCK_SIZE * MESH_BLOCK_SIZE];
+    int w = bx1 - bx0, h = bz1 - bz0;
+    memset(mask, 1, w * h);
+    mesh->unmerged_quads += w * h;
+    int ex = world->exit_x, ez = world->exit_z;
+    if (with_hole && ex >= bx0 && ex < bx1 && ez >= bz0 && ez < bz1) {
+        mask[(ex - bx0) * h + (ez - bz0)] = 0;
+        mesh->unmerged_quads--;
+    }
+
+    int count = greedy_rects(mask, w, h);
+    for (int i = 0; i < count; i++) {
+        const MeshRect* r = &rect_buffer[i];
+        int cx0 = bx0 + r->x0, cx1 = bx0 + r->x1;
+        int cz0 = bz0 + r->z0, cz1 = bz0 + r->z1;
+        float x0 = cx0 * CUBE_SIZE, x1 = cx1 * CUBE_SIZE;
+        float z0 = cz0 * CUBE_SIZE, z1 = cz1 * CUBE_SIZE;
+        float c[4][3] = {{x0, y, z0}, {x0, y, z1}, {x1, y, z1}, {x1, y, z0}};
+        float t[4][2] = {{cx0, cz0}, {cx0, cz1}, {cx1, cz1}, {cx1, cz0}};
+        add_quad(mesh, c, t, 0, ny, 0);
+    }
+}
+
+typedef struct {
+    int x0, z0, x1, z1;
+} MeshRegion;
+
+static MeshRegion begin_chunk(Mesh* mesh, const World* world, int cx, int cz) {
+    mesh_free(mesh);
+
+    MeshRegion region;
+    region.x0 = cx * CHUNK_SIZE;
+    region.z0 = cz * CHUNK_SIZE;
+    region.x1 = region.x0 + CHUNK_SIZE < world->width ? region.x0 + CHUNK_SIZE : world->width;
+    region.z1 = region.z0 + CHUNK_SIZE < world->height ? region.z0 + CHUNK_SIZE : world->height;
+
+    mesh->blocks_x = (region.x1 - region.x0 + MESH_BLOCK_SIZE - 1) / MESH_BLOCK_SIZE;
+    mesh->blocks_z = (region.z1 - region.z0 + MESH_BLOCK_SIZE - 1) / MESH_BLOCK_SIZE;
+    mesh->blocks = calloc(mesh->blocks_x * mesh->blocks_z, sizeof(MeshBlock));
+    return region;
+}
+
+static void block_extent(int b, int base, int limit, int* c0, int* c1) {
+    *c0 = base + b * MESH_BLOCK_SIZE;
+    *c1 = *c0 + MESH_BLOCK_SIZE;
+    if (*c1 > limit) *c1 = limit;
+}
+
+void mesh_build_walls(Mesh* mesh, const World* world, int cx, int cz) {
+    MeshRegion region = begin_chunk(mesh, world, cx, cz);
+
+    // Top faces sit flush against the ceiling and bottoms against the floor, so only sides are kept.
+    for (int bx = 0; bx < mesh->blocks_x; bx++) {
+        for (int bz = 0; bz < mesh->blocks_z; bz++) {
+            int x0, x1, z0, z1;
+            block_extent(bx, region.x0, region.x1, &x0, &x1);
+            block_extent(bz, region.z0, region.z1, &z0, &z1);
+
+            MeshBlock* block = &mesh->blocks[bx * mesh->blocks_z + bz];
+            block->first_index = mesh->index_count;
+            build_wall_block(mesh, world, x0, z0, x1, z1);
+            block->index_count = mesh->index_count - block->first_index;
+        }
+    }
+}
+
+static void build_plane(Mesh* mesh, const World* world, int cx, int cz, float y, float ny, bool with_hole) {
+    MeshRegion region = begin_chunk(mesh, world, cx, cz);
+
+    for (int bx = 0; bx < mesh->blocks_x; bx++) {
+        for (int bz = 0; bz < mesh->blocks_z; bz++) {
+            int x0, x1, z0, z1;
+            block_extent(bx, region.x0, region.x1, &x0, &x1);
+            block_extent(bz, region.z0, region.z1, &z0, &z1);
+
+            MeshBlock* block = &mesh->blocks[bx * mesh->blocks_z + bz];
+            block->first_index = mesh->index_count;
+            build_plane_block(mesh, world, x0, z0, x1, z1, y, ny, with_hole);
+            block->index_count = mesh->index_count - block->first_index;
+        }
+    }
+}
+
+void mesh_build_floor(Mesh* mesh, const World* world, int cx, int cz) {
+    build_plane(mesh, world, cx, cz, 0.0f, 1.0f, true);
+}
+
+void mesh_build_ceiling(Mesh* mesh, const World* world, int cx, int cz) {
+    build_plane(mesh, world, cx, cz, WALL_HEIGHT, -1.0f, false);
+}
+
+void mesh_add_stats(MeshStats* stats, const Mesh* mesh) {
+    stats->unmerged_quads += mesh->unmerged_quads;
+    stats->vertices += mesh->vertex_count;
+    stats->triangles += mesh->index_count / 3;
+}
+
+void mesh_print_stats(const char* name, const MeshStats* stats) {
+    printf("Malha %s: %d vertices / %d triangulos -> %d vertices / %d triangulos\n",
+           name, stats->unmerged_quads * 4, stats->unmerged_quads * 2,
+           stats->vertices, stats->triangles);
+}
+
+static void set_client_arrays(const char* base) {
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(MeshVertex), base + offsetof(MeshVertex, x));
+    glNormalPointer(GL_FLOAT, sizeof(MeshVertex), base + offsetof(MeshVertex, nx));
+    glTexCoordPointer(2, GL_FLOAT, sizeof(MeshVertex), base + offsetof(MeshVertex, u));
+}
+
+static void unset_client_arrays() {
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void mesh_upload(Mesh* mesh) {
+    if (mesh->index_count == 0) return;
+
+    if (glload_has_vbo()) {
+        gl_gen_buffers(1, &mesh->vbo);
+        gl_bind_buffer(GL_ARRAY_BUFFER, mesh->vbo);
+        gl_buffer_data(GL_ARRAY_BUFFER, mesh->vertex_count * sizeof(MeshVertex), mesh->vertices, GL_STATIC_DRAW);
+        gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+
+        gl_gen_buffers(1, &mesh->ibo);
+        gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ibo);
+        gl_buffer_data(GL_ELEMENT_ARRAY_BUFFER, mesh->index_count * sizeof(GLuint), mesh->indices, GL_STATIC_DRAW);
+        gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    } else {
+        int block_count = mesh->blocks_x * mesh->blocks_z;
+        mesh->display_list = glGenLists(block_count + 1);
+
+        glNewList(mesh->display_list, GL_COMPILE);
+        set_client_arrays((const char*)mesh->vertices);
+        glDrawElements(GL_TRIANGLES, mesh->index_count, GL_UNSIGNED_INT, mesh->indices);
+        unset_client_arrays();
+        glEndList();
+
+        for (int i = 0; i < block_count; i++) {
+            glNewList(mesh->display_list + 1 + i, GL_COMPILE);
+            if (mesh->blocks[i].index_count > 0) {
+                set_client_arrays((const char*)mesh->vertices);
+                glDrawElements(GL_TRIANGLES, mesh->blocks[i].index_count, GL_UNSIGNED_INT,
+                               mesh->indices + mesh->blocks[i].first_index);
+                unset_client_arrays();
+            }
+            glEndList();
+        }
+    }
+
+    free(mesh->vertices);
+    free(mesh->indices);
+    mesh->vertices = NULL;
+    mesh->indices = NULL;
+    mesh->vertex_capacity = 0;
+    mesh->index_capacity = 0;
+}
+
+void mesh_draw(const Mesh* mesh) {
+    if (mesh->index_count == 0) return;
+
+    if (mesh->display_list) {
+        glCallList(mesh->display_list);
+        return;
+    }
+
+    gl_bind_buffer(GL_ARRAY_BUFFER, mesh->vbo);
+    gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ibo);
+    set_client_arrays(NULL);
+    glDrawElements(GL_TRIANGLES, mesh->index_count, GL_UNSIGNED_INT, NULL);
+    unset_client_arrays();
+    gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+}
+
+int mesh_draw_blocks(const Mesh* mesh, const bool* visible) {
+    if (mesh->index_count == 0) return 0;
+    int block_count = mesh->blocks_x * mesh->blocks_z;
+    int draw_calls = 0;
+
+    if (mesh->display_list) {
+        for (int i = 0; i < block_count; i++) {
+            if (!visible[i]) continue;
+            glCallList(mesh->display_list + 1 + i);
+            draw_calls++;
+        }
+        return draw_calls;
+    }
+
+    gl_bind_buffer(GL_ARRAY_BUFFER, mesh->vbo);
+    gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ibo);
+    set_client_arrays(NULL);
+    for (int i = 0; i < block_count; i++) {
+        const MeshBlock* block = &mesh->blocks[i];
+        if (!visible[i] || block->index_count == 0) continue;
+        glDrawElements(GL_TRIANGLES, block->index_count, GL_UNSIGNED_INT,
+                       (const char*)NULL + block->first_index * sizeof(GLuint));
+        draw_calls++;
+    }
+    unset_client_arrays();
+    gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+    return draw_calls;
+}
+
+void mesh_free(Mesh* mesh) {
+    if (mesh->vbo) gl_delete_buffers(1, &mesh->vbo);
+    if (mesh->ibo) gl_delete_buffers(1, &mesh->ibo);
+    if (mesh->display_list) glDeleteLists(mesh->display_list, mesh->blocks_x * mesh->blocks_z + 1);
+    free(mesh->vertices);
+    free(mesh->indices);
+    free(mesh->blocks);
+    memset(mesh, 0, sizeof(*mesh));
+}
@@ -0,0 +1,50 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <stdbool.h>
+#include <GL/glut.h>
+#include "config.h"
+#include "world.h"
+
+typedef struct {
+    float x, y, z;
+    float nx, ny, nz;
+    float u, v;
+} MeshVertex;
+
+#define MESH_BLOCK_SIZE 8
+
+typedef struct {
+    int first_index;
+    int index_count;
+} MeshBlock;
+
+typedef struct {
+    MeshVertex* vertices;
+    int vertex_count, vertex_capacity;
+    GLuint* indices;
+    int index_count, index_capacity;
+    GLuint vbo, ibo;
+    GLuint display_list;
+    int unmerged_quads;
+    MeshBlock* blocks;
+    int blocks_x, blocks_z;
+} Mesh;
+
+typedef struct {
+    int unmerged_quads;
+    int vertices;
+    int triangles;
+} MeshStats;
+
+void mesh_build_walls(Mesh* mesh, const World* world, int cx, int cz);
+void mesh_build_floor(Mesh* mesh, const World* world, int cx, int cz);
+void mesh_build_ceiling(Mesh* mesh, const World* world, int cx, int cz);
+void mesh_add_stats(MeshStats* stats, const Mesh* mesh);
+void mesh_print_stats(const char* name, const MeshStats* stats);
+void mesh_upload(Mesh* mesh);
+void mesh_draw(const Mesh* mesh);
+int mesh_draw_blocks(const Mesh* mesh, const bool* visible);
+void mesh_free(Mesh* mesh);
+
+#endif
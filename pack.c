@@ -0,0 +1,434 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pack.h"
+#include "bmp.h"
+
+#define PACK_HEADER_SIZE 16
+#define PACK_RECORD_SIZE (PACK_NAME_MAX + 4 * 4 + 3 * 8 + PACK_MAX_MIPS * 8)
+
+static const char pack_magic[4] = {'M', 'Z', 'P', 'K'};
+
+typedef struct {
+    char** paths;
+    int count, capacity;
+} PathList;
+
+static void put_u32(unsigned char* p, uint32_t value) {
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    p[2] = (value >> 16) & 0xFF;
+    p[3] = value >> 24;
+}
+
+static void put_u64(unsigned char* p, uint64_t value) {
+    put_u32(p, (uint32_t)value);
+    put_u32(p + 4, (uint32_t)(value >> 32));
+}
+
+static uint32_t get_u32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_u64(const unsigned char* p) {
+    return get_u32(p) | ((uint64_t)get_u32(p + 4) << 32);
+}
+
+uint64_t pack_checksum(const unsigned char* data, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static void collect_path(const char* path, void* user) {
+    PathList* list = user;
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 16;
+        char** grown = realloc(list->paths, capacity * sizeof(char*));
+        if (!grown) return;
+        list->paths = grown;
+        list->capacity = capacity;
+    }
+    char* copy = malloc(strlen(path) + 1);
+    if (!copy) return;
+    strcpy(copy, path);
+    list->paths[list->count++] = copy;
+}
+
+static int compare_paths(const void* a, const void* b) {
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+static void free_paths(PathList* list) {
+    for (int i = 0; i < list->count; i++) free(list->paths[i]);
+    free(list->paths);
+}
+
+static unsigned char* decode_level0(const BmpImage* image, int channels) {
+    unsigned char* out = malloc((size_t)image->width * image->height * channels);
+    if (!out) return NULL;
+
+    int source_channels = image->bits / 8;
+    unsigned char* dst = out;
+    for (int y = 0; y < image->height; y++) {
+        const unsigned char* src = bmp_row(image, y);
+        for (int x = 0; x < image->width; x++, src += source_channels, dst += channels) {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+            if (channels == 4) dst[3] = src[3];
+        }
+    }
+    return out;
+}
+
+// 2x2 box filter; odd edges reuse the last row or column.
+static unsigned char* downsample(const unsigned char* src, int w, int h, int channels, int* out_w, int* out_h) {
+    int nw = w > 1 ? w / 2 : 1;
+    int nh = h > 1 ? h / 2 : 1;
+    unsigned char* dst = malloc((size_t)nw * nh * channels);
+    if (!dst) return NULL;
+
+    for (int y = 0; y < nh; y++) {
+        int y0 = y * 2 < h ? y * 2 : h - 1;
+        int y1 = y * 2 + 1 < h ? y * 2 + 1 : h - 1;
+        for (int x = 0; x < nw; x++) {
+            int x0 = x * 2 < w ? x * 2 : w - 1;
+            int x1 = x * 2 + 1 < w ? x * 2 + 1 : w - 1;
+            for (int c = 0; c < channels; c++) {
+                int sum = src[((size_t)y0 * w + x0) * channels + c] + src[((size_t)y0 * w + x1) * channels + c] +
+                          src[((size_t)y1 * w + x0) * channels + c] + src[((size_t)y1 * w + x1) * channels + c];
+                dst[((size_t)y * nw + x) * channels + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+    *out_w = nw;
+    *out_h = nh;
+    return dst;
+}
+
+static bool write_level(FILE* out, const unsigned char* pixels, int w, int h, PackFormat format, PackMip* mip) {
+    size_t count = (size_t)w * h;
+    long offset = ftell(out);
+    size_t size;
+    bool ok;
+
+    if (format == PACK_FORMAT_RGB565) {
+        size = count * 2;
+        unsigned char* packed = malloc(size);
+        if (!packed) return false;
+        for (size_t i = 0; i < count; i++) {
+            const unsigned char* p = pixels + i * 3;
+            uint16_t value = (uint16_t)(((p[0] >> 3) << 11) | ((p[1] >> 2) << 5) | (p[2] >> 3));
+            packed[i * 2] = value & 0xFF;
+            packed[i * 2 + 1] = value >> 8;
+        }
+        ok = fwrite(packed, 1, size, out) == size;
+        free(packed);
+    } else {
+        size = count * (format == PACK_FORMAT_RGBA8 ? 4 : 3);
+        ok = fwrite(pixels, 1, size, out) == size;
+    }
+
+    // Keeps every level 4-byte aligned inside the mapping.
+    static const unsigned char zeros[3] = {0, 0, 0};
+    size_t padding = (4 - size % 4) % 4;
+    ok = ok && fwrite(zeros, 1, padding, out) == padding;
+
+    mip->width = w;
+    mip->height = h;
+    mip->offset = (uint32_t)offset;
+    mip->size = (uint32_t)size;
+    return ok;
+}
+
+static bool pack_texture(FILE* out, const char* path, bool compact, PackEntry* entry) {
+    MappedFile file;
+    if (!platform_map_file(path, &file)) {
+        fprintf(stderr, "Nao foi possivel abrir %s\n", path);
+        return false;
+    }
+
+    BmpImage image;
+    const char* error = bmp_parse(&file, &image);
+    if (error) {
+        fprintf(stderr, "Ignorando %s: %s\n", path, error);
+        platform_unmap_file(&file);
+        return false;
+    }
+
+    memset(entry, 0, sizeof(*entry));
+    snprintf(entry->name, sizeof(entry->name), "%s", path);
+    entry->source_checksum = pack_checksum(file.data, file.size);
+    platform_file_info(path, &entry->source_size, &entry->source_modified);
+    entry->format = image.has_alpha ? PACK_FORMAT_RGBA8 : (compact ? PACK_FORMAT_RGB565 : PACK_FORMAT_RGB8);
+    entry->width = image.width;
+    entry->height = image.height;
+
+    int channels = image.has_alpha ? 4 : 3;
+    unsigned char* level = decode_level0(&image, channels);
+    platform_unmap_file(&file);
+    if (!level) return false;
+
+    int w = image.width, h = image.height;
+    bool ok = true;
+    while (ok && entry->mip_count < PACK_MAX_MIPS) {
+        ok = write_level(out, level, w, h, entry->format, &entry->mips[entry->mip_count++]);
+        if (w == 1 && h == 1) break;
+        unsigned char* next = downsample(level, w, h, channels, &w, &h);
+        free(level);
+        level = next;
+        if (!level) ok = false;
+    }
+    free(level);
+    return ok;
+}
+
+static void encode_record(unsigned char* p, const PackEntry* entry) {
+    memset(p, 0, PACK_RECORD_SIZE);
+    memcpy(p, entry->name, strlen(entry->name));
+    p += PACK_NAME_MAX;
+    put_u32(p, entry->format);
+    put_u32(p + 4, entry->width);
+    put_u32(p + 8, entry->height);
+    put_u32(p + 12, entry->mip_count);
+    put_u64(p + 16, entry->source_size);
+    put_u64(p + 24, (uint64_t)entry->source_modified);
+    put_u64(p + 32, entry->source_checksum);
+    p += 40;
+    for (int m = 0; m < entry->mip_count; m++) {
+        put_u32(p + m * 8, entry->mips[m].offset);
+        put_u32(p + m * 8 + 4, entry->mips[m].size);
+    }
+}
+
+bool pack_build(const char* directory, const char* archive_path, bool compact, PackStats* stats) {
+    PathList list = {0};
+    platform_list_files(directory, ".bmp", collect_path, &list);
+    qsort(list.paths, list.count, sizeof(char*), compare_paths);
+    if (stats) memset(stats, 0, sizeof(*stats));
+
+    char temp_path[1024];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", archive_path);
+    FILE* out = fopen(temp_path, "wb");
+    PackEntry* entries = calloc(list.count ? list.count : 1, sizeof(PackEntry));
+    if (!out || !entries) {
+        fprintf(stderr, "Nao foi possivel criar o arquivo de texturas: %s\n", archive_path);
+        if (out) fclose(out);
+        free(entries);
+        free_paths(&list);
+        return false;
+    }
+
+    unsigned char header[PACK_HEADER_SIZE] = {0};
+    bool ok = fwrite(header, 1, sizeof(header), out) == sizeof(header);
+    int count = 0;
+    for (int i = 0; ok && i < list.count; i++) {
+        if (strlen(list.paths[i]) >= PACK_NAME_MAX) {
+            fprintf(stderr, "Ignorando %s: caminho longo demais\n", list.paths[i]);
+            continue;
+        }
+        if (!pack_texture(out, list.paths[i], compact, &entries[count])) continue;
+        if (stats) {
+            stats->textures++;
+            stats->source_bytes += entries[count].source_size;
+        }
+        count++;
+    }
+
+    long index_offset = ftell(out);
+    unsigned char record[PACK_RECORD_SIZE];
+    for (int i = 0; ok && i < count; i++) {
+        encode_record(record, &entries[i]);
+        ok = fwrite(record, 1, sizeof(record), out) == sizeof(record);
+    }
+
+    memcpy(header, pack_magic, 4);
+    put_u32(header + 4, PACK_VERSION);
+    put_u32(header + 8, (uint32_t)count);
+    put_u32(header + 12, (uint32_t)index_offset);
+    ok = ok && fseek(out, 0, SEEK_SET) == 0 && fwrite(header, 1, sizeof(header), out) == sizeof(header);
+    if (stats) {
+        fseek(out, 0, SEEK_END);
+        stats->packed_bytes = (uint64_t)ftell(out);
+    }
+    ok = fclose(out) == 0 && ok;
+
+    free(entries);
+    free_paths(&list);
+    if (ok) {
+        remove(archive_path);
+        ok = rename(temp_path, archive_path) == 0;
+    }
+    if (!ok) {
+        remove(temp_path);
+        fprintf(stderr, "Falha ao gravar o arquivo de texturas: %s\n", archive_path);
+    }
+    return ok;
+}
+
+static bool decode_record(const unsigned char* p, size_t file_size, PackEntry* entry) {
+    memset(entry, 0, sizeof(*entry));
+    memcpy(entry->name, p, PACK_NAME_MAX - 1);
+    p += PACK_NAME_MAX;
+    entry->format = (PackFormat)get_u32(p);
+    entry->width = (int)get_u32(p + 4);
+    entry->height = (int)get_u32(p + 8);
+    entry->mip_count = (int)get_u32(p + 12);
+    entry->source_size = get_u64(p + 16);
+    entry->source_modified = (int64_t)get_u64(p + 24);
+    entry->source_checksum = get_u64(p + 32);
+    p += 40;
+
+    if (entry->format < PACK_FORMAT_RGB8 || entry->format > PACK_FORMAT_RGB565) return false;
+    if (entry->width <= 0 || entry->height <= 0 || entry->mip_count < 1 || entry->mip_count > PACK_MAX_MIPS) return false;
+
+    size_t texel_bytes = entry->format == PACK_FORMAT_RGBA8 ? 4 : (entry->format == PACK_FORMAT_RGB8 ? 3 : 2);
+    int w = entry->width, h = entry->height;
+    for (int m = 0; m < entry->mip_count; m++) {
+        PackMip* mip = &entry->mips[m];
+        mip->width = w;
+        mip->height = h;
+        mip->offset = get_u32(p + m * 8);
+        mip->size = get_u32(p + m * 8 + 4);
+        if (mip->size != (size_t)w * h * texel_bytes || mip->offset > file_size || mip->size > file_size - mip->offset) {
+            return false;
+        }
+        if (w > 1) w /= 2;
+        if (h > 1) h /= 2;
+    }
+    return true;
+}
+
+bool pack_open(PackArchive* archive, const char* path) {
+    memset(archive, 0, sizeof(*archive));
+    if (!platform_map_file(path, &archive->file)) return false;
+
+    const unsigned char* data = archive->file.data;
+    size_t size = archive->file.size;
+    bool ok = size >= PACK_HEADER_SIZE && memcmp(data, pack_magic, 4) == 0 && get_u32(data + 4) == PACK_VERSION;
+    uint32_t count = ok ? get_u32(data + 8) : 0;
+    uint32_t index_offset = ok ? get_u32(data + 12) : 0;
+    ok = ok && index_offset <= size && count <= (size - index_offset) / PACK_RECORD_SIZE;
+
+    if (ok && count > 0) {
+        archive->entries = calloc(count, sizeof(PackEntry));
+        ok = archive->entries != NULL;
+        for (uint32_t i = 0; ok && i < count; i++) {
+            ok = decode_record(data + index_offset + i * PACK_RECORD_SIZE, size, &archive->entries[i]);
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "Arquivo de texturas invalido: %s\n", path);
+        pack_close(archive);
+        return false;
+    }
+    archive->entry_count = (int)count;
+    return true;
+}
+
+typedef struct {
+    const PackArchive* archive;
+    int seen;
+    bool current;
+    bool stale_timestamps;
+} CurrentCheck;
+
+// Whether pack_build would store this file rather than skip it.
+static bool is_packable(const char* path) {
+    if (strlen(path) >= PACK_NAME_MAX) return false;
+    MappedFile file;
+    if (!platform_map_file(path, &file)) return false;
+    BmpImage image;
+    bool ok = bmp_parse(&file, &image) == NULL;
+    platform_unmap_file(&file);
+    return ok;
+}
+
+static void check_source(const char* path, void* user) {
+    CurrentCheck* check = user;
+    if (!check->current) return;
+
+    const PackEntry* entry = pack_find(check->archive, path);
+    if (!entry) {
+        // Files the build skipped are not in the archive, and that is still current.
+        if (is_packable(path)) check->current = false;
+        return;
+    }
+    check->seen++;
+
+    uint64_t size;
+    int64_t modified;
+    if (!platform_file_info(path, &size, &modified) || size != entry->source_size) {
+        check->current = false;
+        return;
+    }
+    if (modified == entry->source_modified) return;
+
+    // Timestamps move on checkouts and copies; only the content decides.
+    MappedFile file;
+    if (!platform_map_file(path, &file)) {
+        check->current = false;
+        return;
+    }
+    check->current = pack_checksum(file.data, file.size) == entry->source_checksum;
+    check->stale_timestamps = true;
+    platform_unmap_file(&file);
+}
+
+bool pack_is_current(const PackArchive* archive, const char* directory, bool* stale_timestamps) {
+    CurrentCheck check = {archive, 0, true, false};
+    platform_list_files(directory, ".bmp", check_source, &check);
+    *stale_timestamps = check.stale_timestamps;
+    return check.current && check.seen == archive->entry_count;
+}
+
+bool pack_refresh_timestamps(const char* path) {
+    FILE* file = fopen(path, "r+b");
+    if (!file) return false;
+
+    unsigned char header[PACK_HEADER_SIZE];
+    bool ok = fread(header, 1, sizeof(header), file) == sizeof(header) && memcmp(header, pack_magic, 4) == 0 &&
+              get_u32(header + 4) == PACK_VERSION;
+    uint32_t count = ok ? get_u32(header + 8) : 0;
+    long index_offset = ok ? (long)get_u32(header + 12) : 0;
+    unsigned char record[PACK_RECORD_SIZE];
+    for (uint32_t i = 0; ok && i < count; i++) {
+        long offset = index_offset + (long)i * PACK_RECORD_SIZE;
+        ok = fseek(file, offset, SEEK_SET) == 0 && fread(record, 1, sizeof(record), file) == sizeof(record);
+        if (!ok) break;
+
+        char name[PACK_NAME_MAX];
+        memcpy(name, record, PACK_NAME_MAX - 1);
+        name[PACK_NAME_MAX - 1] = '\0';
+        uint64_t size;
+        int64_t modified;
+        // Only the timestamp is refreshed; the caller has already matched the contents.
+        if (!platform_file_info(name, &size, &modified) || size != get_u64(record + PACK_NAME_MAX + 16)) continue;
+        unsigned char stamp[8];
+        put_u64(stamp, (uint64_t)modified);
+        ok = fseek(file, offset + PACK_NAME_MAX + 24, SEEK_SET) == 0 &&
+             fwrite(stamp, 1, sizeof(stamp), file) == sizeof(stamp);
+    }
+    return fclose(file) == 0 && ok;
+}
+
+const PackEntry* pack_find(const PackArchive* archive, const char* name) {
+    for (int i = 0; i < archive->entry_count; i++) {
+        if (strcmp(archive->entries[i].name, name) == 0) return &archive->entries[i];
+    }
+    return NULL;
+}
+
+const unsigned char* pack_mip_data(const PackArchive* archive, const PackMip* mip) {
+    return archive->file.data + mip->offset;
+}
+
+void pack_close(PackArchive* archive) {
+    free(archive->entries);
+    platform_unmap_file(&archive->file);
+    archive->entries = NULL;
+    archive->entry_count = 0;
+}
@@ -0,0 +1,63 @@
+#ifndef PACK_H
+#define PACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "platform.h"
+
+#define PACK_VERSION 1
+#define PACK_NAME_MAX 64
+#define PACK_MAX_MIPS 16
+#define PACK_TEXTURE_ARCHIVE "textures/textures.pak"
+
+typedef enum {
+    PACK_FORMAT_RGB8 = 1,
+    PACK_FORMAT_RGBA8,
+    PACK_FORMAT_RGB565
+} PackFormat;
+
+typedef struct {
+    int width, height;
+    uint32_t offset, size;
+} PackMip;
+
+// One texture, stored RGB-ordered and bottom-up with its full mip chain,
+// plus the size, timestamp and checksum of the BMP it came from.
+typedef struct {
+    char name[PACK_NAME_MAX];
+    uint64_t source_size;
+    int64_t source_modified;
+    uint64_t source_checksum;
+    PackFormat format;
+    int width, height;
+    int mip_count;
+    PackMip mips[PACK_MAX_MIPS];
+} PackEntry;
+
+typedef struct {
+    MappedFile file;
+    PackEntry* entries;
+    int entry_count;
+} PackArchive;
+
+typedef struct {
+    int textures;
+    uint64_t source_bytes;
+    uint64_t packed_bytes;
+} PackStats;
+
+// Packs every BMP in directory; compact stores opaque textures as RGB565.
+bool pack_build(const char* directory, const char* archive_path, bool compact, PackStats* stats);
+bool pack_open(PackArchive* archive, const char* path);
+// True when the archive holds exactly the BMPs in directory that pack_build
+// accepts and none of them changed. stale_timestamps is set when some only
+// have a new timestamp, so pack_refresh_timestamps can skip rehashing them next time.
+bool pack_is_current(const PackArchive* archive, const char* directory, bool* stale_timestamps);
+// Rewrites the stored timestamps from the sources; the archive must not be open.
+bool pack_refresh_timestamps(const char* path);
+const PackEntry* pack_find(const PackArchive* archive, const char* name);
+const unsigned char* pack_mip_data(const PackArchive* archive, const PackMip* mip);
+void pack_close(PackArchive* archive);
+uint64_t pack_checksum(const unsigned char* data, size_t size);
+
+#endif
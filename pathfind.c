@@ -0,0 +1,566 @@
+#include <stdlib.h>
+#include <string.h>
+#include "pathfind.h"
+
+// Corridors wider than this get an entrance at each end instead of one in the middle.
+#define ENTRANCE_SPLIT_LENGTH 6
+
+static const int dir_dx[5] = {0, 1, -1, 0, 0};
+static const int dir_dz[5] = {0, 0, 0, 1, -1};
+static const unsigned char dir_opposite[5] = {PATH_DIR_NONE, PATH_DIR_WEST, PATH_DIR_EAST, PATH_DIR_NORTH, PATH_DIR_SOUTH};
+
+bool path_field_init(PathField* field, int width, int height) {
+    size_t cells = (size_t)width * height;
+    memset(field, 0, sizeof(*field));
+    field->width = width;
+    field->height = height;
+    field->distance = malloc(cells * sizeof(int32_t));
+    field->owner = malloc(cells * sizeof(int32_t));
+    field->flow = malloc(cells);
+    field->queue = malloc(cells * sizeof(int32_t));
+    if (!field->distance || !field->owner || !field->flow || !field->queue) {
+        path_field_free(field);
+        return false;
+    }
+    for (size_t i = 0; i < cells; i++) {
+        field->distance[i] = PATH_UNREACHABLE;
+        field->owner[i] = -1;
+    }
+    memset(field->flow, PATH_DIR_NONE, cells);
+    return true;
+}
+
+static int expand(PathField* field, const CollisionMap* map, int head, int tail, int max_distance) {
+    int width = field->width;
+    while (head < tail) {
+        int32_t cell = field->queue[head++];
+        if (field->distance[cell] >= max_distance) continue;
+        int x = cell % width, z = cell / width;
+        int32_t next_distance = field->distance[cell] + 1;
+        for (int dir = PATH_DIR_EAST; dir <= PATH_DIR_NORTH; dir++) {
+            int nx = x + dir_dx[dir], nz = z + dir_dz[dir];
+            if (collision_map_solid(map, nx, nz)) continue;
+            int32_t next = nz * width + nx;
+            if (field->distance[next] <= next_distance) continue;
+            field->distance[next] = next_distance;
+            field->owner[next] = field->owner[cell];
+            field->flow[next] = dir_opposite[dir];
+            field->queue[tail++] = next;
+        }
+    }
+    return tail;
+}
+
+void path_field_build(PathField* field, const CollisionMap* map, const PathCell* sources, int count) {
+    path_field_build_near(field, map, sources, count, PATH_UNREACHABLE);
+}
+
+void path_field_build_near(PathField* field, const CollisionMap* map, const PathCell* sources, int count,
+                           int max_distance) {
+    if (field->reached >= 0) {
+        for (int i = 0; i < field->reached; i++) {
+            int32_t cell = field->queue[i];
+            field->distance[cell] = PATH_UNREACHABLE;
+            field->owner[cell] = -1;
+            field->flow[cell] = PATH_DIR_NONE;
+        }
+    } else {
+        size_t cells = (size_t)field->width * field->height;
+        for (size_t i = 0; i < cells; i++) {
+            field->distance[i] = PATH_UNREACHABLE;
+            field->owner[i] = -1;
+        }
+        memset(field->flow, PATH_DIR_NONE, cells);
+    }
+
+    int tail = 0;
+    for (int i = 0; i < count; i++) {
+        int x = sources[i].x, z = sources[i].z;
+        if ((unsigned)x >= (unsigned)field->width || (unsigned)z >= (unsigned)field->height) continue;
+        int32_t cell = z * field->width + x;
+        if (field->distance[cell] == 0) continue;
+        field->distance[cell] = 0;
+        field->owner[cell] = cell;
+        field->queue[tail++] = cell;
+    }
+    field->reached = expand(field, map, 0, tail, max_distance);
+}
+
+static int compare_keys(const void* a, const void* b) {
+    int64_t sa = *(const int64_t*)a, sb = *(const int64_t*)b;
+    return (sa > sb) - (sa < sb);
+}
+
+// Only the cells that led to the removed source can get farther, so just
+// that region is cleared and refilled from its border, in distance order.
+int path_field_remove_source(PathField* field, const CollisionMap* map, int x, int z) {
+    if ((unsigned)x >= (unsigned)field->width || (unsigned)z >= (unsigned)field->height) return 0;
+    int width = field->width, height = field->height;
+    int32_t source = z * width + x;
+    if (field->owner[source] != source) return 0;
+
+    field->reached = -1;
+    int count = 0;
+    field->queue[count++] = source;
+    field->owner[source] = -2;
+    for (int i = 0; i < count; i++) {
+        int32_t cell = field->queue[i];
+        int cx = cell % width, cz = cell / width;
+        for (int dir = PATH_DIR_EAST; dir <= PATH_DIR_NORTH; dir++) {
+            int nx = cx + dir_dx[dir], nz = cz + dir_dz[dir];
+            if ((unsigned)nx >= (unsigned)width || (unsigned)nz >= (unsigned)height) continue;
+            int32_t next = nz * width + nx;
+            if (field->owner[next] != source) continue;
+            field->owner[next] = -2;
+            field->queue[count++] = next;
+        }
+    }
+
+    int64_t* seeds = malloc((size_t)count * sizeof(int64_t));
+    if (!seeds) {
+        for (int i = 0; i < count; i++) field->owner[field->queue[i]] = source;
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        int32_t cell = field->queue[i];
+        field->distance[cell] = PATH_UNREACHABLE;
+        field->owner[cell] = -1;
+        field->flow[cell] = PATH_DIR_NONE;
+    }
+
+    int seed_count = 0;
+    for (int i = 0; i < count; i++) {
+        int32_t cell = field->queue[i];
+        int cx = cell % width, cz = cell / width;
+        if (collision_map_solid(map, cx, cz)) continue;
+        int32_t best = PATH_UNREACHABLE;
+        for (int dir = PATH_DIR_EAST; dir <= PATH_DIR_NORTH; dir++) {
+            int nx = cx + dir_dx[dir], nz = cz + dir_dz[dir];
+            if ((unsigned)nx >= (unsigned)width || (unsigned)nz >= (unsigned)height) continue;
+            int32_t next = nz * width + nx;
+            if (field->owner[next] < 0 || field->distance[next] + 1 >= best) continue;
+            best = field->distance[next] + 1;
+            field->owner[cell] = field->owner[next];
+            field->flow[cell] = (unsigned char)dir;
+        }
+        if (best == PATH_UNREACHABLE) continue;
+        field->distance[cell] = best;
+        seeds[seed_count++] = ((int64_t)best << 32) | cell;
+    }
+    qsort(seeds, seed_count, sizeof(int64_t), compare_keys);
+
+    // Sorted seeds merged with a plain BFS queue pop cells in distance order.
+    int head = 0, tail = 0, next_seed = 0;
+    while (next_seed < seed_count || head < tail) {
+        int32_t cell;
+        if (head < tail && (next_seed == seed_count || field->distance[field->queue[head]] <= (int32_t)(seeds[next_seed] >> 32))) {
+            cell = field->queue[head++];
+        } else {
+            cell = (int32_t)(seeds[next_seed] & 0xffffffff);
+            if (field->distance[cell] != (int32_t)(seeds[next_seed++] >> 32)) continue;
+        }
+
+        int cx = cell % width, cz = cell / width;
+        int32_t next_distance = field->distance[cell] + 1;
+        for (int dir = PATH_DIR_EAST; dir <= PATH_DIR_NORTH; dir++) {
+            int nx = cx + dir_dx[dir], nz = cz + dir_dz[dir];
+            if (collision_map_solid(map, nx, nz)) continue;
+            int32_t next = nz * width + nx;
+            if (field->distance[next] <= next_distance) continue;
+            field->distance[next] = next_distance;
+            field->owner[next] = field->owner[cell];
+            field->flow[next] = dir_opposite[dir];
+            field->queue[tail++] = next;
+        }
+    }
+
+    free(seeds);
+    return count;
+}
+
+bool path_field_step(const PathField* field, int x, int z, PathCell* next) {
+    if ((unsigned)x >= (unsigned)field->width || (unsigned)z >= (unsigned)field->height) return false;
+    int dir = field->flow[(size_t)z * field->width + x];
+    if (dir == PATH_DIR_NONE) return false;
+    next->x = x + dir_dx[dir];
+    next->z = z + dir_dz[dir];
+    return true;
+}
+
+void path_field_free(PathField* field) {
+    free(field->distance);
+    free(field->owner);
+    free(field->flow);
+    free(field->queue);
+    memset(field, 0, sizeof(*field));
+}
+
+typedef struct {
+    int64_t* items;
+    int count, capacity;
+} KeyList;
+
+static bool key_list_push(KeyList* list, int64_t key) {
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 256;
+        int64_t* items = realloc(list->items, (size_t)capacity * sizeof(int64_t));
+        if (!items) return false;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = key;
+    return true;
+}
+
+static int cluster_of(const PathHierarchy* h, int x, int z) {
+    return (z / h->cluster_size) * h->clusters_x + x / h->cluster_size;
+}
+
+// Cells are keyed by cluster first so sorting the keys groups nodes per cluster.
+static int64_t node_key(const PathHierarchy* h, const CollisionMap* map, int x, int z) {
+    return ((int64_t)cluster_of(h, x, z) << 32) | ((int64_t)z * map->width + x);
+}
+
+static int find_node(const PathHierarchy* h, const int64_t* keys, int64_t key) {
+    int lo = 0, hi = h->node_count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (keys[mid] == key) return mid;
+        if (keys[mid] < key) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
+
+static bool add_entrance(KeyList* entrances, const PathHierarchy* h, const CollisionMap* map,
+                         int ax, int az, int bx, int bz) {
+    return key_list_push(entrances, node_key(h, map, ax, az)) && key_list_push(entrances, node_key(h, map, bx, bz));
+}
+
+// Walks the border between two clusters and records one entrance per run of
+// open cell pairs; (dx, dz) steps along the border.
+static bool scan_border(KeyList* entrances, const PathHierarchy* h, const CollisionMap* map,
+                        int x, int z, int dx, int dz, int length) {
+    int ox = dz, oz = dx;
+    int run = 0;
+    for (int i = 0; i <= length; i++) {
+        int ax = x + dx * i, az = z + dz * i;
+        bool open = i < length && !collision_map_solid(map, ax, az) && !collision_map_solid(map, ax + ox, az + oz);
+        if (open) {
+            run++;
+            continue;
+        }
+        if (run == 0) continue;
+
+        int first = i - run, last = i - 1;
+        if (run <= ENTRANCE_SPLIT_LENGTH) {
+            int mid = (first + last) / 2;
+            if (!add_entrance(entrances, h, map, x + dx * mid, z + dz * mid, x + dx * mid + ox, z + dz * mid + oz)) return false;
+        } else {
+            if (!add_entrance(entrances, h, map, x + dx * first, z + dz * first, x + dx * first + ox, z + dz * first + oz)) return false;
+            if (!add_entrance(entrances, h, map, x + dx * last, z + dz * last, x + dx * last + ox, z + dz * last + oz)) return false;
+        }
+        run = 0;
+    }
+    return true;
+}
+
+// Distances from (x, z) to every cell of its cluster, without leaving it; -1 where unreachable.
+static void cluster_bfs(PathHierarchy* h, const CollisionMap* map, int x, int z) {
+    int size = h->cluster_size;
+    int x0 = x / size * size, z0 = z / size * size;
+    int x1 = x0 + size < map->width ? x0 + size : map->width;
+    int z1 = z0 + size < map->height ? z0 + size : map->height;
+    for (int i = 0; i < size * size; i++) h->local_distance[i] = -1;
+
+    int head = 0, tail = 0;
+    h->local_distance[(z - z0) * size + (x - x0)] = 0;
+    h->local_queue[tail++] = (z - z0) * size + (x - x0);
+    while (head < tail) {
+        int local = h->local_queue[head++];
+        int lx = local % size, lz = local / size;
+        for (int dir = PATH_DIR_EAST; dir <= PATH_DIR_NORTH; dir++) {
+            int nx = x0 + lx + dir_dx[dir], nz = z0 + lz + dir_dz[dir];
+            if (nx < x0 || nx >= x1 || nz < z0 || nz >= z1 || collision_map_solid(map, nx, nz)) continue;
+            int next = (nz - z0) * size + (nx - x0);
+            if (h->local_distance[next] >= 0) continue;
+            h->local_distance[next] = h->local_distance[local] + 1;
+            h->local_queue[tail++] = next;
+        }
+    }
+}
+
+static int local_distance_at(const PathHierarchy* h, int cx, int cz, int x, int z) {
+    int size = h->cluster_size;
+    return h->local_distance[(z - cz / size * size) * size + (x - cx / size * size)];
+}
+
+bool path_hierarchy_build(PathHierarchy* h, const CollisionMap* map, int cluster_size) {
+    memset(h, 0, sizeof(*h));
+    h->cluster_size = cluster_size;
+    h->clusters_x = (map->width + cluster_size - 1) / cluster_size;
+    h->clusters_z = (map->height + cluster_size - 1) / cluster_size;
+    int cluster_count = h->clusters_x * h->clusters_z;
+
+    KeyList entrances = {0};
+    bool ok = true;
+    for (int cz = 0; cz < h->clusters_z && ok; cz++) {
+        for (int cx = 0; cx < h->clusters_x && ok; cx++) {
+            int x0 = cx * cluster_size, z0 = cz * cluster_size;
+            int w = x0 + cluster_size < map->width ? cluster_size : map->width - x0;
+            int d = z0 + cluster_size < map->height ? cluster_size : map->height - z0;
+            if (cx + 1 < h->clusters_x) ok = scan_border(&entrances, h, map, x0 + cluster_size - 1, z0, 0, 1, d);
+            if (ok && cz + 1 < h->clusters_z) ok = scan_border(&entrances, h, map, x0, z0 + cluster_size - 1, 1, 0, w);
+        }
+    }
+
+    int64_t* keys = ok ? malloc(((size_t)entrances.count + 1) * sizeof(int64_t)) : NULL;
+    if (!keys) {
+        free(entrances.items);
+        return false;
+    }
+    memcpy(keys, entrances.items, (size_t)entrances.count * sizeof(int64_t));
+    qsort(keys, entrances.count, sizeof(int64_t), compare_keys);
+    for (int i = 0; i < entrances.count; i++) {
+        if (h->node_count == 0 || keys[h->node_count - 1] != keys[i]) keys[h->node_count++] = keys[i];
+    }
+
+    int nodes = h->node_count;
+    size_t local_cells = (size_t)cluster_size * cluster_size;
+    h->nodes = malloc(((size_t)nodes + 1) * sizeof(PathCell));
+    h->node_cluster = malloc(((size_t)nodes + 1) * sizeof(int));
+    h->cluster_start = calloc((size_t)cluster_count + 1, sizeof(int));
+    h->edge_start = calloc((size_t)nodes + 1, sizeof(int));
+    h->local_distance = malloc(local_cells * sizeof(int));
+    h->local_queue = malloc(local_cells * sizeof(int));
+    h->cost = malloc(((size_t)nodes + 1) * sizeof(int));
+    h->parent = malloc(((size_t)nodes + 1) * sizeof(int));
+    h->visited = calloc((size_t)nodes + 1, sizeof(unsigned));
+    h->goal_cost = malloc(((size_t)nodes + 1) * sizeof(int));
+    KeyList edges = {0};
+    if (!h->nodes || !h->node_cluster || !h->cluster_start || !h->edge_start || !h->local_distance ||
+        !h->local_queue || !h->cost || !h->parent || !h->visited || !h->goal_cost) {
+        ok = false;
+    }
+
+    for (int i = 0; i < nodes && ok; i++) {
+        int cell = (int)(keys[i] & 0xffffffff);
+        h->nodes[i].x = cell % map->width;
+        h->nodes[i].z = cell / map->width;
+        h->node_cluster[i] = (int)(keys[i] >> 32);
+        h->cluster_start[h->node_cluster[i] + 1]++;
+        h->goal_cost[i] = -1;
+    }
+    for (int c = 0; c < cluster_count && ok; c++) h->cluster_start[c + 1] += h->cluster_start[c];
+
+    // Edges are packed as from << 40 | to << 16 | cost, so sorting them groups them by node.
+    for (int i = 0; i + 1 < entrances.count && ok; i += 2) {
+        int a = find_node(h, keys, entrances.items[i]);
+        int b = find_node(h, keys, entrances.items[i + 1]);
+        ok = key_list_push(&edges, ((int64_t)a << 40) | ((int64_t)b << 16) | 1) &&
+             key_list_push(&edges, ((int64_t)b << 40) | ((int64_t)a << 16) | 1);
+    }
+    for (int a = 0; a < nodes && ok; a++) {
+        int cluster = h->node_cluster[a];
+        cluster_bfs(h, map, h->nodes[a].x, h->nodes[a].z);
+        for (int b = h->cluster_start[cluster]; b < h->cluster_start[cluster + 1] && ok; b++) {
+            if (b == a) continue;
+            int cost = local_distance_at(h, h->nodes[a].x, h->nodes[a].z, h->nodes[b].x, h->nodes[b].z);
+            if (cost > 0) ok = key_list_push(&edges, ((int64_t)a << 40) | ((int64_t)b << 16) | cost);
+        }
+    }
+    free(entrances.items);
+    free(keys);
+
+    h->edge_to = ok ? malloc(((size_t)edges.count + 1) * sizeof(int)) : NULL;
+    h->edge_cost = ok ? malloc(((size_t)edges.count + 1) * sizeof(int)) : NULL;
+    if (!h->edge_to || !h->edge_cost) {
+        free(edges.items);
+        path_hierarchy_free(h);
+        return false;
+    }
+    qsort(edges.items, edges.count, sizeof(int64_t), compare_keys);
+    for (int i = 0; i < edges.count; i++) {
+        int from = (int)(edges.items[i] >> 40);
+        h->edge_to[i] = (int)((edges.items[i] >> 16) & 0xffffff);
+        h->edge_cost[i] = (int)(edges.items[i] & 0xffff);
+        h->edge_start[from + 1]++;
+    }
+    for (int i = 0; i < nodes; i++) h->edge_start[i + 1] += h->edge_start[i];
+    free(edges.items);
+    return true;
+}
+
+static bool heap_push(PathHierarchy* h, int* size, int64_t key) {
+    if (*size == h->heap_capacity) {
+        int capacity = h->heap_capacity ? h->heap_capacity * 2 : 256;
+        int64_t* heap = realloc(h->heap, (size_t)capacity * sizeof(int64_t));
+        if (!heap) return false;
+        h->heap = heap;
+        h->heap_capacity = capacity;
+    }
+    int i = (*size)++;
+    while (i > 0 && h->heap[(i - 1) / 2] > key) {
+        h->heap[i] = h->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    h->heap[i] = key;
+    return true;
+}
+
+static int64_t heap_pop(PathHierarchy* h, int* size) {
+    int64_t top = h->heap[0];
+    int64_t last = h->heap[--(*size)];
+    int i = 0;
+    for (;;) {
+        int child = i * 2 + 1;
+        if (child >= *size) break;
+        if (child + 1 < *size && h->heap[child + 1] < h->heap[child]) child++;
+        if (h->heap[child] >= last) break;
+        h->heap[i] = h->heap[child];
+        i = child;
+    }
+    if (*size > 0) h->heap[i] = last;
+    return top;
+}
+
+static int estimate(const PathCell* a, PathCell goal) {
+    return abs(a->x - goal.x) + abs(a->z - goal.z);
+}
+
+static bool open_node(PathHierarchy* h, int* heap_size, int node, int cost, int parent, PathCell goal) {
+    if (h->visited[node] == h->query && h->cost[node] <= cost) return true;
+    h->visited[node] = h->query;
+    h->cost[node] = cost;
+    h->parent[node] = parent;
+    return heap_push(h, heap_size, ((int64_t)(cost + estimate(&h->nodes[node], goal)) << 32) | node);
+}
+
+static void emit_cell(PathCell* path, int max_cells, int* written, int x, int z) {
+    if (*written < max_cells) {
+        path[*written].x = x;
+        path[*written].z = z;
+    }
+    (*written)++;
+}
+
+// Appends the in-cluster walk from (x, z) to (tx, tz), leaving out (x, z) itself.
+static void emit_segment(PathHierarchy* h, const CollisionMap* map, int x, int z, int tx, int tz,
+                         PathCell* path, int max_cells, int* written) {
+    if (cluster_of(h, x, z) != cluster_of(h, tx, tz)) {
+        emit_cell(path, max_cells, written, tx, tz);
+        return;
+    }
+    cluster_bfs(h, map, tx, tz);
+    int remaining = local_distance_at(h, tx, tz, x, z);
+    int size = h->cluster_size;
+    int x0 = tx / size * size, z0 = tz / size * size;
+    while (remaining > 0) {
+        for (int dir = PATH_DIR_EAST; dir <= PATH_DIR_NORTH; dir++) {
+            int nx = x + dir_dx[dir], nz = z + dir_dz[dir];
+            if (nx < x0 || nx >= x0 + size || nz < z0 || nz >= z0 + size) continue;
+            if (local_distance_at(h, tx, tz, nx, nz) == remaining - 1) {
+                x = nx;
+                z = nz;
+                break;
+            }
+        }
+        emit_cell(path, max_cells, written, x, z);
+        remaining--;
+    }
+}
+
+int path_hierarchy_find(PathHierarchy* h, const CollisionMap* map, PathCell start, PathCell goal,
+                        PathCell* path, int max_cells) {
+    if ((unsigned)start.x >= (unsigned)map->width || (unsigned)start.z >= (unsigned)map->height) return -1;
+    if ((unsigned)goal.x >= (unsigned)map->width || (unsigned)goal.z >= (unsigned)map->height) return -1;
+    if (collision_map_solid(map, start.x, start.z) || collision_map_solid(map, goal.x, goal.z)) return -1;
+
+    int written = 0;
+    if (path) emit_cell(path, max_cells, &written, start.x, start.z);
+
+    int start_cluster = cluster_of(h, start.x, start.z);
+    int goal_cluster = cluster_of(h, goal.x, goal.z);
+    cluster_bfs(h, map, goal.x, goal.z);
+    if (start_cluster == goal_cluster) {
+        int length = local_distance_at(h, goal.x, goal.z, start.x, start.z);
+        if (length >= 0) {
+            if (path) emit_segment(h, map, start.x, start.z, goal.x, goal.z, path, max_cells, &written);
+            return length;
+        }
+    }
+
+    for (int n = h->cluster_start[goal_cluster]; n < h->cluster_start[goal_cluster + 1]; n++) {
+        h->goal_cost[n] = local_distance_at(h, goal.x, goal.z, h->nodes[n].x, h->nodes[n].z);
+    }
+
+    if (++h->query == 0) {
+        memset(h->visited, 0, (size_t)h->node_count * sizeof(unsigned));
+        h->query = 1;
+    }
+    int heap_size = 0;
+    bool ok = true;
+    cluster_bfs(h, map, start.x, start.z);
+    for (int n = h->cluster_start[start_cluster]; n < h->cluster_start[start_cluster + 1] && ok; n++) {
+        int cost = local_distance_at(h, start.x, start.z, h->nodes[n].x, h->nodes[n].z);
+        if (cost >= 0) ok = open_node(h, &heap_size, n, cost, -1, goal);
+    }
+
+    int best = PATH_UNREACHABLE, best_node = -1;
+    while (heap_size > 0 && ok) {
+        int64_t key = heap_pop(h, &heap_size);
+        int node = (int)(key & 0xffffffff);
+        int bound = (int)(key >> 32);
+        if (bound >= best) break;
+        int cost = bound - estimate(&h->nodes[node], goal);
+        if (cost != h->cost[node]) continue;
+
+        if (h->goal_cost[node] >= 0 && cost + h->goal_cost[node] < best) {
+            best = cost + h->goal_cost[node];
+            best_node = node;
+        }
+        for (int e = h->edge_start[node]; e < h->edge_start[node + 1] && ok; e++) {
+            ok = open_node(h, &heap_size, h->edge_to[e], cost + h->edge_cost[e], node, goal);
+        }
+    }
+
+    for (int n = h->cluster_start[goal_cluster]; n < h->cluster_start[goal_cluster + 1]; n++) h->goal_cost[n] = -1;
+    if (!ok || best_node < 0) return -1;
+
+    if (path) {
+        int hops = 0;
+        for (int n = best_node; n >= 0; n = h->parent[n]) hops++;
+        int* route = malloc((size_t)hops * sizeof(int));
+        if (!route) return -1;
+        int i = hops;
+        for (int n = best_node; n >= 0; n = h->parent[n]) route[--i] = n;
+
+        int x = start.x, z = start.z;
+        for (i = 0; i < hops; i++) {
+            const PathCell* node = &h->nodes[route[i]];
+            if (node->x != x || node->z != z) emit_segment(h, map, x, z, node->x, node->z, path, max_cells, &written);
+            x = node->x;
+            z = node->z;
+        }
+        emit_segment(h, map, x, z, goal.x, goal.z, path, max_cells, &written);
+        free(route);
+    }
+    return best;
+}
+
+void path_hierarchy_free(PathHierarchy* h) {
+    free(h->nodes);
+    free(h->node_cluster);
+    free(h->cluster_start);
+    free(h->edge_start);
+    free(h->edge_to);
+    free(h->edge_cost);
+    free(h->local_distance);
+    free(h->local_queue);
+    free(h->cost);
+    free(h->parent);
+    free(h->visited);
+    free(h->goal_cost);
+    free(h->heap);
+    memset(h, 0, sizeof(*h));
+}
@@ -0,0 +1,86 @@
+#ifndef PATHFIND_H
+#define PATHFIND_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "collision.h"
+
+#define PATH_UNREACHABLE INT32_MAX
+
+typedef enum {
+    PATH_DIR_NONE,
+    PATH_DIR_EAST,
+    PATH_DIR_WEST,
+    PATH_DIR_SOUTH,
+    PATH_DIR_NORTH
+} PathDirection;
+
+typedef struct {
+    int x, z;
+} PathCell;
+
+// Steps from every cell to its nearest source over the open cells of a
+// collision map. flow points each cell at the neighbour one step closer and
+// owner names (by cell index) the source it leads to, which is what lets a
+// source be removed without rebuilding the whole field.
+typedef struct {
+    int width, height;
+    int32_t* distance;
+    int32_t* owner;
+    unsigned char* flow;
+    int32_t* queue;
+    // The first reached queue entries are the cells the last build touched,
+    // so the next one only has to reset those; -1 after a removal.
+    int reached;
+} PathField;
+
+bool path_field_init(PathField* field, int width, int height);
+void path_field_build(PathField* field, const CollisionMap* map, const PathCell* sources, int count);
+// Like path_field_build, but stops max_distance steps from the sources.
+void path_field_build_near(PathField* field, const CollisionMap* map, const PathCell* sources, int count,
+                           int max_distance);
+// Returns how many cells changed, or -1 if the update could not be done.
+int path_field_remove_source(PathField* field, const CollisionMap* map, int x, int z);
+bool path_field_step(const PathField* field, int x, int z, PathCell* next);
+void path_field_free(PathField* field);
+
+static inline int32_t path_field_distance(const PathField* field, int x, int z) {
+    if ((unsigned)x >= (unsigned)field->width || (unsigned)z >= (unsigned)field->height) return PATH_UNREACHABLE;
+    return field->distance[(size_t)z * field->width + x];
+}
+
+// HPA*: the map is cut into square clusters, cells where a corridor crosses
+// from one cluster to the next become nodes, and nodes of the same cluster
+// are linked by their in-cluster distance. Queries search that small graph
+// and only walk the grid inside the clusters they pass through. Paths are
+// at most a few steps longer than the shortest one. A hierarchy holds
+// scratch memory, so only one thread may query it at a time.
+typedef struct {
+    int cluster_size;
+    int clusters_x, clusters_z;
+    int node_count;
+    PathCell* nodes;
+    int* node_cluster;
+    int* cluster_start;
+    int* edge_start;
+    int* edge_to;
+    int* edge_cost;
+    int* local_distance;
+    int* local_queue;
+    int* cost;
+    int* parent;
+    unsigned* visited;
+    unsigned query;
+    int* goal_cost;
+    int64_t* heap;
+    int heap_capacity;
+} PathHierarchy;
+
+bool path_hierarchy_build(PathHierarchy* hierarchy, const CollisionMap* map, int cluster_size);
+// Returns the path length in steps, or -1 when goal cannot be reached. When
+// path is given, up to max_cells cells from start to goal are written to it.
+int path_hierarchy_find(PathHierarchy* hierarchy, const CollisionMap* map, PathCell start, PathCell goal,
+                        PathCell* path, int max_cells);
+void path_hierarchy_free(PathHierarchy* hierarchy);
+
+#endif
@@ -0,0 +1,184 @@
+#include "platform.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#include <stdio.h>
+
+double platform_time_seconds() {
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER now;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)frequency.QuadPart;
+}
+
+size_t platform_peak_memory_bytes() {
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+}
+
+bool platform_map_file(const char* path, MappedFile* file) {
+    file->data = NULL;
+    file->size = 0;
+    file->handle = NULL;
+
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+        CloseHandle(handle);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(handle);
+    if (!mapping) return false;
+
+    file->data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!file->data) {
+        CloseHandle(mapping);
+        return false;
+    }
+    file->size = (size_t)size.QuadPart;
+    file->handle = mapping;
+    return true;
+}
+
+void platform_unmap_file(MappedFile* file) {
+    if (file->data) UnmapViewOfFile(file->data);
+    if (file->handle) CloseHandle(file->handle);
+    file->data = NULL;
+    file->size = 0;
+    file->handle = NULL;
+}
+
+bool platform_file_info(const char* path, uint64_t* size, int64_t* modified) {
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &info)) return false;
+    *size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    *modified = (int64_t)(((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime);
+    return true;
+}
+
+int platform_list_files(const char* directory, const char* extension,
+                        void (*visit)(const char* path, void* user), void* user) {
+    char pattern[MAX_PATH], path[MAX_PATH];
+    snprintf(pattern, sizeof(pattern), "%s\\*%s", directory, extension);
+
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA(pattern, &entry);
+    if (find == INVALID_HANDLE_VALUE) return 0;
+
+    int count = 0;
+    do {
+        if (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+        snprintf(path, sizeof(path), "%s/%s", directory, entry.cFileName);
+        visit(path, user);
+        count++;
+    } while (FindNextFileA(find, &entry));
+    FindClose(find);
+    return count;
+}
+
+bool platform_make_directory(const char* path) {
+    return CreateDirectoryA(path, NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
+}
+
+#else
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+double platform_time_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+size_t platform_peak_memory_bytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+bool platform_map_file(const char* path, MappedFile* file) {
+    file->data = NULL;
+    file->size = 0;
+    file->handle = NULL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    file->data = data;
+    file->size = (size_t)info.st_size;
+    return true;
+}
+
+void platform_unmap_file(MappedFile* file) {
+    if (file->data) munmap((void*)file->data, file->size);
+    file->data = NULL;
+    file->size = 0;
+    file->handle = NULL;
+}
+
+bool platform_file_info(const char* path, uint64_t* size, int64_t* modified) {
+    struct stat info;
+    if (stat(path, &info) != 0) return false;
+    *size = (uint64_t)info.st_size;
+    *modified = (int64_t)info.st_mtime;
+    return true;
+}
+
+int platform_list_files(const char* directory, const char* extension,
+                        void (*visit)(const char* path, void* user), void* user) {
+    DIR* dir = opendir(directory);
+    if (!dir) return 0;
+
+    char path[4096];
+    size_t ext_len = strlen(extension);
+    int count = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (len <= ext_len || strcmp(entry->d_name + len - ext_len, extension) != 0) continue;
+        snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+
+        struct stat info;
+        if (stat(path, &info) != 0 || !S_ISREG(info.st_mode)) continue;
+        visit(path, user);
+        count++;
+    }
+    closedir(dir);
+    return count;
+}
+
+bool platform_make_directory(const char* path) {
+    struct stat info;
+    if (mkdir(path, 0755) == 0) return true;
+    return stat(path, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+#endif
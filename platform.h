@@ -0,0 +1,28 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    void* handle;
+} MappedFile;
+
+double platform_time_seconds();
+size_t platform_peak_memory_bytes();
+
+// Maps a whole file read-only; the pages are shared with the OS file cache.
+bool platform_map_file(const char* path, MappedFile* file);
+void platform_unmap_file(MappedFile* file);
+
+bool platform_file_info(const char* path, uint64_t* size, int64_t* modified);
+// Calls visit for each file in directory whose name ends with extension, in no particular order.
+int platform_list_files(const char* directory, const char* extension,
+                        void (*visit)(const char* path, void* user), void* user);
+// Creates directory unless it already exists.
+bool platform_make_directory(const char* path);
+
+#endif
@@ -1,117 +1,63 @@
-#include <GL/glut.h>
 #include <math.h>
-#include <ctype.h>
 #include "player.h"
-#include "game.h"
 
-static Player player;
-static bool key_states[256] = {false};
-
-static bool check_collision(float nx, float nz, const int maze[MAZE_WIDTH][MAZE_HEIGHT]) {
-    float p_min_x = nx - PLAYER_SIZE / 2.0f;
-    float p_max_x = nx + PLAYER_SIZE / 2.0f;
-    float p_min_z = nz - PLAYER_SIZE / 2.0f;
-    float p_max_z = nz + PLAYER_SIZE / 2.0f;
-
-    int grid_x = (int)(nx / CUBE_SIZE);
-    int grid_z = (int)(nz / CUBE_SIZE);
-
-    for (int x = grid_x - 1; x <= grid_x + 1; x++) {
-        for (int z = grid_z - 1; z <= grid_z + 1; z++) {
-            if (x < 0 || x >= MAZE_WIDTH || z < 0 || z >= MAZE_HEIGHT) continue;
-            if (maze[x][z] == 1 || (x == 13 && z == 13 && game_get_state() == STATE_PLAYING)) {
-                float w_min_x = x * CUBE_SIZE;
-                float w_max_x = x * CUBE_SIZE + CUBE_SIZE;
-                float w_min_z = z * CUBE_SIZE;
-                float w_max_z = z * CUBE_SIZE + CUBE_SIZE;
-
-                if (p_max_x > w_min_x && p_min_x < w_max_x && p_max_z > w_min_z && p_min_z < w_max_z) {
-                    return true;
-                }
-            }
-        }
-    }
-    return false;
+void player_init(Player* player, const World* world) {
+    player->x = world->start_x;
+    player->y = 0.5f;
+    player->z = world->start_z;
+    player->angle = PI / 2.0f;
+    player->pitch = 0.0f;
+    player->speed = PLAYER_SPEED;
+    player->prev_x = player->x;
+    player->prev_y = player->y;
+    player->prev_z = player->z;
 }
 
-void player_init() {
-    player.x = 7.5f;
-    player.y = 0.5f;
-    player.z = 7.5f;
-    player.angle = PI / 2.0f;
-    player.pitch = 0.0f;
-    player.speed = 0.03f;
+void player_look(Player* player, float dx, float dy) {
+    player->angle -= dx;
+    player->pitch -= dy;
+
+    if (player->pitch > PITCH_LIMIT) player->pitch = PITCH_LIMIT;
+    if (player->pitch < -PITCH_LIMIT) player->pitch = -PITCH_LIMIT;
 }
 
-void player_update(const int maze[MAZE_WIDTH][MAZE_HEIGHT]) {
-    float move_x = 0.0f, move_z = 0.0f;
-    if (key_states['w']) { move_x += cos(player.angle) * player.speed; move_z += -sin(player.angle) * player.speed; }
-    if (key_states['s']) { move_x -= cos(player.angle) * player.speed; move_z -= -sin(player.angle) * player.speed; }
-    if (key_states['a']) { move_x += -sin(player.angle) * player.speed; move_z += -cos(player.angle) * player.speed; }
-    if (key_states['d']) { move_x += sin(player.angle) * player.speed; move_z += cos(player.angle) * player.speed; }
+void player_update(Player* player, const World* world, const CollisionMap* collision, const PlayerInput* input, GameState state, float dt) {
+    player->prev_x = player->x;
+    player->prev_y = player->y;
+    player->prev_z = player->z;
 
-    if (move_x != 0.0f || move_z != 0.0f) {
-        if (!check_collision(player.x + move_x, player.z + move_z, maze)) {
-            player.x += move_x;
-            player.z += move_z;
-        }
+    if (input->turn != 0.0f || input->tilt != 0.0f) {
+        player_look(player, input->turn, input->tilt);
     }
 
-    int px = (int)(player.x / CUBE_SIZE);
-    int pz = (int)(player.z / CUBE_SIZE);
+    float speed = player->speed;
+    float vel_x = 0.0f, vel_z = 0.0f;
+    if (input->forward) { vel_x += cos(player->angle) * speed; vel_z += -sin(player->angle) * speed; }
+    if (input->back) { vel_x -= cos(player->angle) * speed; vel_z -= -sin(player->angle) * speed; }
+    if (input->left) { vel_x += -sin(player->angle) * speed; vel_z += -cos(player->angle) * speed; }
+    if (input->right) { vel_x += sin(player->angle) * speed; vel_z += cos(player->angle) * speed; }
 
-    if (px == 13 && pz == 13 && (game_get_state() != STATE_PLAYING)) {
-        player.y -= 0.1f;
-    } else {
-        if (player.y < 0.5f) {
-            player.y = 0.5f;
-        }
+    if (vel_x != 0.0f || vel_z != 0.0f) {
+        CollisionBodies body = {&player->x, &player->z, &vel_x, &vel_z, 1, 1};
+        collision_move(collision, &body, PLAYER_SIZE / 2.0f, dt);
     }
-}
 
-void player_handle_keyboard(unsigned char key, bool is_pressed) {
-    if (key >= 'a' && key <= 'z') key_states[key] = is_pressed;
-    if (key >= 'A' && key <= 'Z') key_states[tolower(key)] = is_pressed;
+    int px = (int)(player->x / CUBE_SIZE);
+    int pz = (int)(player->z / CUBE_SIZE);
 
-    if (is_pressed) {
-        if (key == 27) {
-             GameState current_state = game_get_state();
-             if (current_state == STATE_PLAYING || current_state == STATE_ESCAPING) {
-                 game_set_state(STATE_PAUSED);
-                 glutSetCursor(GLUT_CURSOR_INHERIT);
-             }
+    if (world_is_exit(world, px, pz) && state != STATE_PLAYING) {
+        player->y -= PLAYER_FALL_SPEED * dt;
+    } else {
+        if (player->y < 0.5f) {
+            player->y = 0.5f;
         }
     }
 }
 
-void player_handle_mouse_motion(int x, int y) {
-    GameState current_state = game_get_state();
-    if (current_state == STATE_PLAYING || current_state == STATE_ESCAPING) {
-        int w_center = glutGet(GLUT_WINDOW_WIDTH) / 2;
-        int h_center = glutGet(GLUT_WINDOW_HEIGHT) / 2;
-        if (x == w_center && y == h_center) return;
-
-        float dx = (x - w_center) * 0.003f;
-        float dy = (y - h_center) * 0.003f;
-
-        player.angle -= dx;
-        player.pitch -= dy;
-
-        if (player.pitch > PITCH_LIMIT) player.pitch = PITCH_LIMIT;
-        if (player.pitch < -PITCH_LIMIT) player.pitch = -PITCH_LIMIT;
-
-        glutWarpPointer(w_center, h_center);
-    }
-}
-
-const Player* player_get() {
-    return &player;
-}
-
-bool player_get_key_state(unsigned char key) {
-    return key_states[key];
-}
-
-void player_set_key_state(unsigned char key, bool state) {
-    key_states[key] = state;
+Player player_get_view(const Player* player, float alpha) {
+    Player view = *player;
+    view.x = player->prev_x + (player->x - player->prev_x) * alpha;
+    view.y = player->prev_y + (player->y - player->prev_y) * alpha;
+    view.z = player->prev_z + (player->z - player->prev_z) * alpha;
+    return view;
 }
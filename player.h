@@ -2,15 +2,18 @@
 #define PLAYER_H
 
 #include "config.h"
+#include "world.h"
+#include "collision.h"
 #include <stdbool.h>
 
-void player_init();
-void player_update(const int maze[MAZE_WIDTH][MAZE_HEIGHT]);
-void player_handle_keyboard(unsigned char key, bool is_pressed);
-void player_handle_mouse_motion(int x, int y);
+typedef struct {
+    bool forward, back, left, right;
+    float turn, tilt;
+} PlayerInput;
 
-const Player* player_get();
-bool player_get_key_state(unsigned char key);
-void player_set_key_state(unsigned char key, bool state);
+void player_init(Player* player, const World* world);
+void player_look(Player* player, float dx, float dy);
+void player_update(Player* player, const World* world, const CollisionMap* collision, const PlayerInput* input, GameState state, float dt);
+Player player_get_view(const Player* player, float alpha);
 
 #endif
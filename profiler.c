@@ -0,0 +1,173 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "profiler.h"
+#include "platform.h"
+#include "thread.h"
+
+typedef struct {
+    float samples[PROFILER_HISTORY];
+    int count;
+    int next;
+} SampleRing;
+
+static const char* phase_names[PROFILE_PHASE_COUNT] = {
+    "frame", "game_update", "player_update", "chasers", "lighting", "floor_ceiling",
+    "maze", "collectibles", "billboards", "ui", "swap"
+};
+
+static bool enabled = false;
+static const char* dump_path = NULL;
+static double phase_start[PROFILE_PHASE_COUNT];
+static double frame_accum[PROFILE_PHASE_COUNT];
+static double last_frame_time = 0.0;
+static SampleRing cpu_rings[PROFILE_PHASE_COUNT];
+static SampleRing gpu_rings[PROFILE_PHASE_COUNT];
+// The simulation thread ends its phases concurrently with the window thread.
+static ThreadMutex* accum_lock = NULL;
+
+static bool is_tick_phase(int phase) {
+    return phase == PROFILE_GAME_UPDATE || phase == PROFILE_PLAYER_UPDATE || phase == PROFILE_CHASERS;
+}
+
+static void ring_push(SampleRing* ring, float value) {
+    ring->samples[ring->next] = value;
+    ring->next = (ring->next + 1) % PROFILER_HISTORY;
+    if (ring->count < PROFILER_HISTORY) ring->count++;
+}
+
+static int compare_floats(const void* a, const void* b) {
+    float fa = *(const float*)a, fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+static void ring_stats(const SampleRing* ring, float* min, float* avg, float* p99, float* max) {
+    float sorted[PROFILER_HISTORY];
+    *min = *avg = *p99 = *max = 0.0f;
+    if (ring->count == 0) return;
+
+    memcpy(sorted, ring->samples, ring->count * sizeof(float));
+    qsort(sorted, ring->count, sizeof(float), compare_floats);
+
+    double sum = 0.0;
+    for (int i = 0; i < ring->count; i++) sum += sorted[i];
+    *min = sorted[0];
+    *max = sorted[ring->count - 1];
+    *avg = (float)(sum / ring->count);
+    *p99 = sorted[(ring->count - 1) * 99 / 100];
+}
+
+void profiler_set_enabled(bool value) {
+    if (value && !accum_lock) accum_lock = thread_mutex_create();
+    enabled = value;
+    last_frame_time = platform_time_seconds();
+}
+
+bool profiler_is_enabled() {
+    return enabled;
+}
+
+void profiler_set_dump_path(const char* path) {
+    dump_path = path;
+}
+
+void profiler_begin(ProfilePhase phase) {
+    if (!enabled) return;
+    phase_start[phase] = platform_time_seconds();
+}
+
+void profiler_end(ProfilePhase phase) {
+    if (!enabled) return;
+    double elapsed = platform_time_seconds() - phase_start[phase];
+    thread_mutex_lock(accum_lock);
+    frame_accum[phase] += elapsed;
+    thread_mutex_unlock(accum_lock);
+}
+
+void profiler_add_gpu_sample(ProfilePhase phase, double seconds) {
+    if (!enabled) return;
+    ring_push(&gpu_rings[phase], (float)(seconds * 1000.0));
+}
+
+void profiler_end_tick() {
+    if (!enabled) return;
+    thread_mutex_lock(accum_lock);
+    for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        if (!is_tick_phase(i)) continue;
+        ring_push(&cpu_rings[i], (float)(frame_accum[i] * 1000.0));
+        frame_accum[i] = 0.0;
+    }
+    thread_mutex_unlock(accum_lock);
+}
+
+void profiler_end_frame() {
+    if (!enabled) return;
+
+    double now = platform_time_seconds();
+    thread_mutex_lock(accum_lock);
+    frame_accum[PROFILE_FRAME] = now - last_frame_time;
+    last_frame_time = now;
+
+    for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        if (is_tick_phase(i)) continue;
+        ring_push(&cpu_rings[i], (float)(frame_accum[i] * 1000.0));
+        frame_accum[i] = 0.0;
+    }
+    thread_mutex_unlock(accum_lock);
+}
+
+void profiler_get_stats(ProfilePhase phase, ProfileStats* stats) {
+    // Tick phases are pushed from the simulation thread, so the ring is read from a copy.
+    SampleRing cpu;
+    if (accum_lock) thread_mutex_lock(accum_lock);
+    cpu = cpu_rings[phase];
+    if (accum_lock) thread_mutex_unlock(accum_lock);
+    stats->samples = cpu.count;
+    ring_stats(&cpu, &stats->cpu_min, &stats->cpu_avg, &stats->cpu_p99, &stats->cpu_max);
+    float gpu_max;
+    stats->gpu_samples = gpu_rings[phase].count;
+    ring_stats(&gpu_rings[phase], &stats->gpu_min, &stats->gpu_avg, &stats->gpu_p99, &gpu_max);
+}
+
+const char* profiler_phase_name(ProfilePhase phase) {
+    return phase < PROFILE_PHASE_COUNT ? phase_names[phase] : "?";
+}
+
+bool profiler_dump(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Nao foi possivel gravar o perfil: %s\n", path);
+        return false;
+    }
+
+    size_t len = strlen(path);
+    bool json = len >= 5 && strcmp(path + len - 5, ".json") == 0;
+
+    if (json) fprintf(file, "{\n  \"phases\": [\n");
+    else fprintf(file, "phase,samples,cpu_min_ms,cpu_avg_ms,cpu_p99_ms,cpu_max_ms,gpu_samples,gpu_min_ms,gpu_avg_ms,gpu_p99_ms\n");
+
+    for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        ProfileStats s;
+        profiler_get_stats((ProfilePhase)i, &s);
+        if (json) {
+            fprintf(file, "    {\"phase\": \"%s\", \"samples\": %d, \"cpu_min_ms\": %.4f, \"cpu_avg_ms\": %.4f, "
+                          "\"cpu_p99_ms\": %.4f, \"cpu_max_ms\": %.4f, \"gpu_samples\": %d, \"gpu_min_ms\": %.4f, "
+                          "\"gpu_avg_ms\": %.4f, \"gpu_p99_ms\": %.4f}%s\n",
+                    phase_names[i], s.samples, s.cpu_min, s.cpu_avg, s.cpu_p99, s.cpu_max,
+                    s.gpu_samples, s.gpu_min, s.gpu_avg, s.gpu_p99, i + 1 < PROFILE_PHASE_COUNT ? "," : "");
+        } else {
+            fprintf(file, "%s,%d,%.4f,%.4f,%.4f,%.4f,%d,%.4f,%.4f,%.4f\n",
+                    phase_names[i], s.samples, s.cpu_min, s.cpu_avg, s.cpu_p99, s.cpu_max,
+                    s.gpu_samples, s.gpu_min, s.gpu_avg, s.gpu_p99);
+        }
+    }
+
+    if (json) fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+void profiler_shutdown() {
+    if (enabled && dump_path) profiler_dump(dump_path);
+    enabled = false;
+}
@@ -0,0 +1,47 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+
+#define PROFILER_HISTORY 300
+
+typedef enum {
+    PROFILE_FRAME,
+    PROFILE_GAME_UPDATE,
+    PROFILE_PLAYER_UPDATE,
+    PROFILE_CHASERS,
+    PROFILE_LIGHTING,
+    PROFILE_FLOOR_CEILING,
+    PROFILE_MAZE,
+    PROFILE_COLLECTIBLES,
+    PROFILE_BILLBOARDS,
+    PROFILE_UI,
+    PROFILE_SWAP,
+    PROFILE_PHASE_COUNT
+} ProfilePhase;
+
+typedef struct {
+    int samples;
+    float cpu_min, cpu_avg, cpu_p99, cpu_max;
+    int gpu_samples;
+    float gpu_min, gpu_avg, gpu_p99;
+} ProfileStats;
+
+void profiler_set_enabled(bool enabled);
+bool profiler_is_enabled();
+void profiler_set_dump_path(const char* path);
+
+void profiler_begin(ProfilePhase phase);
+void profiler_end(ProfilePhase phase);
+void profiler_add_gpu_sample(ProfilePhase phase, double seconds);
+// game_update, player_update and chasers run on the simulation thread and get one
+// sample per tick; profiler_end_frame leaves them alone.
+void profiler_end_tick();
+void profiler_end_frame();
+
+void profiler_get_stats(ProfilePhase phase, ProfileStats* stats);
+const char* profiler_phase_name(ProfilePhase phase);
+bool profiler_dump(const char* path);
+void profiler_shutdown();
+
+#endif
@@ -0,0 +1,110 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pvs.h"
+
+#define PVS_SIDE (2 * PVS_RADIUS + 1)
+#define PVS_BYTES ((PVS_SIDE * PVS_SIDE + 7) / 8)
+#define PVS_RAYS 720
+
+static int local_index(int x, int z) {
+    return ((x & CHUNK_MASK) << CHUNK_SHIFT) | (z & CHUNK_MASK);
+}
+
+static unsigned char* cell_bits(const PvsChunk* pvs, int x, int z) {
+    return &pvs->bits[(size_t)local_index(x, z) * PVS_BYTES];
+}
+
+static void mark(unsigned char* bits, int dx, int dz) {
+    int i = (dx + PVS_RADIUS) * PVS_SIDE + (dz + PVS_RADIUS);
+    bits[i >> 3] |= 1 << (i & 7);
+}
+
+static void cast_ray(const World* world, unsigned char* bits, int cx, int cz,
+                     float ox, float oz, float dir_x, float dir_z) {
+    int x = cx, z = cz;
+    int step_x = dir_x < 0 ? -1 : 1;
+    int step_z = dir_z < 0 ? -1 : 1;
+    float delta_x = dir_x != 0.0f ? fabsf(1.0f / dir_x) : 1e30f;
+    float delta_z = dir_z != 0.0f ? fabsf(1.0f / dir_z) : 1e30f;
+    float side_x = (dir_x < 0 ? ox - x : x + 1 - ox) * delta_x;
+    float side_z = (dir_z < 0 ? oz - z : z + 1 - oz) * delta_z;
+
+    for (;;) {
+        if (side_x < side_z) { side_x += delta_x; x += step_x; }
+        else { side_z += delta_z; z += step_z; }
+
+        if (abs(x - cx) > PVS_RADIUS || abs(z - cz) > PVS_RADIUS) return;
+        if (!world_in_bounds(world, x, z)) return;
+
+        mark(bits, x - cx, z - cz);
+        if (world_get(world, x, z) == 1) return;
+    }
+}
+
+// The set is sampled with PVS_RAYS rays from each of 9 points in the cell, so it is
+// approximate: a cell seen only through a sliver no ray hits can be left out.
+void pvs_compute_cell(PvsChunk* pvs, const World* world, int cx, int cz) {
+    unsigned char* bits = cell_bits(pvs, cx, cz);
+    pvs->ready[local_index(cx, cz)] = 1;
+    if (world_get(world, cx, cz) == 1) return;
+
+    // The camera can stand anywhere in the cell, so the immediate ring is always kept.
+    for (int dx = -1; dx <= 1; dx++) {
+        for (int dz = -1; dz <= 1; dz++) {
+            if (world_in_bounds(world, cx + dx, cz + dz)) mark(bits, dx, dz);
+        }
+    }
+
+    static const float origins[9][2] = {
+        {0.5f, 0.5f}, {0.05f, 0.05f}, {0.95f, 0.05f}, {0.05f, 0.95f}, {0.95f, 0.95f},
+        {0.5f, 0.05f}, {0.5f, 0.95f}, {0.05f, 0.5f}, {0.95f, 0.5f}
+    };
+    for (int o = 0; o < 9; o++) {
+        float ox = cx + origins[o][0];
+        float oz = cz + origins[o][1];
+        for (int r = 0; r < PVS_RAYS; r++) {
+            float a = (float)r / PVS_RAYS * 2.0f * (float)PI;
+            cast_ray(world, bits, cx, cz, ox, oz, cosf(a), sinf(a));
+        }
+    }
+}
+
+bool pvs_chunk_init(PvsChunk* pvs, int cx, int cz) {
+    memset(pvs, 0, sizeof(*pvs));
+    pvs->cx = cx;
+    pvs->cz = cz;
+    pvs->bits = calloc(CHUNK_SIZE * CHUNK_SIZE, PVS_BYTES);
+    return pvs->bits != NULL;
+}
+
+void pvs_chunk_free(PvsChunk* pvs) {
+    free(pvs->bits);
+    pvs->bits = NULL;
+}
+
+int pvs_fill(PvsChunk* pvs, const World* world, int budget) {
+    int computed = 0;
+    while (computed < budget && pvs->fill_cursor < CHUNK_SIZE * CHUNK_SIZE) {
+        int i = pvs->fill_cursor++;
+        if (pvs->ready[i]) continue;
+        int x = (pvs->cx << CHUNK_SHIFT) + (i >> CHUNK_SHIFT);
+        int z = (pvs->cz << CHUNK_SHIFT) + (i & CHUNK_MASK);
+        pvs_compute_cell(pvs, world, x, z);
+        computed++;
+    }
+    return computed;
+}
+
+bool pvs_cell_ready(const PvsChunk* pvs, int x, int z) {
+    return pvs->bits && pvs->ready[local_index(x, z)];
+}
+
+bool pvs_is_visible(const PvsChunk* pvs, int from_x, int from_z, int x, int z) {
+    int dx = x - from_x, dz = z - from_z;
+    if (abs(dx) > PVS_RADIUS || abs(dz) > PVS_RADIUS) return false;
+
+    const unsigned char* bits = cell_bits(pvs, from_x, from_z);
+    int i = (dx + PVS_RADIUS) * PVS_SIDE + (dz + PVS_RADIUS);
+    return (bits[i >> 3] >> (i & 7)) & 1;
+}
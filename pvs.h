@@ -0,0 +1,23 @@
+#ifndef PVS_H
+#define PVS_H
+
+#include <stdbool.h>
+#include "config.h"
+#include "world.h"
+
+typedef struct {
+    int cx, cz;
+    unsigned char* bits;
+    unsigned char ready[CHUNK_SIZE * CHUNK_SIZE];
+    int fill_cursor;
+} PvsChunk;
+
+bool pvs_chunk_init(PvsChunk* pvs, int cx, int cz);
+void pvs_chunk_free(PvsChunk* pvs);
+// Approximate: sampled by rays, so a cell visible through a narrow gap may be missed.
+void pvs_compute_cell(PvsChunk* pvs, const World* world, int x, int z);
+int pvs_fill(PvsChunk* pvs, const World* world, int budget);
+bool pvs_cell_ready(const PvsChunk* pvs, int x, int z);
+bool pvs_is_visible(const PvsChunk* pvs, int from_x, int from_z, int x, int z);
+
+#endif
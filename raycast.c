@@ -0,0 +1,687 @@
+#include "raycast.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "jobs.h"
+#include "platform.h"
+#include "bmp.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAYCAST_SSE2
+#include <emmintrin.h>
+#endif
+
+#define RAYCAST_STRIPE_WIDTH 16
+#define RAYCAST_MAX_STEPS 256
+#define RAYCAST_MAX_DISTANCE 64.0f
+#define RAYCAST_FOV_Y 45.0f
+#define RAYCAST_LEVELS (RAYCAST_TEXTURE_SHIFT + 1)
+// Light is sampled on a grid of RAYCAST_LIGHT_SUBDIV samples per cell around the camera.
+#define RAYCAST_LIGHT_SUBDIV 4
+#define RAYCAST_LIGHT_SHIFT 8
+#define RAYCAST_LIGHT_SIDE (1 << RAYCAST_LIGHT_SHIFT)
+// Light channels are 8.8 fixed point, packed b, g, r, a in 16-bit lanes like an unpacked pixel.
+#define RAYCAST_LIGHT_ONE 256
+#define RAYCAST_LIGHT_ALPHA ((uint64_t)RAYCAST_LIGHT_ONE << 48)
+
+typedef struct {
+    uint32_t* texels;
+    int offsets[RAYCAST_LEVELS];
+    bool has_alpha;
+} RaycastMipmaps;
+
+// Where level 0 is resampled from: a BMP or RGBA pixels, both bottom row first.
+typedef struct {
+    const BmpImage* image;
+    const unsigned char* rgba;
+    int width, height;
+} TextureSource;
+
+// One light grid per surface orientation; walls are lit at half their height.
+typedef enum {
+    SURFACE_FLOOR,
+    SURFACE_CEILING,
+    SURFACE_WALL_POS_X,
+    SURFACE_WALL_NEG_X,
+    SURFACE_WALL_POS_Z,
+    SURFACE_WALL_NEG_Z,
+    SURFACE_COUNT
+} Surface;
+
+static const float surface_normals[SURFACE_COUNT][3] = {
+    {0, 1, 0}, {0, -1, 0}, {1, 0, 0}, {-1, 0, 0}, {0, 0, 1}, {0, 0, -1}
+};
+
+typedef struct {
+    const World* world;
+    float x, z, eye, wall;
+    float dir_x, dir_z, right_x, right_z;
+    float focal, center, horizon;
+    bool exit_closed;
+} RaycastView;
+
+typedef struct {
+    float x, y, size, depth;
+    RaycastTexture texture;
+    uint64_t light;
+} ProjectedSprite;
+
+static RaycastMipmaps textures[RAYCAST_TEXTURE_COUNT];
+static RaycastFrame frame;
+static int* column_top = NULL;
+static int* column_bottom = NULL;
+static float* column_depth = NULL;
+static RaycastView view;
+static const RaycastScene* current_scene = NULL;
+
+static uint64_t* light_grids[SURFACE_COUNT];
+static int light_origin_x, light_origin_z;
+
+static ProjectedSprite sprites[RAYCAST_MAX_SPRITES];
+static int sprite_count = 0;
+
+bool raycast_init() {
+    for (int i = 0; i < SURFACE_COUNT; i++) {
+        light_grids[i] = malloc(RAYCAST_LIGHT_SIDE * RAYCAST_LIGHT_SIDE * sizeof(uint64_t));
+        if (!light_grids[i]) return false;
+    }
+    if (!jobs_init(0)) return false;
+    printf("Raycaster por software com %d threads\n", jobs_thread_count());
+    return true;
+}
+
+static uint32_t average4(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t sum = ((a >> shift) & 0xFF) + ((b >> shift) & 0xFF) + ((c >> shift) & 0xFF) + ((d >> shift) & 0xFF);
+        out |= ((sum + 2) / 4) << shift;
+    }
+    return out;
+}
+
+static uint32_t source_texel(const TextureSource* source, int x, int y) {
+    if (source->image) {
+        const unsigned char* p = bmp_row(source->image, y) + x * (source->image->bits / 8);
+        return 0xFF000000u | (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+    }
+    const unsigned char* p = source->rgba + ((size_t)y * source->width + x) * 4;
+    return (uint32_t)p[2] | ((uint32_t)p[1] << 8) | ((uint32_t)p[0] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool build_mipmaps(RaycastMipmaps* mips, const TextureSource* source) {
+    size_t total = 0;
+    for (int l = 0; l < RAYCAST_LEVELS; l++) {
+        mips->offsets[l] = (int)total;
+        total += (size_t)1 << (2 * (RAYCAST_TEXTURE_SHIFT - l));
+    }
+    free(mips->texels);
+    mips->texels = malloc(total * sizeof(uint32_t));
+    if (!mips->texels) return false;
+    mips->has_alpha = source->rgba != NULL;
+
+    // Level 0 averages four source texels per texel; rows stay bottom-up like the GL textures.
+    for (int v = 0; v < RAYCAST_TEXTURE_SIZE; v++) {
+        for (int u = 0; u < RAYCAST_TEXTURE_SIZE; u++) {
+            uint32_t samples[4];
+            for (int s = 0; s < 4; s++) {
+                int sx = (int)(((u + 0.25f + 0.5f * (s & 1)) / RAYCAST_TEXTURE_SIZE) * source->width);
+                int sy = (int)(((v + 0.25f + 0.5f * (s >> 1)) / RAYCAST_TEXTURE_SIZE) * source->height);
+                samples[s] = source_texel(source, sx, sy);
+            }
+            mips->texels[(v << RAYCAST_TEXTURE_SHIFT) + u] = average4(samples[0], samples[1], samples[2], samples[3]);
+        }
+    }
+
+    for (int l = 1; l < RAYCAST_LEVELS; l++) {
+        int shift = RAYCAST_TEXTURE_SHIFT - l, size = 1 << shift;
+        const uint32_t* src = mips->texels + mips->offsets[l - 1];
+        uint32_t* dst = mips->texels + mips->offsets[l];
+        for (int v = 0; v < size; v++) {
+            for (int u = 0; u < size; u++) {
+                const uint32_t* row = src + ((2 * v) << (shift + 1)) + 2 * u;
+                dst[(v << shift) + u] = average4(row[0], row[1], row[size * 2], row[size * 2 + 1]);
+            }
+        }
+    }
+    return true;
+}
+
+bool raycast_load_texture(RaycastTexture texture, const char* filename) {
+    MappedFile file;
+    if (!platform_map_file(filename, &file)) {
+        printf("Nao foi possivel abrir a textura %s\n", filename);
+        return false;
+    }
+    BmpImage image;
+    const char* error = bmp_parse(&file, &image);
+    if (error) {
+        printf("Nao e um arquivo BMP (%s): %s\n", filename, error);
+        platform_unmap_file(&file);
+        return false;
+    }
+
+    TextureSource source = {&image, NULL, image.width, image.height};
+    bool ok = build_mipmaps(&textures[texture], &source);
+    platform_unmap_file(&file);
+    return ok;
+}
+
+bool raycast_load_pixels(RaycastTexture texture, const unsigned char* rgba, int width, int height) {
+    TextureSource source = {NULL, rgba, width, height};
+    return build_mipmaps(&textures[texture], &source);
+}
+
+bool raycast_resize(int width, int height) {
+    if (width < 1) width = 1;
+    if (height < 1) height = 1;
+    if (frame.pixels && frame.width == width && frame.height == height) return true;
+
+    int stride = (width + RAYCAST_STRIPE_WIDTH - 1) / RAYCAST_STRIPE_WIDTH * RAYCAST_STRIPE_WIDTH;
+    free(frame.pixels);
+    free(column_top);
+    free(column_bottom);
+    free(column_depth);
+    frame.pixels = malloc((size_t)stride * height * sizeof(uint32_t));
+    column_top = malloc(stride * sizeof(int));
+    column_bottom = malloc(stride * sizeof(int));
+    column_depth = malloc(stride * sizeof(float));
+    frame.width = width;
+    frame.height = height;
+    frame.stride = stride;
+    return frame.pixels && column_top && column_bottom && column_depth;
+}
+
+static uint64_t pack_light(float r, float g, float b) {
+    float channels[3] = {b, g, r};
+    uint64_t packed = RAYCAST_LIGHT_ALPHA;
+    for (int i = 0; i < 3; i++) {
+        int value = (int)(channels[i] * RAYCAST_LIGHT_ONE);
+        if (value < 0) value = 0;
+        if (value > RAYCAST_LIGHT_ONE) value = RAYCAST_LIGHT_ONE;
+        packed |= (uint64_t)value << (16 * i);
+    }
+    return packed;
+}
+
+// Lanes never exceed RAYCAST_LIGHT_ONE, so a saturating add per lane is plain integer work.
+static uint64_t add_light(uint64_t packed, float r, float g, float b) {
+    float channels[3] = {b, g, r};
+    for (int i = 0; i < 3; i++) {
+        int shift = 16 * i;
+        int value = (int)((packed >> shift) & 0xFFFF) + (int)(channels[i] * RAYCAST_LIGHT_ONE);
+        if (value > RAYCAST_LIGHT_ONE) value = RAYCAST_LIGHT_ONE;
+        packed = (packed & ~((uint64_t)0xFFFF << shift)) | ((uint64_t)value << shift);
+    }
+    return packed;
+}
+
+// Same attenuation, window and diffuse term as the clustered shader.
+static void splat_light(Surface surface, const PointLight* light) {
+    uint64_t* grid = light_grids[surface];
+    const float* n = surface_normals[surface];
+    float surface_y = surface == SURFACE_FLOOR ? 0.0f : (surface == SURFACE_CEILING ? WALL_HEIGHT : WALL_HEIGHT * 0.5f);
+    float height = light->y - surface_y;
+    float reach = LIGHT_RADIUS / CUBE_SIZE * RAYCAST_LIGHT_SUBDIV;
+    float cx = light->x / CUBE_SIZE * RAYCAST_LIGHT_SUBDIV - light_origin_x;
+    float cz = light->z / CUBE_SIZE * RAYCAST_LIGHT_SUBDIV - light_origin_z;
+    int i0 = (int)floorf(cx - reach), i1 = (int)ceilf(cx + reach);
+    int j0 = (int)floorf(cz - reach), j1 = (int)ceilf(cz + reach);
+    // The outermost ring stays at the ambient level, so clamped lookups past the grid are unlit.
+    if (i0 < 1) i0 = 1;
+    if (j0 < 1) j0 = 1;
+    if (i1 > RAYCAST_LIGHT_SIDE - 2) i1 = RAYCAST_LIGHT_SIDE - 2;
+    if (j1 > RAYCAST_LIGHT_SIDE - 2) j1 = RAYCAST_LIGHT_SIDE - 2;
+    // Walls only see the light from their own side.
+    if (n[0] > 0.0f && i1 > (int)ceilf(cx - 0.5f) - 1) i1 = (int)ceilf(cx - 0.5f) - 1;
+    if (n[0] < 0.0f && i0 < (int)floorf(cx - 0.5f) + 1) i0 = (int)floorf(cx - 0.5f) + 1;
+    if (n[2] > 0.0f && j1 > (int)ceilf(cz - 0.5f) - 1) j1 = (int)ceilf(cz - 0.5f) - 1;
+    if (n[2] < 0.0f && j0 < (int)floorf(cz - 0.5f) + 1) j0 = (int)floorf(cz - 0.5f) + 1;
+
+    float scale = CUBE_SIZE / RAYCAST_LIGHT_SUBDIV;
+    for (int i = i0; i <= i1; i++) {
+        float dx = (cx - i - 0.5f) * scale;
+        float remaining = LIGHT_RADIUS * LIGHT_RADIUS - dx * dx - height * height;
+        if (remaining <= 0.0f) continue;
+        float half = sqrtf(remaining) / scale;
+        int row_j0 = (int)ceilf(cz - 0.5f - half), row_j1 = (int)floorf(cz - 0.5f + half);
+        if (row_j0 < j0) row_j0 = j0;
+        if (row_j1 > j1) row_j1 = j1;
+        for (int j = row_j0; j <= row_j1; j++) {
+            float dz = (cz - j - 0.5f) * scale;
+            float distance_sq = dx * dx + dz * dz + height * height;
+            if (distance_sq >= LIGHT_RADIUS * LIGHT_RADIUS) continue;
+            float distance = sqrtf(distance_sq);
+            float facing = distance > 0.0f ? (dx * n[0] + height * n[1] + dz * n[2]) / distance : 1.0f;
+            if (facing <= 0.0f) continue;
+            float r2 = distance_sq / (LIGHT_RADIUS * LIGHT_RADIUS);
+            float fade = 1.0f - r2 * r2;
+            float amount = facing * fade * fade / (1.0f + light->linear * distance + light->quadratic * distance_sq);
+            uint64_t* sample = &grid[(i << RAYCAST_LIGHT_SHIFT) + j];
+            *sample = add_light(*sample, light->r * amount, light->g * amount, light->b * amount);
+        }
+    }
+}
+
+// Each surface owns its grid, so the grids are built in parallel.
+static void build_light_grid(int surface) {
+    const RaycastScene* scene = current_scene;
+    uint64_t ambient = pack_light(scene->ambient[0], scene->ambient[1], scene->ambient[2]);
+    uint64_t* grid = light_grids[surface];
+    for (int i = 0; i < RAYCAST_LIGHT_SIDE * RAYCAST_LIGHT_SIDE; i++) grid[i] = ambient;
+    for (int i = 0; i < scene->light_count; i++) splat_light((Surface)surface, &scene->lights[i]);
+}
+
+// Ordered dither, in samples, added to floor and ceiling lookups so the grid does not show as bands.
+static const float light_dither[4][4] = {
+    {0.0f / 16, 8.0f / 16, 2.0f / 16, 10.0f / 16},
+    {12.0f / 16, 4.0f / 16, 14.0f / 16, 6.0f / 16},
+    {3.0f / 16, 11.0f / 16, 1.0f / 16, 9.0f / 16},
+    {15.0f / 16, 7.0f / 16, 13.0f / 16, 5.0f / 16}
+};
+
+static int light_index(float x, float z, float dither_x, float dither_z) {
+    int i = (int)(x * RAYCAST_LIGHT_SUBDIV - light_origin_x + dither_x);
+    int j = (int)(z * RAYCAST_LIGHT_SUBDIV - light_origin_z + dither_z);
+    if (i < 0) i = 0;
+    if (j < 0) j = 0;
+    if (i >= RAYCAST_LIGHT_SIDE) i = RAYCAST_LIGHT_SIDE - 1;
+    if (j >= RAYCAST_LIGHT_SIDE) j = RAYCAST_LIGHT_SIDE - 1;
+    return (i << RAYCAST_LIGHT_SHIFT) + j;
+}
+
+static uint64_t light_bilinear(const uint64_t* grid, float x, float z) {
+    float ci = x * RAYCAST_LIGHT_SUBDIV - light_origin_x - 0.5f;
+    float cj = z * RAYCAST_LIGHT_SUBDIV - light_origin_z - 0.5f;
+    int i = (int)floorf(ci), j = (int)floorf(cj);
+    if (i < 0) i = 0;
+    if (j < 0) j = 0;
+    if (i > RAYCAST_LIGHT_SIDE - 2) i = RAYCAST_LIGHT_SIDE - 2;
+    if (j > RAYCAST_LIGHT_SIDE - 2) j = RAYCAST_LIGHT_SIDE - 2;
+    float fi = ci - i, fj = cj - j;
+    if (fi < 0.0f) fi = 0.0f;
+    if (fi > 1.0f) fi = 1.0f;
+    if (fj < 0.0f) fj = 0.0f;
+    if (fj > 1.0f) fj = 1.0f;
+
+    const uint64_t* s = grid + (i << RAYCAST_LIGHT_SHIFT) + j;
+    uint64_t out = RAYCAST_LIGHT_ALPHA;
+    for (int c = 0; c < 3; c++) {
+        int shift = 16 * c;
+        float a = (float)((s[0] >> shift) & 0xFFFF), b = (float)((s[1] >> shift) & 0xFFFF);
+        float d = (float)((s[RAYCAST_LIGHT_SIDE] >> shift) & 0xFFFF), e = (float)((s[RAYCAST_LIGHT_SIDE + 1] >> shift) & 0xFFFF);
+        float value = (a + (b - a) * fj) * (1.0f - fi) + (d + (e - d) * fj) * fi;
+        out |= (uint64_t)(value + 0.5f) << shift;
+    }
+    return out;
+}
+
+static int mip_level(float texels_per_pixel) {
+    int level = 0;
+    while (texels_per_pixel >= 2.0f && level < RAYCAST_LEVELS - 1) {
+        texels_per_pixel *= 0.5f;
+        level++;
+    }
+    return level;
+}
+
+static uint32_t shade(uint32_t texel, uint64_t light) {
+    uint32_t out = 0;
+    for (int i = 0; i < 4; i++) {
+        uint32_t channel = (texel >> (8 * i)) & 0xFF;
+        uint32_t amount = (uint32_t)(light >> (16 * i)) & 0xFFFF;
+        out |= ((channel * amount) >> 8) << (8 * i);
+    }
+    return out;
+}
+
+#ifdef RAYCAST_SSE2
+// Four texels times four lights, two lights per register, eight 16-bit multiplies at a time.
+static inline __m128i shade4(__m128i texels, __m128i light_lo, __m128i light_hi) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(texels, zero), light_lo), 8);
+    __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(texels, zero), light_hi), 8);
+    return _mm_packus_epi16(lo, hi);
+}
+
+static inline __m128i load_lights2(const uint64_t* grid, int a, int b) {
+    return _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)&grid[a]), _mm_loadl_epi64((const __m128i*)&grid[b]));
+}
+#endif
+
+static bool is_wall(int x, int z) {
+    if (world_is_exit(view.world, x, z)) return view.exit_closed;
+    return world_get(view.world, x, z) == 1;
+}
+
+static void draw_wall_column(int x, int top, int bottom, float distance, float u, uint64_t light) {
+    const RaycastMipmaps* mips = &textures[RAYCAST_TEXTURE_WALL];
+    int level = mip_level(distance / view.focal * RAYCAST_TEXTURE_SIZE);
+    int shift = RAYCAST_TEXTURE_SHIFT - level, size = 1 << shift;
+    const uint32_t* texels = mips->texels + mips->offsets[level];
+    int tu = (int)(u * size) & (size - 1);
+
+    // v runs up the wall; one row down the screen lowers it by dv.
+    float dv = distance / view.focal / view.wall * size;
+    float v = (view.eye - (top + 0.5f - view.horizon) * distance / view.focal) / view.wall * size;
+    uint32_t* out = frame.pixels + (size_t)top * frame.stride + x;
+    int y = top;
+#ifdef RAYCAST_SSE2
+    __m128i light2 = _mm_set1_epi64x((long long)light);
+    for (; y + 4 <= bottom; y += 4) {
+        int tv[4];
+        for (int k = 0; k < 4; k++) {
+            tv[k] = (int)(v - dv * k);
+            if (tv[k] < 0) tv[k] = 0;
+            if (tv[k] >= size) tv[k] = size - 1;
+        }
+        __m128i shaded = shade4(_mm_setr_epi32((int)texels[(tv[0] << shift) + tu], (int)texels[(tv[1] << shift) + tu],
+                                               (int)texels[(tv[2] << shift) + tu], (int)texels[(tv[3] << shift) + tu]),
+                                light2, light2);
+        uint32_t pixels[4];
+        _mm_storeu_si128((__m128i*)pixels, shaded);
+        for (int k = 0; k < 4; k++) {
+            *out = pixels[k];
+            out += frame.stride;
+        }
+        v -= dv * 4;
+    }
+#endif
+    for (; y < bottom; y++) {
+        int tv = (int)v;
+        if (tv < 0) tv = 0;
+        if (tv >= size) tv = size - 1;
+        *out = shade(texels[(tv << shift) + tu], light);
+        out += frame.stride;
+        v -= dv;
+    }
+}
+
+static int clamp_row(float row) {
+    if (row < 0.0f) return 0;
+    if (row > frame.height) return frame.height;
+    return (int)ceilf(row - 0.5f);
+}
+
+static void cast_walls(int x0, int x1) {
+    for (int x = x0; x < x1; x++) {
+        float k = (x + 0.5f - view.center) / view.focal;
+        float ray_x = view.dir_x + view.right_x * k, ray_z = view.dir_z + view.right_z * k;
+        int map_x = (int)floorf(view.x), map_z = (int)floorf(view.z);
+        float delta_x = ray_x != 0.0f ? fabsf(1.0f / ray_x) : 1e30f;
+        float delta_z = ray_z != 0.0f ? fabsf(1.0f / ray_z) : 1e30f;
+        int step_x = ray_x < 0.0f ? -1 : 1, step_z = ray_z < 0.0f ? -1 : 1;
+        float side_x = (ray_x < 0.0f ? view.x - map_x : map_x + 1.0f - view.x) * delta_x;
+        float side_z = (ray_z < 0.0f ? view.z - map_z : map_z + 1.0f - view.z) * delta_z;
+
+        // Rays carry a unit forward component, so the hit parameter is the perpendicular distance.
+        float distance = 0.0f;
+        bool hit = false, x_side = false;
+        for (int step = 0; step < RAYCAST_MAX_STEPS && distance < RAYCAST_MAX_DISTANCE; step++) {
+            if (side_x < side_z) {
+                distance = side_x;
+                side_x += delta_x;
+                map_x += step_x;
+                x_side = true;
+            } else {
+                distance = side_z;
+                side_z += delta_z;
+                map_z += step_z;
+                x_side = false;
+            }
+            if (is_wall(map_x, map_z)) {
+                hit = true;
+                break;
+            }
+        }
+
+        if (!hit) {
+            int horizon = clamp_row(view.horizon);
+            column_top[x] = column_bottom[x] = horizon;
+            column_depth[x] = RAYCAST_MAX_DISTANCE;
+            continue;
+        }
+
+        float hit_x = view.x + ray_x * distance, hit_z = view.z + ray_z * distance;
+        float u;
+        if (x_side) {
+            u = hit_z - floorf(hit_z);
+            if (step_x < 0) u = 1.0f - u;
+        } else {
+            u = hit_x - floorf(hit_x);
+            if (step_z > 0) u = 1.0f - u;
+        }
+
+        int top = clamp_row(view.horizon - (view.wall - view.eye) * view.focal / distance);
+        int bottom = clamp_row(view.horizon + view.eye * view.focal / distance);
+        column_top[x] = top;
+        column_bottom[x] = bottom;
+        column_depth[x] = distance;
+        if (x >= frame.width || top >= bottom) continue;
+
+        // The light sample sits just in front of the face that was hit.
+        Surface face = x_side ? (step_x > 0 ? SURFACE_WALL_NEG_X : SURFACE_WALL_POS_X)
+                              : (step_z > 0 ? SURFACE_WALL_NEG_Z : SURFACE_WALL_POS_Z);
+        float back = distance - 0.01f;
+        uint64_t light = light_bilinear(light_grids[face], view.x + ray_x * back, view.z + ray_z * back);
+        draw_wall_column(x, top, bottom, distance, u, light);
+    }
+}
+
+// Fills the floor or ceiling pixels of row y in [x0, x1) that no wall covers.
+static void draw_plane_row(int y, int x0, int x1, bool is_floor) {
+    float offset = y + 0.5f - view.horizon;
+    float height = is_floor ? view.eye : view.wall - view.eye;
+    float distance = height * view.focal / fabsf(offset);
+    uint32_t* out = frame.pixels + (size_t)y * frame.stride;
+
+    if (distance > RAYCAST_MAX_DISTANCE) {
+        for (int x = x0; x < x1; x++) {
+            if (is_floor ? y >= column_bottom[x] : y < column_top[x]) out[x] = 0xFF000000u;
+        }
+        return;
+    }
+
+    const RaycastMipmaps* mips = &textures[is_floor ? RAYCAST_TEXTURE_FLOOR : RAYCAST_TEXTURE_CEILING];
+    int level = mip_level(distance / view.focal * RAYCAST_TEXTURE_SIZE);
+    int shift = RAYCAST_TEXTURE_SHIFT - level, mask = (1 << shift) - 1;
+    const uint32_t* texels = mips->texels + mips->offsets[level];
+    const uint64_t* grid = light_grids[is_floor ? SURFACE_FLOOR : SURFACE_CEILING];
+    bool hole = is_floor && !view.exit_closed;
+
+    // World position is linear along the row: base + step * column.
+    float step_x = distance * view.right_x / view.focal, step_z = distance * view.right_z / view.focal;
+    float base_x = view.x + distance * view.dir_x + step_x * (0.5f - view.center);
+    float base_z = view.z + distance * view.dir_z + step_z * (0.5f - view.center);
+    float tex_scale = (float)(1 << shift);
+
+    int x = x0;
+#ifdef RAYCAST_SSE2
+    __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    __m128 scale = _mm_set1_ps(tex_scale), subdiv = _mm_set1_ps((float)RAYCAST_LIGHT_SUBDIV);
+    __m128 light_x0 = _mm_set1_ps((float)light_origin_x), light_z0 = _mm_set1_ps((float)light_origin_z);
+    __m128 light_min = _mm_setzero_ps(), light_max = _mm_set1_ps((float)(RAYCAST_LIGHT_SIDE - 1));
+    __m128i tex_mask = _mm_set1_epi32(mask), row = _mm_set1_epi32(y);
+    __m128i exit_x = _mm_set1_epi32(view.world->exit_x), exit_z = _mm_set1_epi32(view.world->exit_z);
+    const float* dither_i = light_dither[y & 3];
+    const float* dither_j = light_dither[(y + 2) & 3];
+    light_x0 = _mm_sub_ps(light_x0, _mm_setr_ps(dither_i[0], dither_i[1], dither_i[2], dither_i[3]));
+    light_z0 = _mm_sub_ps(light_z0, _mm_setr_ps(dither_j[1], dither_j[2], dither_j[3], dither_j[0]));
+    for (; x + 4 <= x1; x += 4) {
+        __m128i limits = _mm_loadu_si128((const __m128i*)(is_floor ? column_bottom + x : column_top + x));
+        __m128i visible = is_floor ? _mm_cmpgt_epi32(_mm_add_epi32(row, _mm_set1_epi32(1)), limits)
+                                   : _mm_cmpgt_epi32(limits, row);
+        if (_mm_movemask_epi8(visible) == 0) continue;
+
+        __m128 column = _mm_add_ps(_mm_set1_ps((float)x), lanes);
+        __m128 px = _mm_add_ps(_mm_set1_ps(base_x), _mm_mul_ps(_mm_set1_ps(step_x), column));
+        __m128 pz = _mm_add_ps(_mm_set1_ps(base_z), _mm_mul_ps(_mm_set1_ps(step_z), column));
+        __m128i tu = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(px, scale)), tex_mask);
+        __m128i tv = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(pz, scale)), tex_mask);
+        __m128i texel_index = _mm_or_si128(_mm_slli_epi32(tv, shift), tu);
+        __m128 li = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(px, subdiv), light_x0), light_min), light_max);
+        __m128 lj = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(pz, subdiv), light_z0), light_min), light_max);
+        __m128i light_index4 = _mm_or_si128(_mm_slli_epi32(_mm_cvttps_epi32(li), RAYCAST_LIGHT_SHIFT), _mm_cvttps_epi32(lj));
+
+        int t[4], l[4];
+        _mm_storeu_si128((__m128i*)t, texel_index);
+        _mm_storeu_si128((__m128i*)l, light_index4);
+        __m128i color = shade4(_mm_setr_epi32((int)texels[t[0]], (int)texels[t[1]], (int)texels[t[2]], (int)texels[t[3]]),
+                               load_lights2(grid, l[0], l[1]), load_lights2(grid, l[2], l[3]));
+        if (hole) {
+            __m128i in_exit = _mm_and_si128(_mm_cmpeq_epi32(_mm_cvttps_epi32(px), exit_x),
+                                            _mm_cmpeq_epi32(_mm_cvttps_epi32(pz), exit_z));
+            color = _mm_or_si128(_mm_andnot_si128(in_exit, color), _mm_and_si128(in_exit, _mm_set1_epi32((int)0xFF000000u)));
+        }
+        __m128i old = _mm_loadu_si128((const __m128i*)(out + x));
+        _mm_storeu_si128((__m128i*)(out + x), _mm_or_si128(_mm_and_si128(visible, color), _mm_andnot_si128(visible, old)));
+    }
+#endif
+    for (; x < x1; x++) {
+        if (is_floor ? y < column_bottom[x] : y >= column_top[x]) continue;
+        float px = base_x + step_x * x, pz = base_z + step_z * x;
+        if (hole && (int)px == view.world->exit_x && (int)pz == view.world->exit_z) {
+            out[x] = 0xFF000000u;
+            continue;
+        }
+        int tu = (int)(px * tex_scale) & mask, tv = (int)(pz * tex_scale) & mask;
+        int sample = light_index(px, pz, light_dither[y & 3][x & 3], light_dither[(y + 2) & 3][(x + 1) & 3]);
+        out[x] = shade(texels[(tv << shift) + tu], grid[sample]);
+    }
+}
+
+static void draw_planes(int x0, int x1) {
+    int max_top = 0, min_bottom = frame.height;
+    for (int x = x0; x < x1; x++) {
+        if (column_top[x] > max_top) max_top = column_top[x];
+        if (column_bottom[x] < min_bottom) min_bottom = column_bottom[x];
+    }
+    for (int y = 0; y < max_top; y++) draw_plane_row(y, x0, x1, false);
+    for (int y = min_bottom; y < frame.height; y++) draw_plane_row(y, x0, x1, true);
+}
+
+static void draw_sprites(int x0, int x1) {
+    if (x1 > frame.width) x1 = frame.width;
+    for (int i = 0; i < sprite_count; i++) {
+        const ProjectedSprite* s = &sprites[i];
+        int sx0 = (int)floorf(s->x - s->size), sx1 = (int)ceilf(s->x + s->size);
+        int sy0 = (int)floorf(s->y - s->size), sy1 = (int)ceilf(s->y + s->size);
+        if (sx0 < x0) sx0 = x0;
+        if (sx1 > x1) sx1 = x1;
+        if (sy0 < 0) sy0 = 0;
+        if (sy1 > frame.height) sy1 = frame.height;
+
+        const RaycastMipmaps* mips = &textures[s->texture];
+        int level = mip_level(RAYCAST_TEXTURE_SIZE / (2.0f * s->size));
+        int shift = RAYCAST_TEXTURE_SHIFT - level, size = 1 << shift;
+        const uint32_t* texels = mips->texels + mips->offsets[level];
+        float inv = 1.0f / (2.0f * s->size);
+        for (int x = sx0; x < sx1; x++) {
+            if (s->depth >= column_depth[x]) continue;
+            float dx = x + 0.5f - s->x;
+            int tu = (int)((dx * inv + 0.5f) * size);
+            if (tu < 0 || tu >= size) continue;
+            for (int y = sy0; y < sy1; y++) {
+                float dy = y + 0.5f - s->y;
+                if (!mips->has_alpha && dx * dx + dy * dy > s->size * s->size) continue;
+                int tv = (int)((0.5f - dy * inv) * size);
+                if (tv < 0 || tv >= size) continue;
+                uint32_t texel = texels[(tv << shift) + tu];
+                if (texel < 0x80000000u) continue;
+                frame.pixels[(size_t)y * frame.stride + x] = shade(texel, s->light) | 0xFF000000u;
+            }
+        }
+    }
+}
+
+static void build_light_grids(int begin, int end, void* user) {
+    (void)user;
+    for (int surface = begin; surface < end; surface++) build_light_grid(surface);
+}
+
+// Stripes next to each other are drawn as one run of columns.
+static void render_stripes(int begin, int end, void* user) {
+    (void)user;
+    int x0 = begin * RAYCAST_STRIPE_WIDTH, x1 = end * RAYCAST_STRIPE_WIDTH;
+    cast_walls(x0, x1);
+    draw_planes(x0, x1);
+    draw_sprites(x0, x1);
+}
+
+static int compare_sprites(const void* a, const void* b) {
+    float da = ((const ProjectedSprite*)a)->depth, db = ((const ProjectedSprite*)b)->depth;
+    return (da < db) - (da > db);
+}
+
+static void project_sprites(const RaycastScene* scene) {
+    sprite_count = 0;
+    for (int i = 0; i < scene->sprite_count && sprite_count < RAYCAST_MAX_SPRITES; i++) {
+        const RaycastSprite* sprite = &scene->sprites[i];
+        float rel_x = sprite->x / CUBE_SIZE - view.x, rel_z = sprite->z / CUBE_SIZE - view.z;
+        float depth = rel_x * view.dir_x + rel_z * view.dir_z;
+        if (depth < 0.05f) continue;
+
+        ProjectedSprite* s = &sprites[sprite_count];
+        s->depth = depth;
+        s->x = view.center + (rel_x * view.right_x + rel_z * view.right_z) / depth * view.focal;
+        s->y = view.horizon - (sprite->y / CUBE_SIZE - view.eye) / depth * view.focal;
+        s->size = sprite->radius / CUBE_SIZE / depth * view.focal;
+        if (s->x + s->size < 0.0f || s->x - s->size > frame.width) continue;
+        s->texture = sprite->texture;
+        s->light = pack_light(sprite->tint[0] + scene->ambient[0], sprite->tint[1] + scene->ambient[1],
+                              sprite->tint[2] + scene->ambient[2]);
+        sprite_count++;
+    }
+    qsort(sprites, sprite_count, sizeof(ProjectedSprite), compare_sprites);
+}
+
+// A y-shear stands in for pitch, the classic raycaster trade-off: walls stay vertical.
+static void setup_view(const RaycastScene* scene) {
+    const Player* p = &scene->view;
+    view.world = scene->world;
+    view.exit_closed = scene->exit_closed;
+    view.x = p->x / CUBE_SIZE;
+    view.z = p->z / CUBE_SIZE;
+    view.wall = WALL_HEIGHT / CUBE_SIZE;
+    view.eye = p->y / CUBE_SIZE;
+    if (view.eye < 0.02f) view.eye = 0.02f;
+    if (view.eye > view.wall - 0.02f) view.eye = view.wall - 0.02f;
+    view.dir_x = cosf(p->angle);
+    view.dir_z = -sinf(p->angle);
+    view.right_x = sinf(p->angle);
+    view.right_z = cosf(p->angle);
+    view.focal = frame.height * 0.5f / tanf(RAYCAST_FOV_Y * 0.5f * (float)PI / 180.0f);
+    view.center = frame.width * 0.5f;
+    view.horizon = frame.height * 0.5f + tanf(p->pitch) * view.focal;
+}
+
+const RaycastFrame* raycast_render(const RaycastScene* scene) {
+    if (!frame.pixels) return NULL;
+    setup_view(scene);
+    project_sprites(scene);
+    current_scene = scene;
+    light_origin_x = (int)floorf(view.x * RAYCAST_LIGHT_SUBDIV) - RAYCAST_LIGHT_SIDE / 2;
+    light_origin_z = (int)floorf(view.z * RAYCAST_LIGHT_SUBDIV) - RAYCAST_LIGHT_SIDE / 2;
+    jobs_parallel_for(SURFACE_COUNT, 1, build_light_grids, NULL);
+    jobs_parallel_for(frame.stride / RAYCAST_STRIPE_WIDTH, 1, render_stripes, NULL);
+    current_scene = NULL;
+    return &frame;
+}
+
+void raycast_cleanup() {
+    for (int i = 0; i < RAYCAST_TEXTURE_COUNT; i++) {
+        free(textures[i].texels);
+        textures[i].texels = NULL;
+    }
+    free(frame.pixels);
+    free(column_top);
+    free(column_bottom);
+    free(column_depth);
+    for (int i = 0; i < SURFACE_COUNT; i++) {
+        free(light_grids[i]);
+        light_grids[i] = NULL;
+    }
+    memset(&frame, 0, sizeof(frame));
+    column_top = column_bottom = NULL;
+    column_depth = NULL;
+}
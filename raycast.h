@@ -0,0 +1,60 @@
+#ifndef RAYCAST_H
+#define RAYCAST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+#include "world.h"
+#include "lights.h"
+
+#define RAYCAST_TEXTURE_SHIFT 8
+#define RAYCAST_TEXTURE_SIZE (1 << RAYCAST_TEXTURE_SHIFT)
+#define RAYCAST_MAX_SPRITES 1024
+
+typedef enum {
+    RAYCAST_TEXTURE_WALL,
+    RAYCAST_TEXTURE_FLOOR,
+    RAYCAST_TEXTURE_CEILING,
+    RAYCAST_TEXTURE_SPHERE,
+    RAYCAST_TEXTURE_DOOR,
+    RAYCAST_TEXTURE_CHASER,
+    RAYCAST_TEXTURE_COUNT
+} RaycastTexture;
+
+// A camera-facing disk standing in for an emissive sphere. Textures with an
+// alpha channel are drawn as a square instead, without the texels below half alpha.
+typedef struct {
+    float x, y, z, radius;
+    RaycastTexture texture;
+    float tint[3];
+} RaycastSprite;
+
+typedef struct {
+    const World* world;
+    Player view;
+    // While true the exit cell is drawn as a wall, otherwise as a hole in the floor.
+    bool exit_closed;
+    float ambient[3];
+    const PointLight* lights;
+    int light_count;
+    const RaycastSprite* sprites;
+    int sprite_count;
+} RaycastScene;
+
+// 0xAARRGGBB pixels, top row first, stride pixels apart.
+typedef struct {
+    uint32_t* pixels;
+    int width, height, stride;
+} RaycastFrame;
+
+// Columns and light grids are split over the jobs pool, which is started if needed.
+bool raycast_init();
+// Loads a BMP resampled to RAYCAST_TEXTURE_SIZE with its mip chain.
+bool raycast_load_texture(RaycastTexture texture, const char* filename);
+// Same for RGBA pixels, bottom row first; the alpha channel is kept.
+bool raycast_load_pixels(RaycastTexture texture, const unsigned char* rgba, int width, int height);
+bool raycast_resize(int width, int height);
+const RaycastFrame* raycast_render(const RaycastScene* scene);
+void raycast_cleanup();
+
+#endif
@@ -1,59 +1,194 @@
 #include <GL/glut.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <stdint.h>
 #include "render.h"
 #include "texture.h"
-#include "player.h"
-
-static GLuint wall_texture_id, floor_texture_id, ceiling_texture_id;
-static GLuint door_texture_id, sphere_texture_id;
-static GLuint menu_bg_texture_id, loser_bg_texture_id;
-static GLuint win_bg_texture_id;
-static GLUquadric* sphere_quadric = NULL;
+#include "pack.h"
+#include "glload.h"
+#include "chunks.h"
+#include "frustum.h"
+#include "gpu_timer.h"
+#include "spheres.h"
+#include "billboards.h"
+#include "lights.h"
+#include "raycast.h"
+#include "glstate.h"
+
+#define MAX_DRAWN_COLLECTIBLES 4096
+#define MAX_SCENE_LIGHTS (MAX_DRAWN_COLLECTIBLES + 1 + LIGHTS_MAX)
+#define MAX_RENDER_COMMANDS (CHUNK_CACHE_SLOTS * 3 + 9)
+
+// Scene draws are queued as commands and submitted sorted by this key, most
+// expensive state change first, so each program, texture and material is set
+// once per frame. The low bits keep the recording order within a group.
+#define COMMAND_KEY(pipeline, texture, material, sequence) \
+    (((uint64_t)(pipeline) << 48) | ((uint64_t)(texture) << 40) | ((uint64_t)(material) << 32) | (uint64_t)(sequence))
+
+typedef enum {
+    PIPELINE_CLUSTERED,
+    PIPELINE_UNLIT,
+    PIPELINE_FIXED
+} Pipeline;
+
+typedef enum {
+    MATERIAL_MATTE,
+    MATERIAL_COLLECTIBLE,
+    MATERIAL_EXIT,
+    MATERIAL_COUNT
+} MaterialId;
+
+typedef enum {
+    COMMAND_CHUNK_MESH,
+    COMMAND_EXIT_CUBE,
+    COMMAND_EXIT_HOLE,
+    COMMAND_SPHERES,
+    COMMAND_BILLBOARDS
+} CommandType;
+
+typedef struct {
+    uint64_t key;
+    CommandType type;
+    ProfilePhase phase;
+    const RenderChunk* chunk;
+    const Mesh* mesh;
+    const SphereInstance* spheres;
+    int sphere_count;
+    const BillboardInstance* billboards;
+    int billboard_count;
+    GLfloat color[3];
+} RenderCommand;
+
+static const GlMaterial materials[MATERIAL_COUNT] = {
+    {{0.1, 0.1, 0.1, 1.0}, 10.0, {0.0, 0.0, 0.0, 1.0}},
+    {{1.0, 1.0, 1.0, 1.0}, 128.0, {1.0, 0.1, 0.1, 1.0}},
+    {{0.1, 0.1, 0.1, 1.0}, 10.0, {1.0, 0.5, 0.5, 1.0}}
+};
+
+static const char* texture_files[RENDER_TEXTURE_COUNT] = {
+    "textures/wall4.bmp",
+    "textures/floor.bmp",
+    "textures/ceiling.bmp",
+    "textures/door4.bmp",
+    "textures/sphere2.bmp",
+    "textures/menu_bg.bmp",
+    "textures/loser_bg.bmp",
+    "textures/win_bg.bmp"
+};
+static TextureHandle textures[RENDER_TEXTURE_COUNT];
+static bool textures_held[RENDER_TEXTURE_COUNT];
+static int view_cell_x, view_cell_z;
+static const PvsChunk* view_pvs = NULL;
+static Player camera;
+static int draw_calls = 0;
+static Lightmap level_lightmap;
 
 static GLfloat base_global_ambient[] = {0.08, 0.08, 0.06, 1.0};
 static GLfloat current_global_ambient[] = {0.08, 0.08, 0.06, 1.0};
 
-static void draw_maze(const int maze[MAZE_WIDTH][MAZE_HEIGHT], GameState state);
-static void draw_ceiling_and_floor(const int maze[MAZE_WIDTH][MAZE_HEIGHT], GameState state);
-static void draw_exit_hole();
-static void draw_collectibles(const int maze[MAZE_WIDTH][MAZE_HEIGHT]);
-static void draw_exit_sphere(GameState state);
-static void draw_textured_cube(GLuint texture_id);
+static const PointLight sphere_light = {0.0f, 0.0f, 0.0f, 1.0f, 0.1f, 0.1f, 0.8f, 0.3f};
+static const PointLight exit_light = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.7f, 0.2f};
+static const PointLight* extra_lights = NULL;
+static int extra_light_count = 0;
+static PointLight scene_lights[MAX_SCENE_LIGHTS];
+
+static const char* backend_names[RENDER_BACKEND_COUNT] = {"gl", "raycast"};
+static RenderBackend backend = RENDER_BACKEND_GL;
+static GLuint frame_texture = 0;
+static int frame_texture_width = 0, frame_texture_height = 0;
+static int window_width = 0, window_height = 0;
+static RenderCommand commands[MAX_RENDER_COMMANDS];
+static int command_count = 0;
+static const BillboardInstance* chasers = NULL;
+static int chaser_count = 0;
+static BillboardInstance* visible_chasers = NULL;
+static int visible_chaser_capacity = 0;
+
+static void queue_maze(const World* world, GameState state);
+static void queue_ceiling_and_floor();
+static void queue_collectibles(const CollectibleIndex* collectibles, float t);
+static void queue_exit_sphere(const World* world, GameState state, float t);
+static void queue_chasers();
+static void submit_commands(const World* world);
+static void draw_exit_hole(const World* world);
+static void draw_textured_cube();
 static void setup_lighting();
-static void lighting_update_dynamic(const int maze[MAZE_WIDTH][MAZE_HEIGHT], GameState state);
+static void update_visibility(const World* world);
+static bool is_cell_in_view(int x, int z, float min_y, float max_y);
+static void lighting_update_dynamic(const World* world, const CollectibleIndex* collectibles, GameState state, float t);
+static bool raycast_setup();
+static void render_scene_raycast(const World* world, const CollectibleIndex* collectibles, GameState state, float t);
+static int collect_point_lights(const World* world, const CollectibleIndex* collectibles, GameState state, float t);
+
+void render_set_backend(RenderBackend new_backend) {
+    backend = new_backend;
+}
+
+RenderBackend render_get_backend() {
+    return backend;
+}
+
+bool render_parse_backend(const char* name, RenderBackend* parsed) {
+    for (int i = 0; i < RENDER_BACKEND_COUNT; i++) {
+        if (strcmp(name, backend_names[i]) == 0) {
+            *parsed = (RenderBackend)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* render_backend_name(RenderBackend value) {
+    return value < RENDER_BACKEND_COUNT ? backend_names[value] : "?";
+}
 
 bool render_init() {
+    window_width = glutGet(GLUT_WINDOW_WIDTH);
+    window_height = glutGet(GLUT_WINDOW_HEIGHT);
     glClearColor(0.0, 0.0, 0.0, 1.0);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_BLEND);
+    glstate_set(GLSTATE_DEPTH_TEST, true);
+    glstate_set(GLSTATE_BLEND, true);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glEnable(GL_TEXTURE_2D);
-
-    wall_texture_id = load_texture_bmp("textures/wall4.bmp");
-    floor_texture_id = load_texture_bmp("textures/floor.bmp");
-    ceiling_texture_id = load_texture_bmp("textures/ceiling.bmp");
-    door_texture_id = load_texture_bmp("textures/door4.bmp");
-    sphere_texture_id = load_texture_bmp("textures/sphere2.bmp");
-    menu_bg_texture_id = load_texture_bmp("textures/menu_bg.bmp");
-    loser_bg_texture_id = load_texture_bmp("textures/loser_bg.bmp");
-    win_bg_texture_id = load_texture_bmp("textures/win_bg.bmp");
-
-    if (wall_texture_id==0 || floor_texture_id==0 || ceiling_texture_id==0 ||
-        door_texture_id==0 || sphere_texture_id==0 || menu_bg_texture_id==0 ||
-        loser_bg_texture_id == 0 || win_bg_texture_id == 0) {
-        return false;
+    glstate_set(GLSTATE_TEXTURE_2D, true);
+
+    if (!glload_init()) return false;
+    gpu_timer_init();
+
+    texture_archive_open(PACK_TEXTURE_ARCHIVE, "textures");
+    if (!texture_stream_init()) return false;
+
+    for (int i = 0; i < RENDER_TEXTURE_COUNT; i++) {
+        textures[i] = texture_register(texture_files[i]);
+        textures_held[i] = false;
+        if (textures[i] == TEXTURE_INVALID) return false;
     }
 
-    sphere_quadric = gluNewQuadric();
-    gluQuadricTexture(sphere_quadric, GL_TRUE);
+    if (!spheres_init()) return false;
+    if (!billboards_init()) return false;
+    lights_init();
+    if (backend == RENDER_BACKEND_RAYCAST && !raycast_setup()) return false;
 
     setup_lighting();
+    // Initialization above binds textures directly.
+    glstate_invalidate();
     return true;
 }
 
+void render_load_level(const World* world) {
+    if (backend == RENDER_BACKEND_RAYCAST) return;
+    lightmap_free(&level_lightmap);
+    if (lights_available()) lightmap_load_or_bake(&level_lightmap, world, LIGHTMAP_CACHE_DIRECTORY);
+    chunks_init(world, level_lightmap.texels ? &level_lightmap : NULL);
+    chunks_update(world, world->start_x, world->start_z, true);
+    chunks_print_stats();
+}
+
 void render_start_frame() {
+    draw_calls = 0;
+    glstate_begin_frame();
+    texture_stream_update(TEXTURE_STREAM_BUDGET_MS);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glLightModelfv(GL_LIGHT_MODEL_AMBIENT, current_global_ambient);
     glMatrixMode(GL_MODELVIEW);
@@ -61,11 +196,20 @@ void render_start_frame() {
 }
 
 void render_end_frame() {
+    profiler_begin(PROFILE_SWAP);
     glutSwapBuffers();
+    profiler_end(PROFILE_SWAP);
+    gpu_timer_end_frame();
+    profiler_end_frame();
 }
 
-void render_scene(const int maze[MAZE_WIDTH][MAZE_HEIGHT], GameState state) {
-    const Player* p = player_get();
+void render_scene(const World* world, const CollectibleIndex* collectibles, const Player* view, GameState state, float time) {
+    camera = *view;
+    if (backend == RENDER_BACKEND_RAYCAST) {
+        render_scene_raycast(world, collectibles, state, time);
+        return;
+    }
+    const Player* p = &camera;
 
     float look_horizontal_dist = cos(p->pitch);
     float look_x = p->x + cos(p->angle) * look_horizontal_dist;
@@ -74,50 +218,88 @@ void render_scene(const int maze[MAZE_WIDTH][MAZE_HEIGHT], GameState state) {
 
     gluLookAt(p->x, p->y, p->z, look_x, look_y, look_z, 0.0, 1.0, 0.0);
 
-    lighting_update_dynamic(maze, state);
-
-    draw_ceiling_and_floor(maze, state);
-    draw_maze(maze, state);
-
-    glBindTexture(GL_TEXTURE_2D, 0);
-    draw_collectibles(maze);
-    draw_exit_sphere(state);
+    chunks_update(world, p->x, p->z, false);
+    update_visibility(world);
+    gpu_timer_begin(PROFILE_LIGHTING);
+    lighting_update_dynamic(world, collectibles, state, time);
+    gpu_timer_end(PROFILE_LIGHTING);
+
+    command_count = 0;
+    queue_ceiling_and_floor();
+    queue_maze(world, state);
+    queue_collectibles(collectibles, time);
+    queue_exit_sphere(world, state, time);
+    queue_chasers();
+    submit_commands(world);
 }
 
 void render_reshape(int w, int h) {
     if (h == 0) h = 1;
+    window_width = w;
+    window_height = h;
     glViewport(0, 0, w, h);
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
     gluPerspective(45.0, (float)w / h, 0.1, 100.0);
+    if (backend == RENDER_BACKEND_RAYCAST) raycast_resize(w, h);
 }
 
 void render_cleanup() {
-    if (sphere_quadric) {
-        gluDeleteQuadric(sphere_quadric);
-    }
+    texture_stream_shutdown();
+    lights_cleanup();
+    gpu_timer_cleanup();
+    chunks_cleanup();
+    lightmap_free(&level_lightmap);
+    spheres_cleanup();
+    billboards_cleanup();
+    free(visible_chasers);
+    visible_chasers = NULL;
+    visible_chaser_capacity = 0;
+    raycast_cleanup();
+    if (frame_texture) glDeleteTextures(1, &frame_texture);
+    frame_texture = 0;
 }
 
 void render_update_ambient_light(int eaten, int total, GameState state) {
     float max_progressive_red = 0.3f;
     float final_red_boost = 0.35f;
 
-    memcpy(current_global_ambient, base_global_ambient, sizeof(base_global_ambient));
+    float red_boost = 0.0f;
 
     if (total > 0) {
-        float red_increase = (float)eaten / (float)total * max_progressive_red;
-        current_global_ambient[0] += red_increase;
+        red_boost += (float)eaten / (float)total * max_progressive_red;
     }
 
     if (state == STATE_ESCAPING || state == STATE_WON || state == STATE_LOST) {
-        current_global_ambient[0] += final_red_boost;
+        red_boost += final_red_boost;
     }
 
+    memcpy(current_global_ambient, base_global_ambient, sizeof(base_global_ambient));
+    current_global_ambient[0] += red_boost;
     if (current_global_ambient[0] > 1.0f) current_global_ambient[0] = 1.0f;
+    lights_set_ambient(base_global_ambient, red_boost);
+}
+
+void render_set_chasers(const BillboardInstance* instances, int count) {
+    chasers = instances;
+    chaser_count = count;
+}
+
+void render_set_extra_lights(const PointLight* lights, int count) {
+    extra_lights = lights;
+    extra_light_count = count;
+}
+
+int render_window_width() {
+    return window_width;
+}
+
+int render_window_height() {
+    return window_height;
 }
 
 static void setup_lighting() {
-    glEnable(GL_LIGHTING);
+    glstate_set(GLSTATE_LIGHTING, true);
     glEnable(GL_COLOR_MATERIAL);
     glColorMaterial(GL_FRONT, GL_AMBIENT_AND_DIFFUSE);
 
@@ -125,125 +307,333 @@ static void setup_lighting() {
 
     glDisable(GL_LIGHT0);
 
-    glEnable(GL_LIGHT1);
-    GLfloat sphere_diffuse[] = {1.0, 0.1, 0.1, 1.0};
+    glstate_set(GLSTATE_LIGHT1, true);
+    GLfloat sphere_diffuse[] = {sphere_light.r, sphere_light.g, sphere_light.b, 1.0};
     glLightfv(GL_LIGHT1, GL_DIFFUSE, sphere_diffuse);
     glLightf(GL_LIGHT1, GL_CONSTANT_ATTENUATION, 1.0f);
-    glLightf(GL_LIGHT1, GL_LINEAR_ATTENUATION, 0.8f);
-    glLightf(GL_LIGHT1, GL_QUADRATIC_ATTENUATION, 0.3f);
+    glLightf(GL_LIGHT1, GL_LINEAR_ATTENUATION, sphere_light.linear);
+    glLightf(GL_LIGHT1, GL_QUADRATIC_ATTENUATION, sphere_light.quadratic);
 
-    glEnable(GL_LIGHT2);
-    GLfloat exit_light_diffuse[] = {1.0, 0.0, 0.0, 1.0};
+    glstate_set(GLSTATE_LIGHT2, true);
+    GLfloat exit_light_diffuse[] = {exit_light.r, exit_light.g, exit_light.b, 1.0};
     glLightfv(GL_LIGHT2, GL_DIFFUSE, exit_light_diffuse);
     glLightf(GL_LIGHT2, GL_CONSTANT_ATTENUATION, 1.0f);
-    glLightf(GL_LIGHT2, GL_LINEAR_ATTENUATION, 0.7f);
-    glLightf(GL_LIGHT2, GL_QUADRATIC_ATTENUATION, 0.2f);
+    glLightf(GL_LIGHT2, GL_LINEAR_ATTENUATION, exit_light.linear);
+    glLightf(GL_LIGHT2, GL_QUADRATIC_ATTENUATION, exit_light.quadratic);
 }
 
-static void lighting_update_dynamic(const int maze[MAZE_WIDTH][MAZE_HEIGHT], GameState state) {
-    const Player* p = player_get();
+static void mark_cell_visible(int x, int z) {
+    RenderChunk* chunk = chunks_get(x >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+    if (!chunk) return;
+    int bx = (x & CHUNK_MASK) / MESH_BLOCK_SIZE;
+    int bz = (z & CHUNK_MASK) / MESH_BLOCK_SIZE;
+    chunk->block_visible[bx * chunk->walls.blocks_z + bz] = true;
+}
 
-    float min_dist_sq = -1.0f;
-    float closest_sphere_pos[4] = {0,0,0,1};
-    bool found_sphere = false;
-    for (int x = 0; x < MAZE_WIDTH; x++) {
-        for (int z = 0; z < MAZE_HEIGHT; z++) {
-            if (maze[x][z] == 2) {
-                float sx = x * CUBE_SIZE + 0.5f;
-                float sz = z * CUBE_SIZE + 0.5f;
-                float dist_sq = (p->x - sx) * (p->x - sx) + (p->z - sz) * (p->z - sz);
-                if (!found_sphere || dist_sq < min_dist_sq) {
-                    min_dist_sq = dist_sq;
-                    closest_sphere_pos[0] = sx;
-                    closest_sphere_pos[1] = 0.5f;
-                    closest_sphere_pos[2] = sz;
-                    found_sphere = true;
+static void update_visibility(const World* world) {
+    const Player* p = &camera;
+    frustum_update();
+
+    view_cell_x = (int)(p->x / CUBE_SIZE);
+    view_cell_z = (int)(p->z / CUBE_SIZE);
+    view_pvs = NULL;
+
+    RenderChunk* current = chunks_get(view_cell_x >> CHUNK_SHIFT, view_cell_z >> CHUNK_SHIFT);
+    if (current && world_get(world, view_cell_x, view_cell_z) != 1) {
+        if (!pvs_cell_ready(&current->pvs, view_cell_x, view_cell_z)) {
+            pvs_compute_cell(&current->pvs, world, view_cell_x, view_cell_z);
+        }
+        view_pvs = &current->pvs;
+    }
+
+    for (int i = 0; i < CHUNK_CACHE_SLOTS; i++) {
+        RenderChunk* chunk = chunks_slot(i);
+        if (!chunk) continue;
+        for (int b = 0; b < CHUNK_BLOCKS * CHUNK_BLOCKS; b++) {
+            chunk->block_visible[b] = view_pvs == NULL;
+        }
+    }
+
+    if (view_pvs) {
+        for (int x = view_cell_x - PVS_RADIUS; x <= view_cell_x + PVS_RADIUS; x++) {
+            for (int z = view_cell_z - PVS_RADIUS; z <= view_cell_z + PVS_RADIUS; z++) {
+                if (world_in_bounds(world, x, z) && pvs_is_visible(view_pvs, view_cell_x, view_cell_z, x, z)) {
+                    mark_cell_visible(x, z);
                 }
             }
         }
     }
+
+    for (int i = 0; i < CHUNK_CACHE_SLOTS; i++) {
+        RenderChunk* chunk = chunks_slot(i);
+        if (!chunk) continue;
+        for (int bx = 0; bx < chunk->walls.blocks_x; bx++) {
+            for (int bz = 0; bz < chunk->walls.blocks_z; bz++) {
+                bool* visible = &chunk->block_visible[bx * chunk->walls.blocks_z + bz];
+                if (!*visible) continue;
+                float x0 = ((chunk->cx << CHUNK_SHIFT) + bx * MESH_BLOCK_SIZE) * CUBE_SIZE;
+                float z0 = ((chunk->cz << CHUNK_SHIFT) + bz * MESH_BLOCK_SIZE) * CUBE_SIZE;
+                float x1 = x0 + MESH_BLOCK_SIZE * CUBE_SIZE, z1 = z0 + MESH_BLOCK_SIZE * CUBE_SIZE;
+                *visible = frustum_test_box(x0, 0.0f, z0, x1, WALL_HEIGHT, z1);
+            }
+        }
+    }
+}
+
+static bool is_cell_in_view(int x, int z, float min_y, float max_y) {
+    if (view_pvs && !pvs_is_visible(view_pvs, view_cell_x, view_cell_z, x, z)) return false;
+    return frustum_test_box(x * CUBE_SIZE, min_y, z * CUBE_SIZE, (x + 1) * CUBE_SIZE, max_y, (z + 1) * CUBE_SIZE);
+}
+
+static void lighting_update_dynamic(const World* world, const CollectibleIndex* collectibles, GameState state, float t) {
+    const Player* p = &camera;
+
+    int nearest;
+    bool found_sphere = collectibles_nearest(collectibles, p->x, p->z, PVS_RADIUS * CUBE_SIZE, 1, &nearest) > 0;
+    float closest_sphere_pos[4] = {0,0,0,1};
+    if (found_sphere) {
+        closest_sphere_pos[0] = collectibles->items[nearest].x;
+        closest_sphere_pos[1] = 0.5f;
+        closest_sphere_pos[2] = collectibles->items[nearest].z;
+    }
     if(found_sphere){
-        glEnable(GL_LIGHT1);
+        glstate_set(GLSTATE_LIGHT1, true);
         glLightfv(GL_LIGHT1, GL_POSITION, closest_sphere_pos);
     } else {
-        glDisable(GL_LIGHT1);
+        glstate_set(GLSTATE_LIGHT1, false);
     }
 
-    if (state == STATE_ESCAPING || state == STATE_WON || state == STATE_LOST) {
-        glEnable(GL_LIGHT2);
-        float t = glutGet(GLUT_ELAPSED_TIME) / 1000.0f;
-        float y_offset = 0.5f + sin(t * 2.0f + 13 + 13) * 0.1f;
-        GLfloat exit_light_pos[] = {13.5f * CUBE_SIZE, y_offset, 13.5f * CUBE_SIZE, 1.0f};
+    bool exit_open = state == STATE_ESCAPING || state == STATE_WON || state == STATE_LOST;
+    if (exit_open) {
+        glstate_set(GLSTATE_LIGHT2, true);
+        float y_offset = 0.5f + sin(t * 2.0f + world->exit_x + world->exit_z) * 0.1f;
+        GLfloat exit_light_pos[] = {(world->exit_x + 0.5f) * CUBE_SIZE, y_offset, (world->exit_z + 0.5f) * CUBE_SIZE, 1.0f};
         glLightfv(GL_LIGHT2, GL_POSITION, exit_light_pos);
     } else {
-        glDisable(GL_LIGHT2);
-    }
-}
-
-static void draw_maze(const int maze[MAZE_WIDTH][MAZE_HEIGHT], GameState state) {
-    glBindTexture(GL_TEXTURE_2D, wall_texture_id);
-    GLfloat wall_specular[] = {0.1, 0.1, 0.1, 1.0};
-    GLfloat wall_shininess[] = {10.0};
-    glMaterialfv(GL_FRONT, GL_SPECULAR, wall_specular);
-    glMaterialfv(GL_FRONT, GL_SHININESS, wall_shininess);
-
-    for(int x = 0; x < MAZE_WIDTH; x++){
-        for(int z = 0; z < MAZE_HEIGHT; z++){
-            if(maze[x][z] == 1 || (x == 13 && z == 13 && state == STATE_PLAYING)){
-                glPushMatrix();
-                glTranslatef(x * CUBE_SIZE + 0.5f, WALL_HEIGHT / 2.0f, z * CUBE_SIZE + 0.5f);
-                glScalef(CUBE_SIZE, WALL_HEIGHT, CUBE_SIZE);
-                glColor3f(1.0, 1.0, 1.0);
-                draw_textured_cube(wall_texture_id);
-                glPopMatrix();
-            }
-        }
+        glstate_set(GLSTATE_LIGHT2, false);
     }
+
+    if (!lights_available()) return;
+
+    // The fixed-function lights above still light the spheres; walls, floor and
+    // ceiling get every collectible as a light of its own.
+    lights_begin_frame(p->x, p->z);
+    int count = collect_point_lights(world, collectibles, state, t);
+    for (int i = 0; i < count; i++) lights_add(&scene_lights[i]);
+    lights_build();
 }
 
-static void draw_ceiling_and_floor(const int maze[MAZE_WIDTH][MAZE_HEIGHT], GameState state) {
-    GLfloat mat_specular[] = {0.1, 0.1, 0.1, 1.0};
-    GLfloat mat_shininess[] = {10.0};
-    glMaterialfv(GL_FRONT, GL_SPECULAR, mat_specular);
-    glMaterialfv(GL_FRONT, GL_SHININESS, mat_shininess);
+// One light per nearby collectible, the exit once it opens and the extra lights.
+static int collect_point_lights(const World* world, const CollectibleIndex* collectibles, GameState state, float t) {
+    static int nearby[MAX_DRAWN_COLLECTIBLES];
+    int count = collectibles_in_radius(collectibles, camera.x, camera.z, PVS_RADIUS * CUBE_SIZE, nearby, MAX_DRAWN_COLLECTIBLES);
+    for (int i = 0; i < count; i++) {
+        const Collectible* item = &collectibles->items[nearby[i]];
+        PointLight* light = &scene_lights[i];
+        *light = sphere_light;
+        light->x = item->x;
+        light->y = 0.5f + sin(t * 2.0f + item->cell_x + item->cell_z) * 0.1f;
+        light->z = item->z;
+    }
+    if (state == STATE_ESCAPING || state == STATE_WON || state == STATE_LOST) {
+        PointLight* light = &scene_lights[count++];
+        *light = exit_light;
+        light->x = (world->exit_x + 0.5f) * CUBE_SIZE;
+        light->y = 0.5f + sin(t * 2.0f + world->exit_x + world->exit_z) * 0.1f;
+        light->z = (world->exit_z + 0.5f) * CUBE_SIZE;
+    }
+    for (int i = 0; i < extra_light_count && count < MAX_SCENE_LIGHTS; i++) scene_lights[count++] = extra_lights[i];
+    return count;
+}
 
-    glBindTexture(GL_TEXTURE_2D, ceiling_texture_id);
-    glColor3f(1.0, 1.0, 1.0);
-    glBegin(GL_QUADS);
-        glNormal3f(0, -1, 0);
-        glTexCoord2f(0.0, 0.0); glVertex3f(0, WALL_HEIGHT, 0);
-        glTexCoord2f(MAZE_WIDTH, 0.0); glVertex3f(MAZE_WIDTH * CUBE_SIZE, WALL_HEIGHT, 0);
-        glTexCoord2f(MAZE_WIDTH, MAZE_HEIGHT); glVertex3f(MAZE_WIDTH * CUBE_SIZE, WALL_HEIGHT, MAZE_HEIGHT * CUBE_SIZE);
-        glTexCoord2f(0.0, MAZE_HEIGHT); glVertex3f(0, WALL_HEIGHT, MAZE_HEIGHT * CUBE_SIZE);
-    glEnd();
+static RenderCommand* queue_command(CommandType type, Pipeline pipeline, RenderTexture texture, MaterialId material,
+                                    ProfilePhase phase) {
+    if (command_count == MAX_RENDER_COMMANDS) return NULL;
+    RenderCommand* command = &commands[command_count];
+    memset(command, 0, sizeof(*command));
+    command->key = COMMAND_KEY(pipeline, texture, material, command_count);
+    command->type = type;
+    command->phase = phase;
+    command->color[0] = command->color[1] = command->color[2] = 1.0f;
+    command_count++;
+    return command;
+}
 
-    glBindTexture(GL_TEXTURE_2D, floor_texture_id);
-    glColor3f(1.0, 1.0, 1.0);
-    glBegin(GL_QUADS);
-    for (int x = 0; x < MAZE_WIDTH; x++) {
-        for (int z = 0; z < MAZE_HEIGHT; z++) {
-            if (x == 13 && z == 13) continue;
-            glNormal3f(0, 1, 0);
-            glTexCoord2f(0.0, 0.0); glVertex3f(x * CUBE_SIZE, 0, z * CUBE_SIZE);
-            glTexCoord2f(0.0, 1.0); glVertex3f(x * CUBE_SIZE, 0, (z + 1) * CUBE_SIZE);
-            glTexCoord2f(1.0, 1.0); glVertex3f((x + 1) * CUBE_SIZE, 0, (z + 1) * CUBE_SIZE);
-            glTexCoord2f(1.0, 0.0); glVertex3f((x + 1) * CUBE_SIZE, 0, z * CUBE_SIZE);
-        }
+static void queue_chunk_mesh(const RenderChunk* chunk, const Mesh* mesh, RenderTexture texture, ProfilePhase phase) {
+    RenderCommand* command = queue_command(COMMAND_CHUNK_MESH, PIPELINE_CLUSTERED, texture, MATERIAL_MATTE, phase);
+    if (!command) return;
+    command->chunk = chunk;
+    command->mesh = mesh;
+}
+
+static void queue_maze(const World* world, GameState state) {
+    for (int i = 0; i < CHUNK_CACHE_SLOTS; i++) {
+        RenderChunk* chunk = chunks_slot(i);
+        if (chunk) queue_chunk_mesh(chunk, &chunk->walls, RENDER_TEXTURE_WALL, PROFILE_MAZE);
     }
-    glEnd();
 
+    if (state == STATE_PLAYING && is_cell_in_view(world->exit_x, world->exit_z, 0.0f, WALL_HEIGHT)) {
+        queue_command(COMMAND_EXIT_CUBE, PIPELINE_CLUSTERED, RENDER_TEXTURE_WALL, MATERIAL_MATTE, PROFILE_MAZE);
+    }
     if (state != STATE_PLAYING) {
-        draw_exit_hole();
+        // Untextured, so RENDER_TEXTURE_COUNT stands for no texture.
+        RenderCommand* hole = queue_command(COMMAND_EXIT_HOLE, PIPELINE_UNLIT, RENDER_TEXTURE_COUNT, MATERIAL_MATTE,
+                                            PROFILE_FLOOR_CEILING);
+        if (hole) hole->color[0] = hole->color[1] = hole->color[2] = 0.0f;
     }
 }
 
-static void draw_exit_hole() {
-    float x = 13.0f, z = 13.0f;
-    float hole_depth = -20.0f;
+static void queue_ceiling_and_floor() {
+    for (int i = 0; i < CHUNK_CACHE_SLOTS; i++) {
+        RenderChunk* chunk = chunks_slot(i);
+        if (chunk) queue_chunk_mesh(chunk, &chunk->ceiling, RENDER_TEXTURE_CEILING, PROFILE_FLOOR_CEILING);
+    }
+    for (int i = 0; i < CHUNK_CACHE_SLOTS; i++) {
+        RenderChunk* chunk = chunks_slot(i);
+        if (chunk) queue_chunk_mesh(chunk, &chunk->floor, RENDER_TEXTURE_FLOOR, PROFILE_FLOOR_CEILING);
+    }
+}
+
+static void queue_collectibles(const CollectibleIndex* collectibles, float t) {
+    static int nearby[MAX_DRAWN_COLLECTIBLES];
+    static SphereInstance instances[MAX_DRAWN_COLLECTIBLES];
+    int count = collectibles_in_radius(collectibles, camera.x, camera.z, PVS_RADIUS * CUBE_SIZE, nearby, MAX_DRAWN_COLLECTIBLES);
+    int visible = 0;
+    for (int i = 0; i < count; i++) {
+        const Collectible* item = &collectibles->items[nearby[i]];
+        if (!is_cell_in_view(item->cell_x, item->cell_z, 0.0f, 1.0f)) continue;
+
+        SphereInstance* sphere = &instances[visible++];
+        sphere->x = item->x;
+        sphere->y = 0.5f + sin(t * 2.0f + item->cell_x + item->cell_z) * 0.1f;
+        sphere->z = item->z;
+        sphere->radius = 0.12f;
+    }
+    if (visible == 0) return;
+
+    RenderCommand* command = queue_command(COMMAND_SPHERES, PIPELINE_FIXED, RENDER_TEXTURE_SPHERE, MATERIAL_COLLECTIBLE,
+                                           PROFILE_COLLECTIBLES);
+    if (!command) return;
+    command->spheres = instances;
+    command->sphere_count = visible;
+}
+
+static void queue_exit_sphere(const World* world, GameState state, float t) {
+    if (state != STATE_ESCAPING && state != STATE_WON && state != STATE_LOST) {
+        return;
+    }
+
+    static SphereInstance sphere;
+    sphere.x = (world->exit_x + 0.5f) * CUBE_SIZE;
+    sphere.y = 0.5f + sin(t * 2.0f + world->exit_x + world->exit_z) * 0.1f;
+    sphere.z = (world->exit_z + 0.5f) * CUBE_SIZE;
+    sphere.radius = 0.15f;
+
+    RenderCommand* command = queue_command(COMMAND_SPHERES, PIPELINE_FIXED, RENDER_TEXTURE_DOOR, MATERIAL_EXIT,
+                                           PROFILE_COLLECTIBLES);
+    if (!command) return;
+    command->spheres = &sphere;
+    command->sphere_count = 1;
+    command->color[0] = 0.9f;
+    command->color[1] = command->color[2] = 0.5f;
+}
+
+static void queue_chasers() {
+    if (chaser_count == 0) return;
+    if (chaser_count > visible_chaser_capacity) {
+        BillboardInstance* grown = realloc(visible_chasers, chaser_count * sizeof(BillboardInstance));
+        if (!grown) return;
+        visible_chasers = grown;
+        visible_chaser_capacity = chaser_count;
+    }
+
+    float radius_sq = PVS_RADIUS * CUBE_SIZE * PVS_RADIUS * CUBE_SIZE;
+    int visible = 0;
+    for (int i = 0; i < chaser_count; i++) {
+        const BillboardInstance* b = &chasers[i];
+        float dx = b->x - camera.x, dz = b->z - camera.z;
+        if (dx * dx + dz * dz > radius_sq) continue;
+        if (!is_cell_in_view((int)(b->x / CUBE_SIZE), (int)(b->z / CUBE_SIZE), 0.0f, b->y + b->size)) continue;
+        visible_chasers[visible++] = *b;
+    }
+    if (visible == 0) return;
+
+    // The billboards bind their own texture.
+    RenderCommand* command = queue_command(COMMAND_BILLBOARDS, PIPELINE_FIXED, RENDER_TEXTURE_COUNT, MATERIAL_MATTE,
+                                           PROFILE_BILLBOARDS);
+    if (!command) return;
+    command->billboards = visible_chasers;
+    command->billboard_count = visible;
+}
+
+static void set_pipeline(Pipeline pipeline) {
+    if (pipeline == PIPELINE_CLUSTERED) lights_bind();
+    else lights_unbind();
+    glstate_set(GLSTATE_LIGHTING, pipeline != PIPELINE_UNLIT);
+    glstate_set(GLSTATE_TEXTURE_2D, pipeline != PIPELINE_UNLIT);
+}
+
+static void execute_command(const World* world, const RenderCommand* command) {
+    switch (command->type) {
+        case COMMAND_CHUNK_MESH:
+            lights_set_lightmap(command->chunk->lightmap, command->chunk->cx * CHUNK_SIZE, command->chunk->cz * CHUNK_SIZE);
+            draw_calls += mesh_draw_blocks(command->mesh, command->chunk->block_visible);
+            break;
+        case COMMAND_EXIT_CUBE:
+            glPushMatrix();
+            glTranslatef(world->exit_x * CUBE_SIZE + 0.5f, WALL_HEIGHT / 2.0f, world->exit_z * CUBE_SIZE + 0.5f);
+            glScalef(CUBE_SIZE, WALL_HEIGHT, CUBE_SIZE);
+            lights_set_lightmap(0, 0, 0);
+            draw_textured_cube();
+            glPopMatrix();
+            draw_calls++;
+            break;
+        case COMMAND_EXIT_HOLE:
+            draw_exit_hole(world);
+            break;
+        case COMMAND_SPHERES:
+            draw_calls += spheres_draw(command->spheres, command->sphere_count, camera.x, camera.y, camera.z);
+            break;
+        case COMMAND_BILLBOARDS:
+            draw_calls += billboards_draw(command->billboards, command->billboard_count);
+            break;
+    }
+}
+
+static int compare_commands(const void* a, const void* b) {
+    uint64_t key_a = ((const RenderCommand*)a)->key, key_b = ((const RenderCommand*)b)->key;
+    return key_a < key_b ? -1 : key_a > key_b;
+}
+
+static void submit_commands(const World* world) {
+    qsort(commands, command_count, sizeof(RenderCommand), compare_commands);
+
+    int pipeline = -1, phase = -1;
+    for (int i = 0; i < command_count; i++) {
+        const RenderCommand* command = &commands[i];
+        if ((int)command->phase != phase) {
+            if (phase >= 0) gpu_timer_end((ProfilePhase)phase);
+            phase = command->phase;
+            gpu_timer_begin(command->phase);
+        }
+        int command_pipeline = (int)(command->key >> 48);
+        if (command_pipeline != pipeline) {
+            pipeline = command_pipeline;
+            set_pipeline((Pipeline)pipeline);
+        }
+        int texture = (int)((command->key >> 40) & 0xFF);
+        if (texture < RENDER_TEXTURE_COUNT) glstate_bind_texture(0, render_get_texture((RenderTexture)texture));
+        glstate_material(&materials[(command->key >> 32) & 0xFF]);
+        glColor3fv(command->color);
+        execute_command(world, command);
+    }
+    if (phase >= 0) gpu_timer_end((ProfilePhase)phase);
+    set_pipeline(PIPELINE_FIXED);
+}
 
-    glDisable(GL_LIGHTING);
-    glDisable(GL_TEXTURE_2D);
-    glColor3f(0.0, 0.0, 0.0);
+static void draw_exit_hole(const World* world) {
+    float x = world->exit_x, z = world->exit_z;
+    float hole_depth = -20.0f;
 
     glBegin(GL_QUADS);
         glVertex3f(x * CUBE_SIZE, hole_depth, z * CUBE_SIZE);
@@ -273,13 +663,10 @@ static void draw_exit_hole() {
         glVertex3f((x + 1) * CUBE_SIZE, hole_depth, (z + 1) * CUBE_SIZE);
         glVertex3f((x + 1) * CUBE_SIZE, hole_depth, z * CUBE_SIZE);
     glEnd();
-
-    glEnable(GL_TEXTURE_2D);
-    glEnable(GL_LIGHTING);
+    draw_calls += 2;
 }
 
-static void draw_textured_cube(GLuint texture_id) {
-    glBindTexture(GL_TEXTURE_2D, texture_id);
+static void draw_textured_cube() {
     glBegin(GL_QUADS);
         glNormal3f(0.0, 0.0, 1.0);
         glTexCoord2f(0.0, 0.0); glVertex3f(-0.5, -0.5, 0.5);
@@ -319,71 +706,143 @@ static void draw_textured_cube(GLuint texture_id) {
     glEnd();
 }
 
-static void draw_collectibles(const int maze[MAZE_WIDTH][MAZE_HEIGHT]) {
-    GLfloat s[] = {1.0, 1.0, 1.0, 1.0};
-    GLfloat n[] = {128.0};
-    GLfloat e[] = {1.0, 0.1, 0.1, 1.0};
-    glMaterialfv(GL_FRONT, GL_SPECULAR, s);
-    glMaterialfv(GL_FRONT, GL_SHININESS, n);
-    glMaterialfv(GL_FRONT, GL_EMISSION, e);
-    glBindTexture(GL_TEXTURE_2D, sphere_texture_id);
-    glColor3f(1.0, 1.0, 1.0);
 
-    for(int x = 0; x < MAZE_WIDTH; x++) {
-        for(int z = 0; z < MAZE_HEIGHT; z++) {
-            if(maze[x][z] == 2) {
-                glPushMatrix();
-                float t = glutGet(GLUT_ELAPSED_TIME) / 1000.0f;
-                float y = 0.5f + sin(t * 2.0f + x + z) * 0.1f;
-                glTranslatef(x * CUBE_SIZE + 0.5f, y, z * CUBE_SIZE + 0.5f);
-                gluSphere(sphere_quadric, 0.12, 16, 16);
-                glPopMatrix();
-            }
-        }
-    }
-    GLfloat ne[] = {0.0, 0.0, 0.0, 1.0};
-    glMaterialfv(GL_FRONT, GL_EMISSION, ne);
+int render_get_draw_calls() {
+    return draw_calls;
 }
 
-static void draw_exit_sphere(GameState state) {
-    if (state != STATE_ESCAPING && state != STATE_WON && state != STATE_LOST) {
-        return;
+GLuint render_get_texture(RenderTexture texture) {
+    return texture_gl_id(textures[texture]);
+}
+
+// Keeps the textures each state draws resident and prefetches the ones the next
+// likely state needs, so they can be evicted only if nothing else fits.
+void render_set_state_textures(GameState state) {
+    unsigned needed = 0, prefetch = 0;
+    unsigned level = (1u << RENDER_TEXTURE_WALL) | (1u << RENDER_TEXTURE_FLOOR) | (1u << RENDER_TEXTURE_CEILING) |
+                     (1u << RENDER_TEXTURE_DOOR) | (1u << RENDER_TEXTURE_SPHERE);
+    unsigned end_screens = (1u << RENDER_TEXTURE_LOSER_BG) | (1u << RENDER_TEXTURE_WIN_BG);
+    unsigned menu = 1u << RENDER_TEXTURE_MENU_BG;
+
+    switch (state) {
+        case STATE_MAIN_MENU: needed = menu; prefetch = level; break;
+        case STATE_PLAYING: needed = level; prefetch = menu; break;
+        case STATE_PAUSED: needed = level | menu; break;
+        case STATE_ESCAPING: needed = level; prefetch = end_screens | menu; break;
+        case STATE_WON: needed = level | (1u << RENDER_TEXTURE_WIN_BG); prefetch = menu; break;
+        case STATE_LOST: needed = level | (1u << RENDER_TEXTURE_LOSER_BG); prefetch = menu; break;
+    }
+
+    for (int i = 0; i < RENDER_TEXTURE_COUNT; i++) {
+        bool need = (needed >> i) & 1;
+        if (need && !textures_held[i]) texture_acquire(textures[i]);
+        if (!need && textures_held[i]) texture_release(textures[i]);
+        textures_held[i] = need;
     }
+    for (int i = 0; i < RENDER_TEXTURE_COUNT; i++) {
+        if ((prefetch >> i) & 1) texture_prefetch(textures[i]);
+    }
+}
 
-    GLfloat mat_specular[] = {0.1, 0.1, 0.1, 1.0};
-    GLfloat mat_shininess[] = {10.0};
-    GLfloat mat_emission[] = {1.0, 0.5, 0.5, 1.0};
-    glMaterialfv(GL_FRONT, GL_SPECULAR, mat_specular);
-    glMaterialfv(GL_FRONT, GL_SHININESS, mat_shininess);
-    glMaterialfv(GL_FRONT, GL_EMISSION, mat_emission);
+static bool raycast_setup() {
+    static const RenderTexture sources[RAYCAST_TEXTURE_CHASER] = {
+        RENDER_TEXTURE_WALL, RENDER_TEXTURE_FLOOR, RENDER_TEXTURE_CEILING, RENDER_TEXTURE_SPHERE, RENDER_TEXTURE_DOOR
+    };
+    if (!raycast_init()) return false;
+    for (int i = 0; i < RAYCAST_TEXTURE_CHASER; i++) {
+        if (!raycast_load_texture((RaycastTexture)i, texture_files[sources[i]])) return false;
+    }
+    static unsigned char chaser_pixels[BILLBOARD_TEXTURE_SIZE * BILLBOARD_TEXTURE_SIZE * 4];
+    billboards_build_texture(chaser_pixels);
+    if (!raycast_load_pixels(RAYCAST_TEXTURE_CHASER, chaser_pixels, BILLBOARD_TEXTURE_SIZE, BILLBOARD_TEXTURE_SIZE)) {
+        return false;
+    }
+    glGenTextures(1, &frame_texture);
+    glBindTexture(GL_TEXTURE_2D, frame_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    return raycast_resize(window_width, window_height);
+}
 
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, door_texture_id);
-    glColor3f(0.9, 0.5, 0.5);
+// Draws the CPU frame as one textured quad over the whole viewport.
+static void present_frame(const RaycastFrame* frame) {
+    glstate_bind_texture(0, frame_texture);
+    if (frame->width > frame_texture_width || frame->height > frame_texture_height) {
+        frame_texture_width = frame_texture_height = 1;
+        while (frame_texture_width < frame->width) frame_texture_width *= 2;
+        while (frame_texture_height < frame->height) frame_texture_height *= 2;
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, frame_texture_width, frame_texture_height, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, frame->stride);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, frame->width, frame->height, GL_BGRA, GL_UNSIGNED_BYTE, frame->pixels);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 
+    glMatrixMode(GL_PROJECTION);
     glPushMatrix();
-    float t = glutGet(GLUT_ELAPSED_TIME) / 1000.0f;
-    float y_offset = 0.5f + sin(t * 2.0f + 13 + 13) * 0.1f;
-    glTranslatef(13.5f * CUBE_SIZE, y_offset, 13.5f * CUBE_SIZE);
+    glLoadIdentity();
+    gluOrtho2D(0.0, 1.0, 0.0, 1.0);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    glstate_set(GLSTATE_DEPTH_TEST, false);
+    glstate_set(GLSTATE_LIGHTING, false);
+    glstate_set(GLSTATE_TEXTURE_2D, true);
+    glColor3f(1.0, 1.0, 1.0);
 
-    gluSphere(sphere_quadric, 0.15, 16, 16);
+    // The frame's first row is the top of the screen.
+    float s = (float)frame->width / frame_texture_width, t = (float)frame->height / frame_texture_height;
+    glBegin(GL_QUADS);
+        glTexCoord2f(0.0, t); glVertex2f(0.0, 0.0);
+        glTexCoord2f(s, t);   glVertex2f(1.0, 0.0);
+        glTexCoord2f(s, 0.0); glVertex2f(1.0, 1.0);
+        glTexCoord2f(0.0, 0.0); glVertex2f(0.0, 1.0);
+    glEnd();
 
+    glstate_set(GLSTATE_LIGHTING, true);
+    glstate_set(GLSTATE_DEPTH_TEST, true);
     glPopMatrix();
-
-    GLfloat no_emission[] = {0.0, 0.0, 0.0, 1.0};
-    glMaterialfv(GL_FRONT, GL_EMISSION, no_emission);
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
 }
 
+static void render_scene_raycast(const World* world, const CollectibleIndex* collectibles, GameState state, float t) {
+    static RaycastSprite sprites[RAYCAST_MAX_SPRITES];
+    static int nearby[RAYCAST_MAX_SPRITES];
 
-GLuint render_get_texture_id(const char* name) {
-    if (strcmp(name, "menu_bg") == 0) {
-        return menu_bg_texture_id;
+    int sprite_count = collectibles_in_radius(collectibles, camera.x, camera.z, PVS_RADIUS * CUBE_SIZE, nearby, RAYCAST_MAX_SPRITES - 1);
+    for (int i = 0; i < sprite_count; i++) {
+        const Collectible* item = &collectibles->items[nearby[i]];
+        RaycastSprite sprite = {item->x, 0.5f + sin(t * 2.0f + item->cell_x + item->cell_z) * 0.1f, item->z, 0.12f,
+                                RAYCAST_TEXTURE_SPHERE, {1.0f, 0.1f, 0.1f}};
+        sprites[i] = sprite;
     }
-    else if (strcmp(name, "loser_bg") == 0) {
-        return loser_bg_texture_id;
+    if (state == STATE_ESCAPING || state == STATE_WON || state == STATE_LOST) {
+        RaycastSprite sprite = {(world->exit_x + 0.5f) * CUBE_SIZE, 0.5f + sin(t * 2.0f + world->exit_x + world->exit_z) * 0.1f,
+                                (world->exit_z + 0.5f) * CUBE_SIZE, 0.15f, RAYCAST_TEXTURE_DOOR, {1.0f, 0.5f, 0.5f}};
+        sprites[sprite_count++] = sprite;
     }
-    else if (strcmp(name, "win_bg") == 0) {
-        return win_bg_texture_id;
+    float radius_sq = PVS_RADIUS * CUBE_SIZE * PVS_RADIUS * CUBE_SIZE;
+    for (int i = 0; i < chaser_count && sprite_count < RAYCAST_MAX_SPRITES; i++) {
+        const BillboardInstance* b = &chasers[i];
+        float dx = b->x - camera.x, dz = b->z - camera.z;
+        if (dx * dx + dz * dz > radius_sq) continue;
+        // Unlit, like the billboards of the GL path.
+        RaycastSprite sprite = {b->x, b->y, b->z, b->size / 2.0f, RAYCAST_TEXTURE_CHASER, {1.0f, 1.0f, 1.0f}};
+        sprites[sprite_count++] = sprite;
     }
-    return 0;
+
+    RaycastScene scene;
+    scene.world = world;
+    scene.view = camera;
+    scene.exit_closed = state == STATE_PLAYING;
+    memcpy(scene.ambient, current_global_ambient, sizeof(scene.ambient));
+    scene.lights = scene_lights;
+    scene.light_count = collect_point_lights(world, collectibles, state, t);
+    scene.sprites = sprites;
+    scene.sprite_count = sprite_count;
+
+    const RaycastFrame* frame = raycast_render(&scene);
+    if (frame) present_frame(frame);
+    draw_calls = 1;
 }
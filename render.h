@@ -4,14 +4,53 @@
 #include <stdbool.h>
 #include <GL/glut.h>
 #include "config.h"
+#include "world.h"
+#include "collectibles.h"
+#include "lights.h"
+#include "billboards.h"
+
+typedef enum {
+    RENDER_TEXTURE_WALL,
+    RENDER_TEXTURE_FLOOR,
+    RENDER_TEXTURE_CEILING,
+    RENDER_TEXTURE_DOOR,
+    RENDER_TEXTURE_SPHERE,
+    RENDER_TEXTURE_MENU_BG,
+    RENDER_TEXTURE_LOSER_BG,
+    RENDER_TEXTURE_WIN_BG,
+    RENDER_TEXTURE_COUNT
+} RenderTexture;
+
+typedef enum {
+    RENDER_BACKEND_GL,
+    RENDER_BACKEND_RAYCAST,
+    RENDER_BACKEND_COUNT
+} RenderBackend;
+
+// Chooses how render_scene draws the maze; must be called before render_init.
+void render_set_backend(RenderBackend backend);
+RenderBackend render_get_backend();
+bool render_parse_backend(const char* name, RenderBackend* backend);
+const char* render_backend_name(RenderBackend backend);
 
 bool render_init();
+void render_load_level(const World* world);
 void render_start_frame();
-void render_scene(const int maze[MAZE_WIDTH][MAZE_HEIGHT], GameState state);
+// time, in seconds, drives the bobbing of the spheres and their lights.
+void render_scene(const World* world, const CollectibleIndex* collectibles, const Player* view, GameState state, float time);
 void render_end_frame();
 void render_reshape(int w, int h);
+// Window size as of the last render_reshape.
+int render_window_width();
+int render_window_height();
 void render_cleanup();
-GLuint render_get_texture_id(const char* name);
+GLuint render_get_texture(RenderTexture texture);
+void render_set_state_textures(GameState state);
+int render_get_draw_calls();
 void render_update_ambient_light(int eaten, int total, GameState state);
+// Pursuers drawn by the following frames; the array must stay valid until replaced.
+void render_set_chasers(const BillboardInstance* instances, int count);
+// Lights added to every frame on top of the level's own; used by the light benchmark.
+void render_set_extra_lights(const PointLight* lights, int count);
 
 #endif
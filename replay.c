@@ -0,0 +1,155 @@
+#include <string.h>
+#include "replay.h"
+
+#define REPLAY_KEY_FORWARD 0x01
+#define REPLAY_KEY_BACK 0x02
+#define REPLAY_KEY_LEFT 0x04
+#define REPLAY_KEY_RIGHT 0x08
+#define REPLAY_HAS_LOOK 0x10
+#define REPLAY_HAS_COMMANDS 0x20
+
+static const char replay_magic[4] = {'M', 'Z', 'R', 'P'};
+
+static bool write_u32(FILE* file, uint32_t value) {
+    unsigned char bytes[4] = {value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, value >> 24};
+    return fwrite(bytes, 1, 4, file) == 4;
+}
+
+static bool read_u32(FILE* file, uint32_t* value) {
+    unsigned char bytes[4];
+    if (fread(bytes, 1, 4, file) != 4) return false;
+    *value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+    return true;
+}
+
+static bool write_float(FILE* file, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return write_u32(file, bits);
+}
+
+static bool read_float(FILE* file, float* value) {
+    uint32_t bits;
+    if (!read_u32(file, &bits)) return false;
+    memcpy(value, &bits, sizeof(bits));
+    return true;
+}
+
+bool replay_open_write(Replay* replay, const char* path, const LevelConfig* level) {
+    memset(replay, 0, sizeof(*replay));
+    replay->file = fopen(path, "wb");
+    if (!replay->file) {
+        fprintf(stderr, "Nao foi possivel criar o replay: %s\n", path);
+        return false;
+    }
+    replay->level = *level;
+
+    FILE* f = replay->file;
+    bool ok = fwrite(replay_magic, 1, 4, f) == 4;
+    ok = ok && write_u32(f, REPLAY_VERSION) && write_u32(f, SIM_VERSION) && write_u32(f, SIM_HZ);
+    ok = ok && write_u32(f, (uint32_t)level->size) && write_u32(f, level->seed);
+    ok = ok && write_u32(f, (uint32_t)level->algorithm) && write_u32(f, (uint32_t)level->collectibles);
+    ok = ok && write_u32(f, (uint32_t)level->chasers);
+    if (!ok) replay_close(replay);
+    return ok;
+}
+
+bool replay_open_read(Replay* replay, const char* path) {
+    memset(replay, 0, sizeof(*replay));
+    replay->file = fopen(path, "rb");
+    if (!replay->file) {
+        fprintf(stderr, "Nao foi possivel abrir o replay: %s\n", path);
+        return false;
+    }
+
+    FILE* f = replay->file;
+    char magic[4];
+    uint32_t version, sim_version, hz, size, seed, algorithm, collectibles, chasers;
+    bool ok = fread(magic, 1, 4, f) == 4 && memcmp(magic, replay_magic, 4) == 0;
+    ok = ok && read_u32(f, &version) && read_u32(f, &sim_version) && read_u32(f, &hz);
+    ok = ok && read_u32(f, &size) && read_u32(f, &seed) && read_u32(f, &algorithm) && read_u32(f, &collectibles);
+    ok = ok && read_u32(f, &chasers);
+    if (!ok) {
+        fprintf(stderr, "Replay invalido: %s\n", path);
+        replay_close(replay);
+        return false;
+    }
+    if (version != REPLAY_VERSION || sim_version != SIM_VERSION || hz != SIM_HZ) {
+        fprintf(stderr, "Replay de outra versao (formato %u, simulacao %u, %u Hz)\n", version, sim_version, hz);
+        replay_close(replay);
+        return false;
+    }
+
+    replay->level.size = (int)size;
+    replay->level.seed = seed;
+    replay->level.algorithm = algorithm < MAZEGEN_ALGORITHM_COUNT ? (MazeAlgorithm)algorithm : MAZEGEN_BACKTRACKER;
+    replay->level.collectibles = (int)collectibles;
+    replay->level.chasers = (int)chasers;
+    return true;
+}
+
+bool replay_write_tick(Replay* replay, const ReplayTick* tick) {
+    FILE* f = replay->file;
+    const PlayerInput* input = &tick->input;
+    unsigned char flags = 0;
+    if (input->forward) flags |= REPLAY_KEY_FORWARD;
+    if (input->back) flags |= REPLAY_KEY_BACK;
+    if (input->left) flags |= REPLAY_KEY_LEFT;
+    if (input->right) flags |= REPLAY_KEY_RIGHT;
+    if (input->turn != 0.0f || input->tilt != 0.0f) flags |= REPLAY_HAS_LOOK;
+    if (tick->command_count > 0) flags |= REPLAY_HAS_COMMANDS;
+
+    bool ok = fputc(flags, f) != EOF;
+    if (flags & REPLAY_HAS_LOOK) {
+        ok = ok && write_float(f, input->turn) && write_float(f, input->tilt);
+    }
+    if (flags & REPLAY_HAS_COMMANDS) {
+        ok = ok && fputc(tick->command_count, f) != EOF;
+        ok = ok && fwrite(tick->commands, 1, tick->command_count, f) == (size_t)tick->command_count;
+    }
+    ok = ok && write_u32(f, tick->hash);
+    replay->tick++;
+    return ok;
+}
+
+bool replay_read_tick(Replay* replay, ReplayTick* tick) {
+    FILE* f = replay->file;
+    memset(tick, 0, sizeof(*tick));
+
+    int flags = fgetc(f);
+    if (flags == EOF) return false;
+    tick->input.forward = (flags & REPLAY_KEY_FORWARD) != 0;
+    tick->input.back = (flags & REPLAY_KEY_BACK) != 0;
+    tick->input.left = (flags & REPLAY_KEY_LEFT) != 0;
+    tick->input.right = (flags & REPLAY_KEY_RIGHT) != 0;
+
+    if ((flags & REPLAY_HAS_LOOK) && !(read_float(f, &tick->input.turn) && read_float(f, &tick->input.tilt))) return false;
+    if (flags & REPLAY_HAS_COMMANDS) {
+        int count = fgetc(f);
+        if (count == EOF || count > REPLAY_MAX_COMMANDS) return false;
+        tick->command_count = count;
+        if (fread(tick->commands, 1, count, f) != (size_t)count) return false;
+    }
+    if (!read_u32(f, &tick->hash)) return false;
+    replay->tick++;
+    return true;
+}
+
+ReplayStatus replay_step(Replay* replay, Sim* sim, float dt, int* events) {
+    ReplayTick tick;
+    if (!replay_read_tick(replay, &tick)) return REPLAY_END;
+
+    int tick_events = 0;
+    for (int i = 0; i < tick.command_count; i++) {
+        tick_events |= sim_command(sim, (SimCommand)tick.commands[i]);
+    }
+    tick_events |= sim_step(sim, &tick.input, dt);
+    if (events) *events = tick_events;
+
+    return sim_hash(sim) == tick.hash ? REPLAY_OK : REPLAY_DIVERGED;
+}
+
+void replay_close(Replay* replay) {
+    if (replay->file) fclose(replay->file);
+    replay->file = NULL;
+}
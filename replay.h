@@ -0,0 +1,39 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "sim.h"
+#include "mazegen.h"
+
+#define REPLAY_VERSION 2
+#define REPLAY_MAX_COMMANDS 4
+
+typedef enum {
+    REPLAY_OK,
+    REPLAY_END,
+    REPLAY_DIVERGED
+} ReplayStatus;
+
+typedef struct {
+    PlayerInput input;
+    unsigned char commands[REPLAY_MAX_COMMANDS];
+    int command_count;
+    uint32_t hash;
+} ReplayTick;
+
+typedef struct {
+    FILE* file;
+    LevelConfig level;
+    long tick;
+} Replay;
+
+bool replay_open_write(Replay* replay, const char* path, const LevelConfig* level);
+bool replay_open_read(Replay* replay, const char* path);
+bool replay_write_tick(Replay* replay, const ReplayTick* tick);
+bool replay_read_tick(Replay* replay, ReplayTick* tick);
+ReplayStatus replay_step(Replay* replay, Sim* sim, float dt, int* events);
+void replay_close(Replay* replay);
+
+#endif
@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include "shader.h"
+
+static GLuint compile_stage(const char* name, GLenum type, const char* source) {
+    GLuint shader = gl_create_shader(type);
+    gl_shader_source(shader, 1, &source, NULL);
+    gl_compile_shader(shader);
+
+    GLint ok = GL_FALSE;
+    gl_get_shaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        gl_get_shader_info_log(shader, sizeof(log), NULL, log);
+        fprintf(stderr, "Erro ao compilar shader '%s' (%s):\n%s\n", name,
+                type == GL_VERTEX_SHADER ? "vertice" : "fragmento", log);
+        gl_delete_shader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint shader_build(const char* name, const char* vertex_source, const char* fragment_source) {
+    if (!glload_has_shaders()) return 0;
+
+    GLuint vertex = compile_stage(name, GL_VERTEX_SHADER, vertex_source);
+    if (!vertex) return 0;
+    GLuint fragment = compile_stage(name, GL_FRAGMENT_SHADER, fragment_source);
+    if (!fragment) {
+        gl_delete_shader(vertex);
+        return 0;
+    }
+
+    GLuint program = gl_create_program();
+    gl_attach_shader(program, vertex);
+    gl_attach_shader(program, fragment);
+    gl_link_program(program);
+    gl_delete_shader(vertex);
+    gl_delete_shader(fragment);
+
+    GLint ok = GL_FALSE;
+    gl_get_programiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        char log[1024];
+        gl_get_program_info_log(program, sizeof(log), NULL, log);
+        fprintf(stderr, "Erro ao ligar shader '%s':\n%s\n", name, log);
+        gl_delete_program(program);
+        return 0;
+    }
+    return program;
+}
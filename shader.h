@@ -0,0 +1,9 @@
+#ifndef SHADER_H
+#define SHADER_H
+
+#include "glload.h"
+
+// Compiles and links a GLSL program, printing the driver log on failure. Returns 0 if it fails.
+GLuint shader_build(const char* name, const char* vertex_source, const char* fragment_source);
+
+#endif
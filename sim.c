@@ -0,0 +1,229 @@
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "profiler.h"
+
+static const int maze_grid[MAZE_WIDTH][MAZE_HEIGHT] = {
+    {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1}, {1,0,0,1,0,0,0,0,0,1,1,0,1,2,1}, {1,1,0,1,1,1,0,1,0,0,1,0,1,0,1},
+    {1,0,0,0,0,1,0,1,0,1,1,0,0,0,1}, {1,0,1,1,0,1,0,1,0,1,0,0,1,0,1}, {1,0,0,1,0,1,0,0,0,1,0,0,1,0,1},
+    {1,1,0,1,0,0,1,1,1,1,0,1,1,0,1}, {1,0,0,0,0,1,1,0,0,0,0,0,0,0,1}, {1,0,1,1,1,1,0,0,1,0,1,1,1,0,1},
+    {1,0,0,0,0,0,0,1,1,0,0,0,1,0,1}, {1,0,1,1,1,1,0,1,0,1,1,0,1,2,1}, {1,0,0,0,0,1,0,0,0,0,1,0,0,0,1},
+    {1,1,1,0,1,1,1,1,1,0,1,1,1,0,1}, {1,0,0,0,0,0,0,0,1,0,0,0,0,0,1}, {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1}
+};
+
+static bool load_builtin_level(World* target) {
+    if (!world_create(target, MAZE_WIDTH, MAZE_HEIGHT)) return false;
+    for (int x = 0; x < MAZE_WIDTH; x++) {
+        for (int z = 0; z < MAZE_HEIGHT; z++) {
+            world_set(target, x, z, maze_grid[x][z]);
+        }
+    }
+    target->exit_x = 13;
+    target->exit_z = 13;
+    target->start_x = 7.5f;
+    target->start_z = 7.5f;
+    return true;
+}
+
+bool sim_load_level(World* level, const LevelConfig* config) {
+    if (!config || config->size <= 0) return load_builtin_level(level);
+
+    LevelConfig generated = *config;
+    if (generated.collectibles <= 0) generated.collectibles = mazegen_default_collectibles(generated.size);
+    return mazegen_generate(level, &generated, NULL);
+}
+
+bool sim_init(Sim* sim, const World* level) {
+    memset(sim, 0, sizeof(*sim));
+    sim->level = level;
+    if (!world_copy(&sim->world, level)) return false;
+    if (!collision_map_build(&sim->collision, level, true)) return false;
+    if (!collectibles_build(&sim->collectibles, level)) return false;
+    sim->total_collectibles = sim->collectibles.count;
+    sim->collectibles_eaten = 0;
+    sim->escape_timer = ESCAPE_SECONDS;
+    sim->state = STATE_MAIN_MENU;
+    sim->previous_state = STATE_MAIN_MENU;
+    player_init(&sim->player, level);
+    return true;
+}
+
+static void build_collectible_field(Sim* sim) {
+    int count = 0;
+    for (int i = 0; i < sim->collectibles.count; i++) {
+        const Collectible* c = &sim->collectibles.items[i];
+        if (!c->active) continue;
+        sim->guide_sources[count].x = c->cell_x;
+        sim->guide_sources[count].z = c->cell_z;
+        count++;
+    }
+    path_field_build(&sim->collectible_field, &sim->collision, sim->guide_sources, count);
+}
+
+bool sim_enable_guide(Sim* sim) {
+    if (sim->guide_enabled) return true;
+    int width = sim->world.width, height = sim->world.height;
+    sim->guide_sources = malloc((sim->collectibles.count > 0 ? sim->collectibles.count : 1) * sizeof(PathCell));
+    if (!sim->guide_sources || !path_field_init(&sim->exit_field, width, height) ||
+        !path_field_init(&sim->collectible_field, width, height)) {
+        path_field_free(&sim->exit_field);
+        path_field_free(&sim->collectible_field);
+        free(sim->guide_sources);
+        sim->guide_sources = NULL;
+        return false;
+    }
+    PathCell exit_cell = {sim->world.exit_x, sim->world.exit_z};
+    path_field_build(&sim->exit_field, &sim->collision, &exit_cell, 1);
+    build_collectible_field(sim);
+    sim->guide_enabled = true;
+    return true;
+}
+
+bool sim_enable_chasers(Sim* sim, int count) {
+    chasers_free(&sim->chasers);
+    return chasers_init(&sim->chasers, sim->level, count);
+}
+
+int sim_guide(const Sim* sim, PathCell* next) {
+    if (!sim->guide_enabled) return -1;
+    const PathField* field = sim->state == STATE_ESCAPING ? &sim->exit_field : &sim->collectible_field;
+    int px = (int)(sim->player.x / CUBE_SIZE);
+    int pz = (int)(sim->player.z / CUBE_SIZE);
+    int32_t distance = path_field_distance(field, px, pz);
+    if (distance == PATH_UNREACHABLE) return -1;
+    if (!path_field_step(field, px, pz, next)) {
+        next->x = px;
+        next->z = pz;
+    }
+    return distance;
+}
+
+bool sim_reset(Sim* sim) {
+    if (!world_copy(&sim->world, sim->level)) return false;
+    player_init(&sim->player, &sim->world);
+    collectibles_reset(&sim->collectibles);
+    sim->generation++;
+    sim->collectibles_eaten = 0;
+    sim->escape_timer = ESCAPE_SECONDS;
+    sim_set_state(sim, STATE_PLAYING);
+    if (sim->guide_enabled) build_collectible_field(sim);
+    chasers_spawn(&sim->chasers, &sim->collision, sim->player.x, sim->player.z, 2654435761u * (uint32_t)sim->generation);
+    return true;
+}
+
+void sim_set_state(Sim* sim, GameState state) {
+    if (state == STATE_PAUSED) {
+        sim->previous_state = sim->state;
+    }
+    sim->state = state;
+
+    if (state == STATE_PLAYING || state == STATE_ESCAPING) {
+        collision_map_set(&sim->collision, sim->world.exit_x, sim->world.exit_z, state == STATE_PLAYING);
+    }
+}
+
+int sim_command(Sim* sim, SimCommand command) {
+    switch (command) {
+        case SIM_COMMAND_START:
+            sim_reset(sim);
+            break;
+        case SIM_COMMAND_PAUSE:
+            if (sim->state != STATE_PLAYING && sim->state != STATE_ESCAPING) return 0;
+            sim_set_state(sim, STATE_PAUSED);
+            break;
+        case SIM_COMMAND_RESUME:
+            if (sim->state != STATE_PAUSED) return 0;
+            sim_set_state(sim, sim->previous_state);
+            break;
+        case SIM_COMMAND_MENU:
+            sim_set_state(sim, STATE_MAIN_MENU);
+            break;
+        default:
+            return 0;
+    }
+    return SIM_EVENT_STATE_CHANGED;
+}
+
+static uint32_t hash_bytes(uint32_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+uint32_t sim_hash(const Sim* sim) {
+    const Player* p = &sim->player;
+    uint32_t hash = 2166136261u;
+    hash = hash_bytes(hash, &p->x, sizeof(p->x));
+    hash = hash_bytes(hash, &p->y, sizeof(p->y));
+    hash = hash_bytes(hash, &p->z, sizeof(p->z));
+    hash = hash_bytes(hash, &p->angle, sizeof(p->angle));
+    hash = hash_bytes(hash, &p->pitch, sizeof(p->pitch));
+    hash = hash_bytes(hash, &sim->collectibles_eaten, sizeof(sim->collectibles_eaten));
+    hash = hash_bytes(hash, &sim->escape_timer, sizeof(sim->escape_timer));
+    hash = hash_bytes(hash, &sim->state, sizeof(sim->state));
+    hash = hash_bytes(hash, sim->chasers.bodies.x, sim->chasers.count * sizeof(float));
+    hash = hash_bytes(hash, sim->chasers.bodies.z, sim->chasers.count * sizeof(float));
+    return hash;
+}
+
+int sim_step(Sim* sim, const PlayerInput* input, float dt) {
+    if (sim->state != STATE_PLAYING && sim->state != STATE_ESCAPING) return 0;
+
+    int events = 0;
+    profiler_begin(PROFILE_PLAYER_UPDATE);
+    player_update(&sim->player, &sim->world, &sim->collision, input, sim->state, dt);
+    profiler_end(PROFILE_PLAYER_UPDATE);
+
+    int px = (int)(sim->player.x / CUBE_SIZE);
+    int pz = (int)(sim->player.z / CUBE_SIZE);
+
+    if (world_in_bounds(&sim->world, px, pz) && world_get(&sim->world, px, pz) == 2) {
+        world_set(&sim->world, px, pz, 0);
+        collectibles_remove_at(&sim->collectibles, px, pz);
+        if (sim->guide_enabled) path_field_remove_source(&sim->collectible_field, &sim->collision, px, pz);
+        sim->last_pickup_x = px;
+        sim->last_pickup_z = pz;
+        sim->collectibles_eaten++;
+        events |= SIM_EVENT_PICKUP;
+
+        if (sim->collectibles_eaten == sim->total_collectibles) {
+            sim_set_state(sim, STATE_ESCAPING);
+            events |= SIM_EVENT_STATE_CHANGED;
+        }
+    }
+
+    if (sim->state == STATE_ESCAPING) {
+        sim->escape_timer -= dt;
+        if (sim->player.y < -8.0f) {
+            sim_set_state(sim, STATE_WON);
+            events |= SIM_EVENT_STATE_CHANGED;
+        } else if (sim->escape_timer <= 0.0f) {
+            sim->escape_timer = 0.0f;
+            sim_set_state(sim, STATE_LOST);
+            events |= SIM_EVENT_STATE_CHANGED;
+        }
+    }
+
+    if (sim->chasers.count > 0 && (sim->state == STATE_PLAYING || sim->state == STATE_ESCAPING)) {
+        profiler_begin(PROFILE_CHASERS);
+        bool caught = chasers_update(&sim->chasers, &sim->collision, sim->player.x, sim->player.z, dt);
+        profiler_end(PROFILE_CHASERS);
+        if (caught) {
+            sim_set_state(sim, STATE_LOST);
+            events |= SIM_EVENT_STATE_CHANGED;
+        }
+    }
+    return events;
+}
+
+void sim_free(Sim* sim) {
+    path_field_free(&sim->exit_field);
+    path_field_free(&sim->collectible_field);
+    free(sim->guide_sources);
+    chasers_free(&sim->chasers);
+    collectibles_free(&sim->collectibles);
+    collision_map_free(&sim->collision);
+    world_destroy(&sim->world);
+}
@@ -0,0 +1,66 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+#include "world.h"
+#include "player.h"
+#include "mazegen.h"
+#include "collision.h"
+#include "collectibles.h"
+#include "pathfind.h"
+#include "chasers.h"
+
+#define SIM_VERSION 3
+
+#define SIM_EVENT_PICKUP 1
+#define SIM_EVENT_STATE_CHANGED 2
+
+typedef enum {
+    SIM_COMMAND_START = 1,
+    SIM_COMMAND_PAUSE,
+    SIM_COMMAND_RESUME,
+    SIM_COMMAND_MENU
+} SimCommand;
+
+typedef struct {
+    World world;
+    const World* level;
+    CollisionMap collision;
+    CollectibleIndex collectibles;
+    Player player;
+    GameState state;
+    GameState previous_state;
+    int collectibles_eaten;
+    int total_collectibles;
+    float escape_timer;
+    // Bumped by every sim_reset; last_pickup is the cell of the latest SIM_EVENT_PICKUP.
+    int generation;
+    int last_pickup_x, last_pickup_z;
+    // Distance fields behind the HUD guide, built by sim_enable_guide and kept
+    // up to date by sim_step. They cost about 26 bytes per cell, so they are
+    // only built once the guide is first shown.
+    bool guide_enabled;
+    PathField exit_field;
+    PathField collectible_field;
+    PathCell* guide_sources;
+    Chasers chasers;
+} Sim;
+
+bool sim_load_level(World* level, const LevelConfig* config);
+bool sim_init(Sim* sim, const World* level);
+bool sim_reset(Sim* sim);
+int sim_step(Sim* sim, const PlayerInput* input, float dt);
+void sim_set_state(Sim* sim, GameState state);
+int sim_command(Sim* sim, SimCommand command);
+uint32_t sim_hash(const Sim* sim);
+bool sim_enable_guide(Sim* sim);
+// Pursuers spawn on every sim_reset; one catching the player loses the game.
+bool sim_enable_chasers(Sim* sim, int count);
+// Steps to the current goal (the nearest sphere, or the exit once it is open)
+// and the next cell toward it; -1 when there is no guide or no path.
+int sim_guide(const Sim* sim, PathCell* next);
+void sim_free(Sim* sim);
+
+#endif
@@ -0,0 +1,325 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "mazegen.h"
+#include "platform.h"
+#include "replay.h"
+#include "jobs.h"
+#include "thread.h"
+
+#define MAX_SCRIPT_SEGMENTS 256
+#define RANDOM_SEGMENT_STEPS 30
+
+typedef struct {
+    int steps;
+    PlayerInput input;
+} ScriptSegment;
+
+typedef struct {
+    ScriptSegment segments[MAX_SCRIPT_SEGMENTS];
+    int count;
+} Script;
+
+static bool load_script(const char* path, Script* script) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Nao foi possivel abrir o roteiro: %s\n", path);
+        return false;
+    }
+
+    char line[256];
+    script->count = 0;
+    while (fgets(line, sizeof(line), file) && script->count < MAX_SCRIPT_SEGMENTS) {
+        char keys[16];
+        int steps;
+        float turn = 0.0f;
+        if (line[0] == '#' || sscanf(line, "%d %15s %f", &steps, keys, &turn) < 2 || steps <= 0) continue;
+
+        ScriptSegment* segment = &script->segments[script->count++];
+        memset(segment, 0, sizeof(*segment));
+        segment->steps = steps;
+        segment->input.forward = strchr(keys, 'w') != NULL;
+        segment->input.back = strchr(keys, 's') != NULL;
+        segment->input.left = strchr(keys, 'a') != NULL;
+        segment->input.right = strchr(keys, 'd') != NULL;
+        segment->input.turn = turn / steps;
+    }
+    fclose(file);
+
+    if (script->count == 0) {
+        fprintf(stderr, "Roteiro vazio: %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+static void random_input(MazeRng* rng, PlayerInput* input) {
+    memset(input, 0, sizeof(*input));
+    input->forward = maze_rng_range(rng, 4) != 0;
+    input->left = maze_rng_range(rng, 8) == 0;
+    input->right = maze_rng_range(rng, 8) == 0;
+    input->turn = ((float)maze_rng_range(rng, 1001) / 1000.0f - 0.5f) * 0.2f;
+}
+
+static int run_instance(Sim* sim, const Script* script, uint32_t seed, int steps, Replay* recording) {
+    MazeRng rng;
+    maze_rng_seed(&rng, seed);
+    PlayerInput input;
+    int segment = 0, remaining = 0;
+
+    sim_command(sim, SIM_COMMAND_START);
+    for (int i = 0; i < steps; i++) {
+        if (remaining == 0) {
+            if (script) {
+                input = script->segments[segment].input;
+                remaining = script->segments[segment].steps;
+                segment = (segment + 1) % script->count;
+            } else {
+                random_input(&rng, &input);
+                remaining = RANDOM_SEGMENT_STEPS;
+            }
+        }
+        remaining--;
+
+        sim_step(sim, &input, (float)SIM_DT);
+        if (recording) {
+            ReplayTick tick;
+            memset(&tick, 0, sizeof(tick));
+            tick.input = input;
+            if (i == 0) tick.commands[tick.command_count++] = SIM_COMMAND_START;
+            tick.hash = sim_hash(sim);
+            replay_write_tick(recording, &tick);
+        }
+        if (sim->state == STATE_WON || sim->state == STATE_LOST) return i + 1;
+    }
+    return steps;
+}
+
+static int verify_replay(const char* path) {
+    Replay replay;
+    if (!replay_open_read(&replay, path)) return 1;
+
+    World level = {0};
+    Sim sim;
+    if (replay.level.chasers > 0) jobs_init(0);
+    if (!sim_load_level(&level, &replay.level) || !sim_init(&sim, &level) ||
+        !sim_enable_chasers(&sim, replay.level.chasers)) {
+        fprintf(stderr, "Falha ao carregar o labirinto\n");
+        replay_close(&replay);
+        return 1;
+    }
+
+    double start = platform_time_seconds();
+    ReplayStatus status;
+    while ((status = replay_step(&replay, &sim, (float)SIM_DT, NULL)) == REPLAY_OK) {}
+    double elapsed = platform_time_seconds() - start;
+
+    int result = 0;
+    if (status == REPLAY_DIVERGED) {
+        printf("Replay divergiu no tick %ld\n", replay.tick);
+        result = 2;
+    } else {
+        printf("Replay ok: %ld ticks em %.3f s\n", replay.tick, elapsed);
+    }
+
+    replay_close(&replay);
+    sim_free(&sim);
+    world_destroy(&level);
+    return result;
+}
+
+static int benchmark_collision(const World* level, int entities, int steps, uint32_t seed) {
+    CollisionMap map;
+    CollisionBodies bodies;
+    if (!collision_map_build(&map, level, true)) return 1;
+    if (!collision_bodies_init(&bodies, entities)) {
+        collision_map_free(&map);
+        return 1;
+    }
+
+    MazeRng rng;
+    maze_rng_seed(&rng, seed);
+    while (bodies.count < entities) {
+        int x = maze_rng_range(&rng, level->width), z = maze_rng_range(&rng, level->height);
+        if (collision_map_solid(&map, x, z)) continue;
+        int i = bodies.count++;
+        bodies.x[i] = (x + 0.5f) * CUBE_SIZE;
+        bodies.z[i] = (z + 0.5f) * CUBE_SIZE;
+        bodies.vx[i] = ((float)maze_rng_range(&rng, 2001) / 1000.0f - 1.0f) * PLAYER_SPEED;
+        bodies.vz[i] = ((float)maze_rng_range(&rng, 2001) / 1000.0f - 1.0f) * PLAYER_SPEED;
+    }
+
+    double start = platform_time_seconds();
+    for (int s = 0; s < steps; s++) {
+        collision_move(&map, &bodies, PLAYER_SIZE / 2.0f, (float)SIM_DT);
+    }
+    double elapsed = platform_time_seconds() - start;
+
+    int stuck = 0;
+    for (int i = 0; i < bodies.count; i++) {
+        int x = (int)(bodies.x[i] / CUBE_SIZE), z = (int)(bodies.z[i] / CUBE_SIZE);
+        if (collision_map_solid(&map, x, z)) stuck++;
+    }
+
+    double moves = (double)entities * steps;
+    printf("Colisao: %d entidades, %d passos, %.3f s\n", entities, steps, elapsed);
+    printf("%.0f entidades/ms, %d dentro de paredes\n", elapsed > 0.0 ? moves / (elapsed * 1000.0) : 0.0, stuck);
+
+    collision_bodies_free(&bodies);
+    collision_map_free(&map);
+    return stuck == 0 ? 0 : 2;
+}
+
+// Doubles value up to limit, ending on limit itself; 0 once limit was passed.
+static int next_doubling(int value, int limit) {
+    if (value >= limit) return 0;
+    return value * 2 < limit ? value * 2 : limit;
+}
+
+// Tick time of the pursuers for doubling agent counts up to max_agents and
+// doubling thread counts up to max_threads, as CSV. The player stands still
+// at the start, so every tick is steering, avoidance and collision only.
+static int benchmark_chasers(const World* level, int max_agents, int max_threads, int steps) {
+    CollisionMap map;
+    if (!collision_map_build(&map, level, true)) return 1;
+    Player player;
+    player_init(&player, level);
+    if (max_threads <= 0) max_threads = thread_cpu_count();
+    if (max_threads > JOBS_MAX_THREADS) max_threads = JOBS_MAX_THREADS;
+
+    printf("agents,threads,tick_ms,agents_per_ms,steals\n");
+    for (int agents = max_agents < 1024 ? max_agents : 1024; agents > 0; agents = next_doubling(agents, max_agents)) {
+        for (int threads = 1; threads > 0; threads = next_doubling(threads, max_threads)) {
+            Chasers chasers;
+            if (!jobs_init(threads) || !chasers_init(&chasers, level, agents)) {
+                printf("# %d: memoria insuficiente\n", agents);
+                jobs_shutdown();
+                collision_map_free(&map);
+                return 1;
+            }
+            chasers_spawn(&chasers, &map, player.x, player.z, (uint32_t)agents);
+
+            double start = platform_time_seconds();
+            for (int s = 0; s < steps; s++) {
+                chasers_update(&chasers, &map, player.x, player.z, (float)SIM_DT);
+            }
+            double tick_ms = (platform_time_seconds() - start) * 1000.0 / steps;
+            printf("%d,%d,%.4f,%.0f,%d\n", agents, jobs_thread_count(), tick_ms,
+                   tick_ms > 0.0 ? agents / tick_ms : 0.0, jobs_steal_count());
+            fflush(stdout);
+
+            chasers_free(&chasers);
+            jobs_shutdown();
+        }
+    }
+    collision_map_free(&map);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    LevelConfig config = {0, 1, MAZEGEN_BACKTRACKER, 0, 0};
+    int instances = 1000;
+    int steps = 3600;
+    const char* script_path = NULL;
+    const char* record_path = NULL;
+    const char* replay_path = NULL;
+    int collision_entities = 0;
+    int chaser_bench = 0;
+    int threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(arg, "--instances") == 0 && has_value) {
+            instances = atoi(argv[++i]);
+        } else if (strcmp(arg, "--steps") == 0 && has_value) {
+            steps = atoi(argv[++i]);
+        } else if (strcmp(arg, "--script") == 0 && has_value) {
+            script_path = argv[++i];
+        } else if (strcmp(arg, "--record") == 0 && has_value) {
+            record_path = argv[++i];
+        } else if (strcmp(arg, "--replay") == 0 && has_value) {
+            replay_path = argv[++i];
+        } else if (strcmp(arg, "--collision-bench") == 0 && has_value) {
+            collision_entities = atoi(argv[++i]);
+        } else if (strcmp(arg, "--chaser-bench") == 0 && has_value) {
+            chaser_bench = atoi(argv[++i]);
+        } else if (strcmp(arg, "--threads") == 0 && has_value) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(arg, "--chasers") == 0 && has_value) {
+            config.chasers = atoi(argv[++i]);
+        } else if (strcmp(arg, "--size") == 0 && has_value) {
+            config.size = atoi(argv[++i]);
+        } else if (strcmp(arg, "--seed") == 0 && has_value) {
+            config.seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "--algo") == 0 && has_value) {
+            if (!mazegen_parse_algorithm(argv[++i], &config.algorithm)) {
+                fprintf(stderr, "Algoritmo desconhecido: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(arg, "--collectibles") == 0 && has_value) {
+            config.collectibles = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Uso: %s [--instances N] [--steps N] [--script arquivo] [--record arquivo] [--replay arquivo] [--collision-bench N] [--chaser-bench N] [--threads N] [--chasers N] [--size N] [--seed S] [--algo nome] [--collectibles N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (replay_path) return verify_replay(replay_path);
+    if (instances <= 0 || steps <= 0) return 1;
+
+    static Script script;
+    if (script_path && !load_script(script_path, &script)) return 1;
+
+    World level = {0};
+    if (!sim_load_level(&level, &config)) {
+        fprintf(stderr, "Falha ao carregar o labirinto\n");
+        return 1;
+    }
+
+    if (collision_entities > 0) {
+        int result = benchmark_collision(&level, collision_entities, steps, config.seed);
+        world_destroy(&level);
+        return result;
+    }
+    if (chaser_bench > 0) {
+        int result = benchmark_chasers(&level, chaser_bench, threads, steps);
+        world_destroy(&level);
+        return result;
+    }
+    if (config.chasers > 0 && !jobs_init(threads)) return 1;
+
+    Sim* sims = calloc(instances, sizeof(Sim));
+    if (!sims) return 1;
+    for (int i = 0; i < instances; i++) {
+        if (!sim_init(&sims[i], &level) || !sim_enable_chasers(&sims[i], config.chasers)) return 1;
+    }
+
+    Replay recording;
+    if (record_path && !replay_open_write(&recording, record_path, &config)) return 1;
+
+    double start = platform_time_seconds();
+    long long total_steps = 0;
+    int won = 0, lost = 0, pickups = 0;
+    for (int i = 0; i < instances; i++) {
+        total_steps += run_instance(&sims[i], script_path ? &script : NULL, config.seed + (uint32_t)i * 7919u, steps,
+                                    record_path && i == 0 ? &recording : NULL);
+        if (sims[i].state == STATE_WON) won++;
+        if (sims[i].state == STATE_LOST) lost++;
+        pickups += sims[i].collectibles_eaten;
+    }
+    double elapsed = platform_time_seconds() - start;
+    if (record_path) replay_close(&recording);
+
+    printf("Labirinto %dx%d, %d instancias, ate %d passos cada\n", level.width, level.height, instances, steps);
+    printf("Tempo: %.3f s (%.0f passos/s)\n", elapsed, elapsed > 0.0 ? total_steps / elapsed : 0.0);
+    printf("Vitorias: %d, derrotas: %d, esferas coletadas: %d de %d\n", won, lost, pickups, instances * world_count_tiles(&level, 2));
+
+    for (int i = 0; i < instances; i++) {
+        sim_free(&sims[i]);
+    }
+    free(sims);
+    jobs_shutdown();
+    world_destroy(&level);
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include <stdlib.h>
+#include <string.h>
+#include "snapshot.h"
+#include "thread.h"
+
+#define SNAPSHOT_FRESH 4
+#define SNAPSHOT_INDEX_MASK 3
+
+bool snapshot_buffer_init(SnapshotBuffer* buffer, int max_changes, int max_chasers) {
+    memset(buffer, 0, sizeof(*buffer));
+    for (int i = 0; i < 3; i++) {
+        SimSnapshot* slot = &buffer->slots[i];
+        slot->changes = malloc((max_changes > 0 ? max_changes : 1) * sizeof(CellChange));
+        // One block holds all four pursuer arrays.
+        slot->chaser_x = malloc((max_chasers > 0 ? max_chasers : 1) * 4 * sizeof(float));
+        if (!slot->changes || !slot->chaser_x) {
+            snapshot_buffer_free(buffer);
+            return false;
+        }
+        slot->chaser_z = slot->chaser_x + max_chasers;
+        slot->chaser_prev_x = slot->chaser_z + max_chasers;
+        slot->chaser_prev_z = slot->chaser_prev_x + max_chasers;
+        slot->generation = -1;
+    }
+    buffer->front = 0;
+    buffer->middle = 1;
+    buffer->back = 2;
+    return true;
+}
+
+SimSnapshot* snapshot_write_begin(SnapshotBuffer* buffer) {
+    return &buffer->slots[buffer->back];
+}
+
+void snapshot_publish(SnapshotBuffer* buffer) {
+    buffer->back = thread_atomic_exchange(&buffer->middle, buffer->back | SNAPSHOT_FRESH) & SNAPSHOT_INDEX_MASK;
+}
+
+const SimSnapshot* snapshot_acquire(SnapshotBuffer* buffer) {
+    if (thread_atomic_load(&buffer->middle) & SNAPSHOT_FRESH) {
+        buffer->front = thread_atomic_exchange(&buffer->middle, buffer->front) & SNAPSHOT_INDEX_MASK;
+    }
+    return &buffer->slots[buffer->front];
+}
+
+void snapshot_buffer_free(SnapshotBuffer* buffer) {
+    for (int i = 0; i < 3; i++) {
+        free(buffer->slots[i].changes);
+        free(buffer->slots[i].chaser_x);
+        buffer->slots[i].changes = NULL;
+        buffer->slots[i].chaser_x = NULL;
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+#include "config.h"
+#include "pathfind.h"
+
+typedef struct {
+    int x, z;
+} CellChange;
+
+// What the renderer needs from one simulation tick. The level itself never
+// changes; changes lists every collectible cell emptied since the level was
+// last reset, in pickup order.
+typedef struct {
+    int generation;
+    double time;
+    Player player;
+    GameState state;
+    int collectibles_eaten;
+    int total_collectibles;
+    float escape_timer;
+    bool playing_back;
+    // Mouse look the simulation has consumed so far.
+    double look_turn, look_tilt;
+    // Steps to the guide's goal and the next cell toward it; -1 without a guide.
+    int guide_distance;
+    PathCell guide_next;
+    CellChange* changes;
+    int change_count;
+    // Pursuer positions at the start and the end of the tick.
+    float* chaser_x;
+    float* chaser_z;
+    float* chaser_prev_x;
+    float* chaser_prev_z;
+    int chaser_count;
+} SimSnapshot;
+
+// Lock-free triple buffer with one writer and one reader: the writer fills
+// its back slot and swaps it into the middle, the reader swaps the middle
+// out whenever it holds a newer snapshot. Neither side ever waits.
+typedef struct {
+    SimSnapshot slots[3];
+    volatile int middle;
+    int back, front;
+} SnapshotBuffer;
+
+bool snapshot_buffer_init(SnapshotBuffer* buffer, int max_changes, int max_chasers);
+SimSnapshot* snapshot_write_begin(SnapshotBuffer* buffer);
+void snapshot_publish(SnapshotBuffer* buffer);
+// Returns the newest published snapshot; it stays valid until the next call.
+const SimSnapshot* snapshot_acquire(SnapshotBuffer* buffer);
+void snapshot_buffer_free(SnapshotBuffer* buffer);
+
+#endif
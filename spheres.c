@@ -0,0 +1,285 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+#include "spheres.h"
+#include "glload.h"
+#include "shader.h"
+#include "mesh.h"
+#include "glstate.h"
+
+static const int lod_segments[SPHERE_LOD_COUNT] = {16, 10, 6};
+static const float lod_distances[SPHERE_LOD_COUNT - 1] = {2.0f, 5.0f};
+
+static const char* vertex_source =
+    "#version 120\n"
+    "attribute vec4 sphere_instance;\n"
+    "varying vec3 eye_position;\n"
+    "varying vec3 eye_normal;\n"
+    "void main() {\n"
+    "    vec4 eye = gl_ModelViewMatrix * vec4(gl_Vertex.xyz * sphere_instance.w + sphere_instance.xyz, 1.0);\n"
+    "    eye_position = eye.xyz;\n"
+    "    eye_normal = gl_NormalMatrix * gl_Normal;\n"
+    "    gl_FrontColor = gl_Color;\n"
+    "    gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+    "    gl_Position = gl_ProjectionMatrix * eye;\n"
+    "}\n";
+
+// Mirrors the fixed-function terms the spheres use: emission, global ambient
+// and the two attenuated point lights, modulated by the texture.
+static const char* fragment_source =
+    "#version 120\n"
+    "uniform sampler2D sphere_texture;\n"
+    "uniform vec2 lights_enabled;\n"
+    "varying vec3 eye_position;\n"
+    "varying vec3 eye_normal;\n"
+    "vec3 point_light(int i, vec3 n) {\n"
+    "    vec3 to_light = gl_LightSource[i].position.xyz - eye_position;\n"
+    "    float d = length(to_light);\n"
+    "    float attenuation = 1.0 / (gl_LightSource[i].constantAttenuation +\n"
+    "                               gl_LightSource[i].linearAttenuation * d +\n"
+    "                               gl_LightSource[i].quadraticAttenuation * d * d);\n"
+    "    return attenuation * max(dot(n, to_light / d), 0.0) * gl_LightSource[i].diffuse.rgb;\n"
+    "}\n"
+    "void main() {\n"
+    "    vec3 n = normalize(eye_normal);\n"
+    "    vec3 light = gl_LightModel.ambient.rgb;\n"
+    "    if (lights_enabled.x > 0.5) light += point_light(1, n);\n"
+    "    if (lights_enabled.y > 0.5) light += point_light(2, n);\n"
+    "    vec3 color = min(gl_FrontMaterial.emission.rgb + light * gl_Color.rgb, 1.0);\n"
+    "    gl_FragColor = vec4(color, gl_Color.a) * texture2D(sphere_texture, gl_TexCoord[0].st);\n"
+    "}\n";
+
+static MeshVertex* vertices = NULL;
+static GLuint* indices = NULL;
+static MeshBlock lods[SPHERE_LOD_COUNT];
+static GLuint vbo = 0, ibo = 0, instance_vbo = 0;
+static GLuint display_lists = 0;
+static GLuint program = 0;
+static GLint instance_location = -1, lights_location = -1;
+static bool instanced = false;
+
+static SphereInstance* sorted = NULL;
+static int sorted_capacity = 0;
+
+static void build_sphere(int segments, int* vertex_count, int* index_count) {
+    int base = *vertex_count;
+    for (int i = 0; i <= segments; i++) {
+        float phi = PI * i / segments;
+        for (int j = 0; j <= segments; j++) {
+            float theta = 2.0f * PI * j / segments;
+            MeshVertex* v = &vertices[(*vertex_count)++];
+            v->nx = sinf(phi) * cosf(theta);
+            v->ny = cosf(phi);
+            v->nz = sinf(phi) * sinf(theta);
+            v->x = v->nx;
+            v->y = v->ny;
+            v->z = v->nz;
+            v->u = (float)j / segments;
+            v->v = 1.0f - (float)i / segments;
+        }
+    }
+
+    int row = segments + 1;
+    for (int i = 0; i < segments; i++) {
+        for (int j = 0; j < segments; j++) {
+            GLuint a = base + i * row + j;
+            GLuint b = a + row;
+            GLuint c = b + 1;
+            GLuint d = a + 1;
+            GLuint* out = &indices[*index_count];
+            out[0] = a; out[1] = d; out[2] = b;
+            out[3] = d; out[4] = c; out[5] = b;
+            *index_count += 6;
+        }
+    }
+}
+
+static void set_client_arrays(const char* base) {
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3, GL_FLOAT, sizeof(MeshVertex), base + offsetof(MeshVertex, x));
+    glNormalPointer(GL_FLOAT, sizeof(MeshVertex), base + offsetof(MeshVertex, nx));
+    glTexCoordPointer(2, GL_FLOAT, sizeof(MeshVertex), base + offsetof(MeshVertex, u));
+}
+
+static void unset_client_arrays() {
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+bool spheres_init() {
+    int total_vertices = 0, total_indices = 0;
+    for (int l = 0; l < SPHERE_LOD_COUNT; l++) {
+        total_vertices += (lod_segments[l] + 1) * (lod_segments[l] + 1);
+        total_indices += lod_segments[l] * lod_segments[l] * 6;
+    }
+    vertices = malloc(total_vertices * sizeof(MeshVertex));
+    indices = malloc(total_indices * sizeof(GLuint));
+    if (!vertices || !indices) {
+        spheres_cleanup();
+        return false;
+    }
+
+    int vertex_count = 0, index_count = 0;
+    for (int l = 0; l < SPHERE_LOD_COUNT; l++) {
+        lods[l].first_index = index_count;
+        build_sphere(lod_segments[l], &vertex_count, &index_count);
+        lods[l].index_count = index_count - lods[l].first_index;
+    }
+
+    if (glload_has_vbo()) {
+        gl_gen_buffers(1, &vbo);
+        gl_bind_buffer(GL_ARRAY_BUFFER, vbo);
+        gl_buffer_data(GL_ARRAY_BUFFER, vertex_count * sizeof(MeshVertex), vertices, GL_STATIC_DRAW);
+        gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+
+        gl_gen_buffers(1, &ibo);
+        gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+        gl_buffer_data(GL_ELEMENT_ARRAY_BUFFER, index_count * sizeof(GLuint), indices, GL_STATIC_DRAW);
+        gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    } else {
+        display_lists = glGenLists(SPHERE_LOD_COUNT);
+        for (int l = 0; l < SPHERE_LOD_COUNT; l++) {
+            glNewList(display_lists + l, GL_COMPILE);
+            set_client_arrays((const char*)vertices);
+            glDrawElements(GL_TRIANGLES, lods[l].index_count, GL_UNSIGNED_INT, indices + lods[l].first_index);
+            unset_client_arrays();
+            glEndList();
+        }
+    }
+
+    if (glload_has_instancing()) {
+        program = shader_build("esferas", vertex_source, fragment_source);
+        if (program) {
+            instance_location = gl_get_attrib_location(program, "sphere_instance");
+            lights_location = gl_get_uniform_location(program, "lights_enabled");
+            gl_use_program(program);
+            gl_uniform1i(gl_get_uniform_location(program, "sphere_texture"), 0);
+            gl_use_program(0);
+            gl_gen_buffers(1, &instance_vbo);
+            instanced = instance_location >= 0;
+        }
+    }
+
+    free(vertices);
+    free(indices);
+    vertices = NULL;
+    indices = NULL;
+    return true;
+}
+
+static int lod_for(const SphereInstance* s, float eye_x, float eye_y, float eye_z) {
+    float dx = s->x - eye_x, dy = s->y - eye_y, dz = s->z - eye_z;
+    float dist_sq = dx * dx + dy * dy + dz * dz;
+    int lod = 0;
+    while (lod < SPHERE_LOD_COUNT - 1 && dist_sq > lod_distances[lod] * lod_distances[lod]) lod++;
+    return lod;
+}
+
+static int draw_instanced(int lod_start[SPHERE_LOD_COUNT + 1]) {
+    int draw_calls = 0;
+    gl_bind_buffer(GL_ARRAY_BUFFER, instance_vbo);
+    gl_buffer_data(GL_ARRAY_BUFFER, lod_start[SPHERE_LOD_COUNT] * sizeof(SphereInstance), sorted, GL_STREAM_DRAW);
+
+    glstate_use_program(program);
+    gl_uniform2f(lights_location, glIsEnabled(GL_LIGHT1) ? 1.0f : 0.0f, glIsEnabled(GL_LIGHT2) ? 1.0f : 0.0f);
+    gl_enable_vertex_attrib_array(instance_location);
+    gl_vertex_attrib_divisor(instance_location, 1);
+
+    gl_bind_buffer(GL_ARRAY_BUFFER, vbo);
+    gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    set_client_arrays(NULL);
+    for (int l = 0; l < SPHERE_LOD_COUNT; l++) {
+        int count = lod_start[l + 1] - lod_start[l];
+        if (count == 0) continue;
+        gl_bind_buffer(GL_ARRAY_BUFFER, instance_vbo);
+        gl_vertex_attrib_pointer(instance_location, 4, GL_FLOAT, GL_FALSE, sizeof(SphereInstance),
+                                 (const char*)NULL + lod_start[l] * sizeof(SphereInstance));
+        gl_draw_elements_instanced(GL_TRIANGLES, lods[l].index_count, GL_UNSIGNED_INT,
+                                   (const char*)NULL + lods[l].first_index * sizeof(GLuint), count);
+        draw_calls++;
+    }
+    unset_client_arrays();
+
+    gl_vertex_attrib_divisor(instance_location, 0);
+    gl_disable_vertex_attrib_array(instance_location);
+    glstate_use_program(0);
+    gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+    return draw_calls;
+}
+
+static int draw_one_by_one(int lod_start[SPHERE_LOD_COUNT + 1]) {
+    glstate_set(GLSTATE_NORMALIZE, true);
+    if (vbo) {
+        gl_bind_buffer(GL_ARRAY_BUFFER, vbo);
+        gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+        set_client_arrays(NULL);
+    }
+    for (int l = 0; l < SPHERE_LOD_COUNT; l++) {
+        for (int i = lod_start[l]; i < lod_start[l + 1]; i++) {
+            glPushMatrix();
+            glTranslatef(sorted[i].x, sorted[i].y, sorted[i].z);
+            glScalef(sorted[i].radius, sorted[i].radius, sorted[i].radius);
+            if (vbo) {
+                glDrawElements(GL_TRIANGLES, lods[l].index_count, GL_UNSIGNED_INT,
+                               (const char*)NULL + lods[l].first_index * sizeof(GLuint));
+            } else {
+                glCallList(display_lists + l);
+            }
+            glPopMatrix();
+        }
+    }
+    if (vbo) {
+        unset_client_arrays();
+        gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        gl_bind_buffer(GL_ARRAY_BUFFER, 0);
+    }
+    glstate_set(GLSTATE_NORMALIZE, false);
+    return lod_start[SPHERE_LOD_COUNT];
+}
+
+int spheres_draw(const SphereInstance* instances, int count, float eye_x, float eye_y, float eye_z) {
+    if (count <= 0) return 0;
+
+    if (count > sorted_capacity) {
+        SphereInstance* grown = realloc(sorted, count * sizeof(SphereInstance));
+        if (!grown) return 0;
+        sorted = grown;
+        sorted_capacity = count;
+    }
+
+    // Counting sort by LOD so each level is one contiguous instance range.
+    int lod_start[SPHERE_LOD_COUNT + 1] = {0};
+    for (int i = 0; i < count; i++) {
+        lod_start[lod_for(&instances[i], eye_x, eye_y, eye_z) + 1]++;
+    }
+    for (int l = 0; l < SPHERE_LOD_COUNT; l++) lod_start[l + 1] += lod_start[l];
+    int next[SPHERE_LOD_COUNT];
+    for (int l = 0; l < SPHERE_LOD_COUNT; l++) next[l] = lod_start[l];
+    for (int i = 0; i < count; i++) {
+        sorted[next[lod_for(&instances[i], eye_x, eye_y, eye_z)]++] = instances[i];
+    }
+
+    return instanced ? draw_instanced(lod_start) : draw_one_by_one(lod_start);
+}
+
+void spheres_cleanup() {
+    if (vbo) gl_delete_buffers(1, &vbo);
+    if (ibo) gl_delete_buffers(1, &ibo);
+    if (instance_vbo) gl_delete_buffers(1, &instance_vbo);
+    if (display_lists) glDeleteLists(display_lists, SPHERE_LOD_COUNT);
+    if (program) gl_delete_program(program);
+    vbo = ibo = instance_vbo = display_lists = program = 0;
+    instanced = false;
+    free(vertices);
+    free(indices);
+    free(sorted);
+    vertices = NULL;
+    indices = NULL;
+    sorted = NULL;
+    sorted_capacity = 0;
+}
@@ -0,0 +1,19 @@
+#ifndef SPHERES_H
+#define SPHERES_H
+
+#include <stdbool.h>
+
+#define SPHERE_LOD_COUNT 3
+
+typedef struct {
+    float x, y, z;
+    float radius;
+} SphereInstance;
+
+// Unit spheres are tessellated once per LOD; each frame's instances are
+// bucketed by distance to the eye and drawn with one instanced call per LOD.
+bool spheres_init();
+int spheres_draw(const SphereInstance* instances, int count, float eye_x, float eye_y, float eye_z);
+void spheres_cleanup();
+
+#endif
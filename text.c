@@ -0,0 +1,220 @@
+#include "text.h"
+#include <GL/glut.h>
+#include <stdio.h>
+#include <math.h>
+#include "glload.h"
+#include "glstate.h"
+
+#define TEXT_FIRST_CHAR 32
+#define TEXT_LAST_CHAR 126
+#define TEXT_GLYPHS (TEXT_LAST_CHAR - TEXT_FIRST_CHAR + 1)
+#define TEXT_ATLAS_WIDTH 512
+#define TEXT_PADDING 1
+// A white block in the atlas corner lets rectangles share the glyphs' draw.
+#define TEXT_WHITE_SIZE 4
+#define TEXT_MAX_QUADS 4096
+
+typedef struct {
+    int x, y, advance;
+} Glyph;
+
+// Heights and descents of the GLUT fonts, which plain GLUT cannot query.
+typedef struct {
+    void* glut_font;
+    int height, descent;
+} FontAtlas;
+
+typedef struct {
+    GLfloat x, y, u, v;
+    GLubyte color[4];
+} TextVertex;
+
+static FontAtlas fonts[TEXT_FONT_COUNT] = {
+    {GLUT_BITMAP_TIMES_ROMAN_24, 29, 7},
+    {GLUT_BITMAP_HELVETICA_12, 15, 3}
+};
+
+static Glyph glyphs[TEXT_FONT_COUNT][TEXT_GLYPHS];
+static GLuint atlas_texture = 0;
+static int atlas_height = 0;
+static TextVertex vertices[TEXT_MAX_QUADS * 4];
+static int vertex_count = 0;
+static GLubyte current_color[4] = {255, 255, 255, 255};
+
+static const Glyph* find_glyph(TextFont font, char c) {
+    if (c < TEXT_FIRST_CHAR || c > TEXT_LAST_CHAR) c = '?';
+    return &glyphs[font][c - TEXT_FIRST_CHAR];
+}
+
+static int cell_height(const FontAtlas* font) {
+    return font->height + 2 * TEXT_PADDING;
+}
+
+// Packs every glyph cell into rows of TEXT_ATLAS_WIDTH; returns the height used.
+static int layout_atlas() {
+    int x = TEXT_WHITE_SIZE, y = 0, row_height = TEXT_WHITE_SIZE;
+    for (int f = 0; f < TEXT_FONT_COUNT; f++) {
+        const FontAtlas* font = &fonts[f];
+        for (int c = TEXT_FIRST_CHAR; c <= TEXT_LAST_CHAR; c++) {
+            Glyph* glyph = &glyphs[f][c - TEXT_FIRST_CHAR];
+            glyph->advance = glutBitmapWidth(font->glut_font, c);
+            int width = glyph->advance + 2 * TEXT_PADDING;
+            if (x + width > TEXT_ATLAS_WIDTH) {
+                x = 0;
+                y += row_height;
+                row_height = 0;
+            }
+            glyph->x = x;
+            glyph->y = y;
+            x += width;
+            if (cell_height(font) > row_height) row_height = cell_height(font);
+        }
+    }
+    return y + row_height;
+}
+
+static void draw_glyphs() {
+    glClearColor(0.0, 0.0, 0.0, 0.0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glColor4f(1.0, 1.0, 1.0, 1.0);
+    glRecti(0, 0, TEXT_WHITE_SIZE, TEXT_WHITE_SIZE);
+    for (int f = 0; f < TEXT_FONT_COUNT; f++) {
+        const FontAtlas* font = &fonts[f];
+        for (int c = TEXT_FIRST_CHAR; c <= TEXT_LAST_CHAR; c++) {
+            const Glyph* glyph = &glyphs[f][c - TEXT_FIRST_CHAR];
+            glRasterPos2i(glyph->x + TEXT_PADDING, glyph->y + TEXT_PADDING + font->descent);
+            glutBitmapCharacter(font->glut_font, c);
+        }
+    }
+}
+
+bool text_init() {
+    int used = layout_atlas();
+    atlas_height = 1;
+    while (atlas_height < used) atlas_height *= 2;
+
+    // Glyphs are drawn once into an offscreen target (or the back buffer) and copied out.
+    GLuint fbo = 0, color_buffer = 0;
+    if (glload_has_fbo()) {
+        gl_gen_framebuffers(1, &fbo);
+        gl_gen_renderbuffers(1, &color_buffer);
+        gl_bind_framebuffer(GL_FRAMEBUFFER, fbo);
+        gl_bind_renderbuffer(GL_RENDERBUFFER, color_buffer);
+        gl_renderbuffer_storage(GL_RENDERBUFFER, GL_RGBA8, TEXT_ATLAS_WIDTH, atlas_height);
+        gl_framebuffer_renderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_buffer);
+        gl_bind_renderbuffer(GL_RENDERBUFFER, 0);
+        if (gl_check_framebuffer_status(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            gl_bind_framebuffer(GL_FRAMEBUFFER, 0);
+            gl_delete_renderbuffers(1, &color_buffer);
+            gl_delete_framebuffers(1, &fbo);
+            fbo = 0;
+        }
+    }
+    if (!fbo) glReadBuffer(GL_BACK);
+
+    glPushAttrib(GL_ENABLE_BIT | GL_VIEWPORT_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glViewport(0, 0, TEXT_ATLAS_WIDTH, atlas_height);
+    glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity();
+    gluOrtho2D(0, TEXT_ATLAS_WIDTH, 0, atlas_height);
+    glMatrixMode(GL_MODELVIEW); glPushMatrix(); glLoadIdentity();
+
+    draw_glyphs();
+
+    GLint bound = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+    glGenTextures(1, &atlas_texture);
+    glBindTexture(GL_TEXTURE_2D, atlas_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 0, 0, TEXT_ATLAS_WIDTH, atlas_height, 0);
+    glBindTexture(GL_TEXTURE_2D, bound);
+
+    glMatrixMode(GL_PROJECTION); glPopMatrix();
+    glMatrixMode(GL_MODELVIEW); glPopMatrix();
+    glPopAttrib();
+    if (fbo) {
+        gl_bind_framebuffer(GL_FRAMEBUFFER, 0);
+        gl_delete_renderbuffers(1, &color_buffer);
+        gl_delete_framebuffers(1, &fbo);
+    } else {
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+    return atlas_texture != 0;
+}
+
+int text_width(TextFont font, const char* text) {
+    int width = 0;
+    for (const char* c = text; *c != '\0'; c++) width += find_glyph(font, *c)->advance;
+    return width;
+}
+
+void text_begin() {
+    vertex_count = 0;
+}
+
+void text_color(float r, float g, float b, float a) {
+    current_color[0] = (GLubyte)(r * 255.0f + 0.5f);
+    current_color[1] = (GLubyte)(g * 255.0f + 0.5f);
+    current_color[2] = (GLubyte)(b * 255.0f + 0.5f);
+    current_color[3] = (GLubyte)(a * 255.0f + 0.5f);
+}
+
+static void add_quad(float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1) {
+    if (vertex_count + 4 > TEXT_MAX_QUADS * 4) return;
+    float corners[4][4] = {{x0, y0, u0, v0}, {x1, y0, u1, v0}, {x1, y1, u1, v1}, {x0, y1, u0, v1}};
+    for (int i = 0; i < 4; i++) {
+        TextVertex* v = &vertices[vertex_count++];
+        v->x = corners[i][0]; v->y = corners[i][1];
+        v->u = corners[i][2]; v->v = corners[i][3];
+        v->color[0] = current_color[0]; v->color[1] = current_color[1];
+        v->color[2] = current_color[2]; v->color[3] = current_color[3];
+    }
+}
+
+void text_add(TextFont font, float x, float y, const char* text) {
+    const FontAtlas* atlas = &fonts[font];
+    // Whole pixels keep the nearest-filtered glyphs identical to the bitmap originals.
+    float pen = floorf(x + 0.5f);
+    float bottom = floorf(y + 0.5f) - atlas->descent - TEXT_PADDING;
+    for (const char* c = text; *c != '\0'; c++) {
+        const Glyph* glyph = find_glyph(font, *c);
+        if (*c != ' ') {
+            float width = glyph->advance + 2 * TEXT_PADDING;
+            add_quad(pen - TEXT_PADDING, bottom, pen - TEXT_PADDING + width, bottom + cell_height(atlas),
+                     (float)glyph->x / TEXT_ATLAS_WIDTH, (float)glyph->y / atlas_height,
+                     (glyph->x + width) / TEXT_ATLAS_WIDTH, (float)(glyph->y + cell_height(atlas)) / atlas_height);
+        }
+        pen += glyph->advance;
+    }
+}
+
+void text_add_rect(float x0, float y0, float x1, float y1) {
+    float u = (TEXT_WHITE_SIZE * 0.5f) / TEXT_ATLAS_WIDTH, v = (TEXT_WHITE_SIZE * 0.5f) / atlas_height;
+    add_quad(x0, y0, x1, y1, u, v, u, v);
+}
+
+void text_flush() {
+    if (vertex_count == 0) return;
+    glstate_set(GLSTATE_TEXTURE_2D, true);
+    glstate_bind_texture(0, atlas_texture);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(TextVertex), &vertices[0].x);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(TextVertex), &vertices[0].u);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(TextVertex), vertices[0].color);
+    glDrawArrays(GL_QUADS, 0, vertex_count);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    vertex_count = 0;
+}
+
+void text_cleanup() {
+    if (atlas_texture) glDeleteTextures(1, &atlas_texture);
+    atlas_texture = 0;
+}
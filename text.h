@@ -0,0 +1,26 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include <stdbool.h>
+
+typedef enum {
+    TEXT_FONT_LARGE,
+    TEXT_FONT_SMALL,
+    TEXT_FONT_COUNT
+} TextFont;
+
+// Rasterizes the GLUT bitmap fonts into one texture atlas; needs a current GL context.
+bool text_init();
+int text_width(TextFont font, const char* text);
+
+// Text and solid rectangles queue up between text_begin and text_flush and go
+// out in one draw, in the order they were added. Coordinates are window pixels,
+// y up, with text positioned by its baseline like glRasterPos.
+void text_begin();
+void text_color(float r, float g, float b, float a);
+void text_add(TextFont font, float x, float y, const char* text);
+void text_add_rect(float x0, float y0, float x1, float y1);
+void text_flush();
+void text_cleanup();
+
+#endif
@@ -1,46 +1,556 @@
 #include "texture.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include "glload.h"
+#include "thread.h"
+#include "platform.h"
+#include "bmp.h"
+#include "pack.h"
+#include "config.h"
 
-GLuint load_texture_bmp(const char* filename) {
-    GLuint texture_id;
-    unsigned char header[54];
-    unsigned int data_pos, width, height, image_size;
-    unsigned char* data;
+#define TEXTURE_MAX_TEXTURES 32
+#define TEXTURE_LOADER_THREADS 2
+#define TEXTURE_SLICE_BYTES (256 * 1024)
+#define TEXTURE_STAGING_BUFFERS 3
 
-    FILE* file = fopen(filename, "rb");
-    if (!file) { printf("Imagem no foi aberta: %s\n", filename); return 0; }
-    if (fread(header, 1, 54, file) != 54) { fclose(file); printf("No  um arquivo BMP: %s\n", filename); return 0; }
-    if (header[0] != 'B' || header[1] != 'M') { fclose(file); printf("No  um arquivo BMP: %s\n", filename); return 0; }
+typedef enum {
+    TEXTURE_UNLOADED,
+    TEXTURE_QUEUED,
+    TEXTURE_LOADING,
+    TEXTURE_LOADED,
+    TEXTURE_PARKED,
+    TEXTURE_UPLOADING,
+    TEXTURE_RESIDENT,
+    TEXTURE_FAILED
+} TextureState;
 
-    data_pos = *(int*)&(header[0x0A]);
-    width = *(int*)&(header[0x12]);
-    height = *(int*)&(header[0x16]);
-    image_size = *(int*)&(header[0x22]);
+// GPU-ready pixels produced by a loader thread. Packed levels are tightly packed, bottom-up
+// rows; a bare BMP is uploaded straight from its mapping, 4-byte aligned rows in file order.
+typedef struct {
+    GLenum format, type;
+    GLint internal_format;
+    int level_count;
+    int widths[PACK_MAX_MIPS], heights[PACK_MAX_MIPS];
+    size_t row_bytes[PACK_MAX_MIPS];
+    const unsigned char* levels[PACK_MAX_MIPS];
+    bool generate_mips;
+    bool top_down;
+    int alignment;
+    bool mapped;
+    MappedFile file;
+} TexturePixels;
 
-    if (image_size == 0) image_size = width * height * 3;
-    if (data_pos == 0) data_pos = 54;
+typedef struct {
+    char filename[256];
+    TextureState state;
+    GLuint texture;
+    TexturePixels pixels;
+    int level, row;
+    int refs;
+    size_t bytes;
+    unsigned long last_used;
+    double requested_at;
+} TextureEntry;
 
-    data = (unsigned char*)malloc(image_size);
-    fseek(file, data_pos, SEEK_SET);
-    fread(data, 1, image_size, file);
-    fclose(file);
+// Handles waiting for a loader thread or for the GL thread, most urgent first.
+typedef struct {
+    TextureHandle items[TEXTURE_MAX_TEXTURES];
+    int count;
+} TextureQueue;
 
-    for (unsigned int i = 0; i < image_size; i += 3) {
-        unsigned char temp = data[i];
-        data[i] = data[i+2];
-        data[i+2] = temp;
+static PackArchive archive;
+static bool archive_open = false;
+
+static TextureEntry textures[TEXTURE_MAX_TEXTURES];
+static int texture_count = 0;
+static TextureQueue load_queue, upload_queue;
+static ThreadMutex* texture_mutex = NULL;
+static ThreadCond* texture_cond = NULL;
+static Thread* loaders[TEXTURE_LOADER_THREADS];
+static bool stopping = false;
+
+static size_t budget_bytes = (size_t)TEXTURE_BUDGET_MB * 1024 * 1024;
+static size_t resident_bytes = 0, peak_bytes = 0;
+static long load_count = 0, eviction_count = 0, miss_count = 0;
+static unsigned long frame_counter = 1;
+
+static GLuint placeholder_texture = 0;
+static GLuint staging_buffers[TEXTURE_STAGING_BUFFERS];
+static int next_staging = 0;
+
+bool texture_archive_open(const char* archive_path, const char* directory) {
+    double start = platform_time_seconds();
+    texture_archive_close();
+
+    bool stale_timestamps = false;
+    archive_open = pack_open(&archive, archive_path);
+    if (archive_open && !pack_is_current(&archive, directory, &stale_timestamps)) {
+        texture_archive_close();
+    } else if (archive_open && stale_timestamps) {
+        // Windows does not let a mapped file be written, so the index is patched with it closed.
+        texture_archive_close();
+        if (!pack_refresh_timestamps(archive_path)) {
+            fprintf(stderr, "Falha ao atualizar as datas do arquivo de texturas: %s\n", archive_path);
+        }
+        archive_open = pack_open(&archive, archive_path);
+    }
+    if (!archive_open) {
+        printf("Reconstruindo o arquivo de texturas %s\n", archive_path);
+        archive_open = pack_build(directory, archive_path, false, NULL) && pack_open(&archive, archive_path);
+    }
+    if (archive_open) {
+        printf("Arquivo de texturas %s: %d texturas, %.2f ms\n", archive_path, archive.entry_count,
+               (platform_time_seconds() - start) * 1000.0);
+    }
+    return archive_open;
+}
+
+void texture_archive_close() {
+    if (archive_open) pack_close(&archive);
+    archive_open = false;
+}
+
+static bool load_packed_pixels(const PackEntry* entry, TexturePixels* pixels) {
+    static const size_t texel_bytes[] = {0, 3, 4, 2};
+    pixels->format = entry->format == PACK_FORMAT_RGBA8 ? GL_RGBA : GL_RGB;
+    pixels->type = entry->format == PACK_FORMAT_RGB565 ? GL_UNSIGNED_SHORT_5_6_5 : GL_UNSIGNED_BYTE;
+    pixels->internal_format = entry->format == PACK_FORMAT_RGBA8 ? GL_RGBA8 : (entry->format == PACK_FORMAT_RGB565 ? GL_RGB5 : GL_RGB8);
+    pixels->level_count = entry->mip_count;
+    pixels->alignment = 1;
+
+    // Reading one byte per page pulls the mapping in here instead of stalling the GL thread.
+    volatile unsigned char sink = 0;
+    for (int m = 0; m < entry->mip_count; m++) {
+        const PackMip* mip = &entry->mips[m];
+        pixels->widths[m] = mip->width;
+        pixels->heights[m] = mip->height;
+        pixels->row_bytes[m] = mip->width * texel_bytes[entry->format];
+        pixels->levels[m] = pack_mip_data(&archive, mip);
+        for (uint32_t i = 0; i < mip->size; i += 4096) sink ^= pixels->levels[m][i];
+    }
+    (void)sink;
+    return true;
+}
+
+static bool load_bmp_pixels(const char* filename, TexturePixels* pixels) {
+    MappedFile file;
+    if (!platform_map_file(filename, &file)) return false;
+
+    BmpImage image;
+    const char* error = bmp_parse(&file, &image);
+    if (error) {
+        printf("Nao e um arquivo BMP (%s): %s\n", filename, error);
+        platform_unmap_file(&file);
+        return false;
+    }
+
+    // The rows are uploaded straight from the mapping, which stays open until the upload
+    // finishes; touching each page here keeps the faults off the GL thread.
+    volatile unsigned char sink = 0;
+    for (size_t i = 0; i < image.stride * image.height; i += 4096) sink ^= image.pixels[i];
+    (void)sink;
+    pixels->file = file;
+    pixels->mapped = true;
+
+    pixels->format = image.bits == 32 ? GL_BGRA : GL_BGR;
+    pixels->type = GL_UNSIGNED_BYTE;
+    pixels->internal_format = image.has_alpha ? GL_RGBA8 : GL_RGB8;
+    pixels->level_count = 1;
+    pixels->widths[0] = image.width;
+    pixels->heights[0] = image.height;
+    pixels->row_bytes[0] = image.stride;
+    pixels->levels[0] = image.pixels;
+    pixels->top_down = image.top_down;
+    pixels->alignment = 4;
+    pixels->generate_mips = gl_generate_mipmap || glload_has_auto_mipmap();
+    return true;
+}
+
+static void release_pixels(TexturePixels* pixels) {
+    if (pixels->mapped) platform_unmap_file(&pixels->file);
+    pixels->mapped = false;
+}
+
+static const unsigned char* pixels_row(const TexturePixels* pixels, int level, int y) {
+    int row = pixels->top_down ? pixels->heights[level] - 1 - y : y;
+    return pixels->levels[level] + (size_t)row * pixels->row_bytes[level];
+}
+
+static void queue_push(TextureQueue* queue, TextureHandle handle, bool urgent) {
+    if (queue->count == TEXTURE_MAX_TEXTURES) return;
+    if (urgent) {
+        memmove(queue->items + 1, queue->items, queue->count * sizeof(TextureHandle));
+        queue->items[0] = handle;
+    } else {
+        queue->items[queue->count] = handle;
+    }
+    queue->count++;
+}
+
+static TextureHandle queue_remove(TextureQueue* queue, int index) {
+    TextureHandle handle = queue->items[index];
+    queue->count--;
+    memmove(queue->items + index, queue->items + index + 1, (queue->count - index) * sizeof(TextureHandle));
+    return handle;
+}
+
+static TextureHandle queue_pop(TextureQueue* queue) {
+    return queue_remove(queue, 0);
+}
+
+static void queue_promote(TextureQueue* queue, TextureHandle handle) {
+    for (int i = 0; i < queue->count; i++) {
+        if (queue->items[i] != handle) continue;
+        memmove(queue->items + 1, queue->items, i * sizeof(TextureHandle));
+        queue->items[0] = handle;
+        return;
+    }
+}
+
+static void loader_thread(void* arg) {
+    thread_mutex_lock(texture_mutex);
+    for (;;) {
+        while (!stopping && load_queue.count == 0) thread_cond_wait(texture_cond, texture_mutex);
+        if (stopping) break;
+
+        TextureEntry* entry = &textures[queue_pop(&load_queue)];
+        entry->state = TEXTURE_LOADING;
+        thread_mutex_unlock(texture_mutex);
+
+        const PackEntry* packed = archive_open ? pack_find(&archive, entry->filename) : NULL;
+        memset(&entry->pixels, 0, sizeof(entry->pixels));
+        bool ok = packed ? load_packed_pixels(packed, &entry->pixels) : load_bmp_pixels(entry->filename, &entry->pixels);
+
+        thread_mutex_lock(texture_mutex);
+        entry->state = ok ? TEXTURE_LOADED : TEXTURE_FAILED;
+        if (!ok) printf("Imagem nao foi carregada: %s\n", entry->filename);
+    }
+    thread_mutex_unlock(texture_mutex);
+}
+
+bool texture_stream_init() {
+    static const unsigned char grey[3] = {40, 40, 40};
+    glGenTextures(1, &placeholder_texture);
+    glBindTexture(GL_TEXTURE_2D, placeholder_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, grey);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (glload_has_pbo()) gl_gen_buffers(TEXTURE_STAGING_BUFFERS, staging_buffers);
+
+    texture_mutex = thread_mutex_create();
+    texture_cond = thread_cond_create();
+    if (!texture_mutex || !texture_cond) return false;
+    stopping = false;
+    for (int i = 0; i < TEXTURE_LOADER_THREADS; i++) {
+        loaders[i] = thread_start(loader_thread, NULL);
+        if (!loaders[i]) return false;
+    }
+    return true;
+}
+
+TextureHandle texture_register(const char* filename) {
+    for (int i = 0; i < texture_count; i++) {
+        if (strcmp(textures[i].filename, filename) == 0) return i;
+    }
+
+    uint64_t size;
+    int64_t modified;
+    bool packed = archive_open && pack_find(&archive, filename);
+    if (!packed && !platform_file_info(filename, &size, &modified)) {
+        printf("Imagem nao foi aberta: %s\n", filename);
+        return TEXTURE_INVALID;
+    }
+    if (texture_count == TEXTURE_MAX_TEXTURES || strlen(filename) >= sizeof(textures[0].filename)) {
+        return TEXTURE_INVALID;
+    }
+
+    TextureEntry* entry = &textures[texture_count];
+    memset(entry, 0, sizeof(*entry));
+    strcpy(entry->filename, filename);
+    entry->state = TEXTURE_UNLOADED;
+    return texture_count++;
+}
+
+static void request_load(TextureHandle handle, bool urgent) {
+    TextureEntry* entry = &textures[handle];
+    thread_mutex_lock(texture_mutex);
+    if (entry->state == TEXTURE_UNLOADED) {
+        entry->state = TEXTURE_QUEUED;
+        entry->requested_at = platform_time_seconds();
+        queue_push(&load_queue, handle, urgent);
+        queue_push(&upload_queue, handle, urgent);
+        thread_cond_signal(texture_cond);
+    } else if (entry->state == TEXTURE_PARKED) {
+        // Already decoded, so asking again only retries the upload against the budget.
+        entry->state = TEXTURE_LOADED;
+        queue_push(&upload_queue, handle, urgent);
+    } else if (urgent) {
+        if (entry->state == TEXTURE_QUEUED) queue_promote(&load_queue, handle);
+        queue_promote(&upload_queue, handle);
+    }
+    thread_mutex_unlock(texture_mutex);
+}
+
+void texture_acquire(TextureHandle handle) {
+    if (handle < 0 || handle >= texture_count) return;
+    textures[handle].refs++;
+    request_load(handle, true);
+}
+
+void texture_release(TextureHandle handle) {
+    if (handle < 0 || handle >= texture_count || textures[handle].refs == 0) return;
+    textures[handle].refs--;
+}
+
+void texture_prefetch(TextureHandle handle) {
+    if (handle < 0 || handle >= texture_count) return;
+    request_load(handle, false);
+}
+
+GLuint texture_gl_id(TextureHandle handle) {
+    if (handle < 0 || handle >= texture_count) return placeholder_texture;
+    TextureEntry* entry = &textures[handle];
+    if (entry->state != TEXTURE_RESIDENT) {
+        miss_count++;
+        return placeholder_texture;
+    }
+    entry->last_used = frame_counter;
+    return entry->texture;
+}
+
+static void evict(TextureHandle handle) {
+    TextureEntry* entry = &textures[handle];
+    glDeleteTextures(1, &entry->texture);
+    entry->texture = 0;
+    resident_bytes -= entry->bytes;
+    entry->bytes = 0;
+    thread_mutex_lock(texture_mutex);
+    entry->state = TEXTURE_UNLOADED;
+    thread_mutex_unlock(texture_mutex);
+    eviction_count++;
+}
+
+// Evicts unreferenced textures, least recently drawn first, until needed bytes fit the budget.
+static void make_room(size_t needed, TextureHandle keep) {
+    while (resident_bytes + needed > budget_bytes) {
+        TextureHandle victim = TEXTURE_INVALID;
+        for (int i = 0; i < texture_count; i++) {
+            TextureEntry* entry = &textures[i];
+            if (i == keep || entry->state != TEXTURE_RESIDENT || entry->refs > 0) continue;
+            if (victim == TEXTURE_INVALID || entry->last_used < textures[victim].last_used) victim = i;
+        }
+        if (victim == TEXTURE_INVALID) return;
+        evict(victim);
     }
+}
 
-    glGenTextures(1, &texture_id);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-    free(data);
+static size_t pixels_gpu_bytes(const TexturePixels* pixels) {
+    size_t bytes = 0;
+    for (int m = 0; m < pixels->level_count; m++) bytes += pixels->row_bytes[m] * pixels->heights[m];
+    return pixels->generate_mips ? bytes + bytes / 3 : bytes;
+}
+
+static void begin_upload(TextureHandle handle) {
+    TextureEntry* entry = &textures[handle];
+    TexturePixels* pixels = &entry->pixels;
+    entry->bytes = pixels_gpu_bytes(pixels);
+    // Prefetches only fill free budget; evicting for them would just trade one guess for another.
+    // The decoded pixels are kept so a later request does not decode the file again.
+    if (entry->refs == 0 && resident_bytes + entry->bytes > budget_bytes) {
+        entry->bytes = 0;
+        thread_mutex_lock(texture_mutex);
+        entry->state = TEXTURE_PARKED;
+        thread_mutex_unlock(texture_mutex);
+        return;
+    }
+    make_room(entry->bytes, handle);
 
+    glGenTextures(1, &entry->texture);
+    glBindTexture(GL_TEXTURE_2D, entry->texture);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    if (pixels->generate_mips && !gl_generate_mipmap) glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_TRUE);
+    if (!pixels->generate_mips) glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, pixels->level_count - 1);
+    for (int m = 0; m < pixels->level_count; m++) {
+        glTexImage2D(GL_TEXTURE_2D, m, pixels->internal_format, pixels->widths[m], pixels->heights[m], 0,
+                     pixels->format, pixels->type, NULL);
+    }
+    resident_bytes += entry->bytes;
+    if (resident_bytes > peak_bytes) peak_bytes = resident_bytes;
+    entry->level = 0;
+    entry->row = 0;
+    entry->state = TEXTURE_UPLOADING;
+}
+
+static void finish_upload(TextureEntry* entry) {
+    TexturePixels* pixels = &entry->pixels;
+    glBindTexture(GL_TEXTURE_2D, entry->texture);
+    if (pixels->generate_mips && gl_generate_mipmap) gl_generate_mipmap(GL_TEXTURE_2D);
+    bool mipmapped = pixels->generate_mips || pixels->level_count > 1;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+
+    printf("Textura %s residente: %dx%d, %d niveis, %zu bytes, %.1f ms apos o pedido\n", entry->filename,
+           pixels->widths[0], pixels->heights[0], pixels->level_count, entry->bytes,
+           (platform_time_seconds() - entry->requested_at) * 1000.0);
+
+    release_pixels(pixels);
+    entry->last_used = frame_counter;
+    load_count++;
+    thread_mutex_lock(texture_mutex);
+    entry->state = TEXTURE_RESIDENT;
+    thread_mutex_unlock(texture_mutex);
+}
 
-    return texture_id;
+// Uploads up to TEXTURE_SLICE_BYTES of whole rows, staged through a rotating PBO when available.
+static void upload_slice(TextureEntry* entry) {
+    TexturePixels* pixels = &entry->pixels;
+    int level = entry->level;
+    size_t row_bytes = pixels->row_bytes[level];
+    int rows = (int)(TEXTURE_SLICE_BYTES / row_bytes);
+    if (rows < 1) rows = 1;
+    if (rows > pixels->heights[level] - entry->row) rows = pixels->heights[level] - entry->row;
+    size_t bytes = rows * row_bytes;
+
+    glBindTexture(GL_TEXTURE_2D, entry->texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, pixels->alignment);
+    void* staging = NULL;
+    if (staging_buffers[0]) {
+        gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, staging_buffers[next_staging]);
+        next_staging = (next_staging + 1) % TEXTURE_STAGING_BUFFERS;
+        gl_buffer_data(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+        staging = gl_map_buffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    }
+    if (staging) {
+        if (pixels->top_down) {
+            for (int y = 0; y < rows; y++) {
+                memcpy((unsigned char*)staging + y * row_bytes, pixels_row(pixels, level, entry->row + y), row_bytes);
+            }
+        } else {
+            memcpy(staging, pixels_row(pixels, level, entry->row), bytes);
+        }
+        gl_unmap_buffer(GL_PIXEL_UNPACK_BUFFER);
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, entry->row, pixels->widths[level], rows,
+                        pixels->format, pixels->type, NULL);
+    } else {
+        if (staging_buffers[0]) gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        // Top-down rows run backwards in memory, so they go up one at a time.
+        int step = pixels->top_down ? 1 : rows;
+        for (int y = 0; y < rows; y += step) {
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, entry->row + y, pixels->widths[level], step,
+                            pixels->format, pixels->type, pixels_row(pixels, level, entry->row + y));
+        }
+    }
+    if (staging_buffers[0]) gl_bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    entry->row += rows;
+    if (entry->row == pixels->heights[level]) {
+        entry->row = 0;
+        entry->level++;
+    }
+    if (entry->level == pixels->level_count) finish_upload(entry);
+}
+
+void texture_stream_update(double budget_ms) {
+    double start = platform_time_seconds();
+    GLint bound = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+    frame_counter++;
+
+    // Entries still being decoded are skipped, so they do not hold up the ones behind them.
+    int index = 0;
+    while (index < upload_queue.count) {
+        TextureHandle handle = upload_queue.items[index];
+        TextureEntry* entry = &textures[handle];
+        thread_mutex_lock(texture_mutex);
+        TextureState state = entry->state;
+        thread_mutex_unlock(texture_mutex);
+        if (state == TEXTURE_QUEUED || state == TEXTURE_LOADING) {
+            index++;
+            continue;
+        }
+
+        if (state == TEXTURE_LOADED) begin_upload(handle);
+        if (entry->state != TEXTURE_UPLOADING) {
+            queue_remove(&upload_queue, index);
+            continue;
+        }
+        upload_slice(entry);
+        if (entry->state != TEXTURE_UPLOADING) queue_remove(&upload_queue, index);
+        if ((platform_time_seconds() - start) * 1000.0 >= budget_ms) break;
+    }
+    glBindTexture(GL_TEXTURE_2D, bound);
+}
+
+bool texture_is_ready(TextureHandle handle) {
+    if (handle < 0 || handle >= texture_count) return false;
+    thread_mutex_lock(texture_mutex);
+    bool ready = textures[handle].state == TEXTURE_RESIDENT;
+    thread_mutex_unlock(texture_mutex);
+    return ready;
+}
+
+void texture_set_budget(size_t bytes) {
+    budget_bytes = bytes;
+}
+
+void texture_get_stats(TextureStats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    thread_mutex_lock(texture_mutex);
+    for (int i = 0; i < texture_count; i++) {
+        if (textures[i].state == TEXTURE_RESIDENT) stats->resident++;
+        else if (textures[i].state != TEXTURE_UNLOADED && textures[i].state != TEXTURE_PARKED &&
+                 textures[i].state != TEXTURE_FAILED) stats->pending++;
+    }
+    thread_mutex_unlock(texture_mutex);
+    stats->registered = texture_count;
+    stats->resident_bytes = resident_bytes;
+    stats->peak_bytes = peak_bytes;
+    stats->budget_bytes = budget_bytes;
+    stats->loads = load_count;
+    stats->evictions = eviction_count;
+    stats->misses = miss_count;
+}
+
+bool texture_stream_idle() {
+    return upload_queue.count == 0;
+}
+
+void texture_stream_finish() {
+    while (!texture_stream_idle()) texture_stream_update(1000.0);
+}
+
+void texture_stream_shutdown() {
+    if (texture_mutex) {
+        thread_mutex_lock(texture_mutex);
+        stopping = true;
+        thread_cond_broadcast(texture_cond);
+        thread_mutex_unlock(texture_mutex);
+    }
+    for (int i = 0; i < TEXTURE_LOADER_THREADS; i++) {
+        thread_join(loaders[i]);
+        loaders[i] = NULL;
+    }
+    for (int i = 0; i < texture_count; i++) {
+        release_pixels(&textures[i].pixels);
+        if (textures[i].texture) glDeleteTextures(1, &textures[i].texture);
+    }
+    texture_count = 0;
+    load_queue.count = 0;
+    upload_queue.count = 0;
+    resident_bytes = 0;
+    if (staging_buffers[0]) gl_delete_buffers(TEXTURE_STAGING_BUFFERS, staging_buffers);
+    memset(staging_buffers, 0, sizeof(staging_buffers));
+    if (placeholder_texture) glDeleteTextures(1, &placeholder_texture);
+    placeholder_texture = 0;
+    thread_cond_destroy(texture_cond);
+    thread_mutex_destroy(texture_mutex);
+    texture_cond = NULL;
+    texture_mutex = NULL;
+    texture_archive_close();
 }
@@ -1,8 +1,39 @@
 #ifndef TEXTURE_H
 #define TEXTURE_H
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <GL/glut.h>
 
-GLuint load_texture_bmp(const char* filename);
+// Opens the packed texture archive, rebuilding it from directory when a BMP was added or changed.
+bool texture_archive_open(const char* archive_path, const char* directory);
+void texture_archive_close();
+
+typedef int TextureHandle;
+#define TEXTURE_INVALID -1
+
+typedef struct {
+    int registered, resident, pending;
+    size_t resident_bytes, peak_bytes, budget_bytes;
+    long loads, evictions, misses;
+} TextureStats;
+
+// Textures are read and decoded on loader threads and uploaded by the GL thread in
+// time-sliced chunks. Acquired textures stay resident; unreferenced ones are evicted
+// least recently drawn first once the budget is exceeded and reload on demand.
+bool texture_stream_init();
+TextureHandle texture_register(const char* filename);
+void texture_acquire(TextureHandle handle);
+void texture_release(TextureHandle handle);
+void texture_prefetch(TextureHandle handle);
+// Returns the resident texture, or a shared placeholder until it is uploaded.
+GLuint texture_gl_id(TextureHandle handle);
+bool texture_is_ready(TextureHandle handle);
+void texture_set_budget(size_t bytes);
+void texture_get_stats(TextureStats* stats);
+void texture_stream_update(double budget_ms);
+bool texture_stream_idle();
+void texture_stream_finish();
+void texture_stream_shutdown();
 
 #endif
@@ -0,0 +1,242 @@
+#ifdef _WIN32
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600
+#endif
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+#include <stdlib.h>
+#include "thread.h"
+
+#ifdef _WIN32
+
+struct Thread {
+    HANDLE handle;
+    void (*run)(void* arg);
+    void* arg;
+};
+
+struct ThreadMutex {
+    CRITICAL_SECTION section;
+};
+
+struct ThreadCond {
+    CONDITION_VARIABLE variable;
+};
+
+static unsigned __stdcall thread_entry(void* data) {
+    Thread* thread = data;
+    thread->run(thread->arg);
+    return 0;
+}
+
+Thread* thread_start(void (*run)(void* arg), void* arg) {
+    Thread* thread = malloc(sizeof(Thread));
+    if (!thread) return NULL;
+    thread->run = run;
+    thread->arg = arg;
+    thread->handle = (HANDLE)_beginthreadex(NULL, 0, thread_entry, thread, 0, NULL);
+    if (!thread->handle) {
+        free(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+void thread_join(Thread* thread) {
+    if (!thread) return;
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+    free(thread);
+}
+
+int thread_cpu_count() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+ThreadMutex* thread_mutex_create() {
+    ThreadMutex* mutex = malloc(sizeof(ThreadMutex));
+    if (mutex) InitializeCriticalSection(&mutex->section);
+    return mutex;
+}
+
+void thread_mutex_lock(ThreadMutex* mutex) {
+    EnterCriticalSection(&mutex->section);
+}
+
+void thread_mutex_unlock(ThreadMutex* mutex) {
+    LeaveCriticalSection(&mutex->section);
+}
+
+void thread_mutex_destroy(ThreadMutex* mutex) {
+    if (!mutex) return;
+    DeleteCriticalSection(&mutex->section);
+    free(mutex);
+}
+
+ThreadCond* thread_cond_create() {
+    ThreadCond* cond = malloc(sizeof(ThreadCond));
+    if (cond) InitializeConditionVariable(&cond->variable);
+    return cond;
+}
+
+void thread_cond_wait(ThreadCond* cond, ThreadMutex* mutex) {
+    SleepConditionVariableCS(&cond->variable, &mutex->section, INFINITE);
+}
+
+void thread_cond_signal(ThreadCond* cond) {
+    WakeConditionVariable(&cond->variable);
+}
+
+void thread_cond_broadcast(ThreadCond* cond) {
+    WakeAllConditionVariable(&cond->variable);
+}
+
+void thread_cond_destroy(ThreadCond* cond) {
+    free(cond);
+}
+
+int thread_atomic_load(volatile int* value) {
+    return (int)InterlockedCompareExchange((volatile LONG*)value, 0, 0);
+}
+
+void thread_atomic_store(volatile int* value, int new_value) {
+    InterlockedExchange((volatile LONG*)value, new_value);
+}
+
+int thread_atomic_exchange(volatile int* value, int new_value) {
+    return (int)InterlockedExchange((volatile LONG*)value, new_value);
+}
+
+int thread_atomic_add(volatile int* value, int amount) {
+    return (int)InterlockedExchangeAdd((volatile LONG*)value, amount);
+}
+
+void thread_sleep(double seconds) {
+    Sleep(seconds >= 0.001 ? (DWORD)(seconds * 1000.0) : 0);
+}
+
+#else
+
+struct Thread {
+    pthread_t handle;
+    void (*run)(void* arg);
+    void* arg;
+};
+
+struct ThreadMutex {
+    pthread_mutex_t mutex;
+};
+
+struct ThreadCond {
+    pthread_cond_t cond;
+};
+
+static void* thread_entry(void* data) {
+    Thread* thread = data;
+    thread->run(thread->arg);
+    return NULL;
+}
+
+Thread* thread_start(void (*run)(void* arg), void* arg) {
+    Thread* thread = malloc(sizeof(Thread));
+    if (!thread) return NULL;
+    thread->run = run;
+    thread->arg = arg;
+    if (pthread_create(&thread->handle, NULL, thread_entry, thread) != 0) {
+        free(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+void thread_join(Thread* thread) {
+    if (!thread) return;
+    pthread_join(thread->handle, NULL);
+    free(thread);
+}
+
+int thread_cpu_count() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int)count : 1;
+}
+
+ThreadMutex* thread_mutex_create() {
+    ThreadMutex* mutex = malloc(sizeof(ThreadMutex));
+    if (mutex) pthread_mutex_init(&mutex->mutex, NULL);
+    return mutex;
+}
+
+void thread_mutex_lock(ThreadMutex* mutex) {
+    pthread_mutex_lock(&mutex->mutex);
+}
+
+void thread_mutex_unlock(ThreadMutex* mutex) {
+    pthread_mutex_unlock(&mutex->mutex);
+}
+
+void thread_mutex_destroy(ThreadMutex* mutex) {
+    if (!mutex) return;
+    pthread_mutex_destroy(&mutex->mutex);
+    free(mutex);
+}
+
+ThreadCond* thread_cond_create() {
+    ThreadCond* cond = malloc(sizeof(ThreadCond));
+    if (cond) pthread_cond_init(&cond->cond, NULL);
+    return cond;
+}
+
+void thread_cond_wait(ThreadCond* cond, ThreadMutex* mutex) {
+    pthread_cond_wait(&cond->cond, &mutex->mutex);
+}
+
+void thread_cond_signal(ThreadCond* cond) {
+    pthread_cond_signal(&cond->cond);
+}
+
+void thread_cond_broadcast(ThreadCond* cond) {
+    pthread_cond_broadcast(&cond->cond);
+}
+
+void thread_cond_destroy(ThreadCond* cond) {
+    if (!cond) return;
+    pthread_cond_destroy(&cond->cond);
+    free(cond);
+}
+
+int thread_atomic_load(volatile int* value) {
+    return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+}
+
+void thread_atomic_store(volatile int* value, int new_value) {
+    __atomic_store_n(value, new_value, __ATOMIC_SEQ_CST);
+}
+
+int thread_atomic_exchange(volatile int* value, int new_value) {
+    return __atomic_exchange_n(value, new_value, __ATOMIC_SEQ_CST);
+}
+
+int thread_atomic_add(volatile int* value, int amount) {
+    return __atomic_fetch_add(value, amount, __ATOMIC_SEQ_CST);
+}
+
+void thread_sleep(double seconds) {
+    if (seconds < 0.001) {
+        sched_yield();
+        return;
+    }
+    struct timespec duration;
+    duration.tv_sec = (time_t)seconds;
+    duration.tv_nsec = (long)((seconds - (double)duration.tv_sec) * 1e9);
+    nanosleep(&duration, NULL);
+}
+
+#endif
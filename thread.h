@@ -0,0 +1,36 @@
+#ifndef THREAD_H
+#define THREAD_H
+
+#include <stdbool.h>
+
+// Opaque wrappers over Win32 threads and pthreads.
+typedef struct Thread Thread;
+typedef struct ThreadMutex ThreadMutex;
+typedef struct ThreadCond ThreadCond;
+
+Thread* thread_start(void (*run)(void* arg), void* arg);
+void thread_join(Thread* thread);
+int thread_cpu_count();
+
+ThreadMutex* thread_mutex_create();
+void thread_mutex_lock(ThreadMutex* mutex);
+void thread_mutex_unlock(ThreadMutex* mutex);
+void thread_mutex_destroy(ThreadMutex* mutex);
+
+ThreadCond* thread_cond_create();
+void thread_cond_wait(ThreadCond* cond, ThreadMutex* mutex);
+void thread_cond_signal(ThreadCond* cond);
+void thread_cond_broadcast(ThreadCond* cond);
+void thread_cond_destroy(ThreadCond* cond);
+
+// Sequentially consistent operations on an int shared between threads.
+int thread_atomic_load(volatile int* value);
+void thread_atomic_store(volatile int* value, int new_value);
+int thread_atomic_exchange(volatile int* value, int new_value);
+// Returns the value from before the addition.
+int thread_atomic_add(volatile int* value, int amount);
+
+// Gives up the CPU for roughly this long; below a millisecond it only yields.
+void thread_sleep(double seconds);
+
+#endif
@@ -1,82 +1,157 @@
 #include <GL/glut.h>
 #include <stdio.h>
+#include <math.h>
 #include <stdbool.h>
 #include <string.h>
 #include "ui.h"
 #include "render.h"
+#include "profiler.h"
+#include "texture.h"
+#include "lights.h"
+#include "text.h"
+#include "glstate.h"
 
 typedef struct {
     float x, y, w, h;
     const char* text;
+    int text_width;
 } Button;
 
-static void draw_fullscreen_texture(const char* texture_name);
+static void draw_fullscreen_texture(RenderTexture texture);
 static int check_button_array_click(int x, int y, Button buttons[], int num_buttons);
 
 static Button main_menu_buttons[] = {
-    {0, 0, 200, 50, "Iniciar Jogo"},
-    {0, 0, 200, 50, "Sair"}
+    {0, 0, 200, 50, "Iniciar Jogo", -1},
+    {0, 0, 200, 50, "Sair", -1}
 };
 static int num_main_menu_buttons = 2;
 
 static Button pause_menu_buttons[] = {
-    {0, 0, 200, 50, "Continuar"},
-    {0, 0, 200, 50, "Voltar ao Menu"},
-    {0, 0, 200, 50, "Sair do Jogo"}
+    {0, 0, 200, 50, "Continuar", -1},
+    {0, 0, 200, 50, "Voltar ao Menu", -1},
+    {0, 0, 200, 50, "Sair do Jogo", -1}
 };
 static int num_pause_menu_buttons = 3;
 
 static Button end_screen_buttons[] = {
-    {0, 0, 220, 50, "Voltar ao Menu"},
-    {0, 0, 220, 50, "Sair do Jogo"}
+    {0, 0, 220, 50, "Voltar ao Menu", -1},
+    {0, 0, 220, 50, "Sair do Jogo", -1}
 };
 static int num_end_screen_buttons = 2;
 
-static void draw_text(float x, float y, const char* text) {
-    glRasterPos2f(x, y);
-    for (const char* c = text; *c != '\0'; c++) {
-        glutBitmapCharacter(GLUT_BITMAP_TIMES_ROMAN_24, *c);
-    }
-}
+static bool profiler_overlay_visible = false;
+
+// The HUD line is only reformatted when one of the values it shows changes.
+static char hud_text[100];
+static int hud_eaten = -1, hud_total = -1, hud_tenths = -1;
+static GameState hud_state;
+
+static bool guide_visible = false;
+static char guide_text[100];
+static int guide_distance = -1, guide_direction = -1;
+static bool guide_to_exit;
+static int shown_guide_distance = -1, shown_guide_direction = -1;
+static const char* guide_directions[] = {"siga em frente", "vire a direita", "volte", "vire a esquerda"};
 
 static void draw_button(Button* btn) {
-    glColor4f(1.0, 1.0, 1.0, 0.15);
-    glRectf(btn->x, btn->y, btn->x + btn->w, btn->y + btn->h);
+    text_color(1.0, 1.0, 1.0, 0.15);
+    text_add_rect(btn->x, btn->y, btn->x + btn->w, btn->y + btn->h);
 
-    glColor3f(1.0, 1.0, 1.0);
-    int text_width = 0;
-    for (const char* c = btn->text; *c != '\0'; c++) {
-        text_width += glutBitmapWidth(GLUT_BITMAP_TIMES_ROMAN_24, *c);
-    }
-    float text_x = btn->x + (btn->w - text_width) / 2.0;
+    text_color(1.0, 1.0, 1.0, 1.0);
+    if (btn->text_width < 0) btn->text_width = text_width(TEXT_FONT_LARGE, btn->text);
+    float text_x = btn->x + (btn->w - btn->text_width) / 2.0;
     float text_y = btn->y + (btn->h / 2.0) - 8;
-    draw_text(text_x, text_y, btn->text);
+    text_add(TEXT_FONT_LARGE, text_x, text_y, btn->text);
+}
+
+static void draw_profiler_overlay() {
+    float line_height = 16.0f;
+    float top = render_window_height() - 60.0f;
+    float height = line_height * (PROFILE_PHASE_COUNT + 4) + 10.0f;
+
+    text_color(0.0, 0.0, 0.0, 0.6);
+    text_add_rect(15, top - height + line_height, 465, top + line_height + 4);
+
+    char line[128];
+    text_color(1.0, 1.0, 0.6, 1.0);
+    text_add(TEXT_FONT_SMALL, 20, top, "fase (ms)             min     media    p99      gpu media  gpu p99");
+    text_color(1.0, 1.0, 1.0, 1.0);
+    for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        ProfileStats s;
+        profiler_get_stats((ProfilePhase)i, &s);
+        if (s.gpu_samples > 0) {
+            snprintf(line, sizeof(line), "%-16s %7.2f %7.2f %7.2f    %7.2f  %7.2f",
+                     profiler_phase_name((ProfilePhase)i), s.cpu_min, s.cpu_avg, s.cpu_p99, s.gpu_avg, s.gpu_p99);
+        } else {
+            snprintf(line, sizeof(line), "%-16s %7.2f %7.2f %7.2f          -        -",
+                     profiler_phase_name((ProfilePhase)i), s.cpu_min, s.cpu_avg, s.cpu_p99);
+        }
+        text_add(TEXT_FONT_SMALL, 20, top - line_height * (i + 1), line);
+    }
+
+    TextureStats t;
+    texture_get_stats(&t);
+    snprintf(line, sizeof(line), "texturas %d/%d  %.1f/%.0f MB  %ld cargas  %ld despejos",
+             t.resident, t.registered, t.resident_bytes / 1048576.0, t.budget_bytes / 1048576.0, t.loads, t.evictions);
+    text_color(1.0, 1.0, 0.6, 1.0);
+    text_add(TEXT_FONT_SMALL, 20, top - line_height * (PROFILE_PHASE_COUNT + 1), line);
+
+    GlStateStats g;
+    glstate_get_stats(&g);
+    snprintf(line, sizeof(line), "estado GL %d chamadas  %d evitadas", g.issued, g.skipped);
+    text_add(TEXT_FONT_SMALL, 20, top - line_height * (PROFILE_PHASE_COUNT + 2), line);
+
+    if (lights_available()) {
+        LightStats l;
+        lights_get_stats(&l);
+        snprintf(line, sizeof(line), "luzes %d/%d visiveis  %d entradas  %d max por cluster",
+                 l.visible, l.lights, l.entries, l.max_per_cluster);
+        text_add(TEXT_FONT_SMALL, 20, top - line_height * (PROFILE_PHASE_COUNT + 3), line);
+    }
 }
 
 static void begin_ui_render() {
     glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity();
-    gluOrtho2D(0, glutGet(GLUT_WINDOW_WIDTH), 0, glutGet(GLUT_WINDOW_HEIGHT));
+    gluOrtho2D(0, render_window_width(), 0, render_window_height());
     glMatrixMode(GL_MODELVIEW); glPushMatrix(); glLoadIdentity();
-    glDisable(GL_LIGHTING); glDisable(GL_TEXTURE_2D); glDisable(GL_DEPTH_TEST);
+    glstate_set(GLSTATE_LIGHTING, false);
+    glstate_set(GLSTATE_TEXTURE_2D, false);
+    glstate_set(GLSTATE_DEPTH_TEST, false);
 
-    glEnable(GL_BLEND);
+    glstate_set(GLSTATE_BLEND, true);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    text_begin();
 }
 
 static void end_ui_render() {
-    glDisable(GL_BLEND);
+    text_flush();
+    glstate_set(GLSTATE_BLEND, false);
 
-    glEnable(GL_DEPTH_TEST); glEnable(GL_TEXTURE_2D); glEnable(GL_LIGHTING);
+    glstate_set(GLSTATE_DEPTH_TEST, true);
+    glstate_set(GLSTATE_TEXTURE_2D, true);
+    glstate_set(GLSTATE_LIGHTING, true);
     glMatrixMode(GL_PROJECTION); glPopMatrix();
     glMatrixMode(GL_MODELVIEW); glPopMatrix();
 }
 
+bool ui_init() {
+    if (!text_init()) {
+        fprintf(stderr, "Falha ao criar o atlas de fontes\n");
+        return false;
+    }
+    return true;
+}
+
+void ui_cleanup() {
+    text_cleanup();
+}
+
 void ui_draw_main_menu() {
     begin_ui_render();
-    draw_fullscreen_texture("menu_bg");
+    draw_fullscreen_texture(RENDER_TEXTURE_MENU_BG);
 
-    int win_w = glutGet(GLUT_WINDOW_WIDTH);
-    int win_h = glutGet(GLUT_WINDOW_HEIGHT);
+    int win_w = render_window_width();
+    int win_h = render_window_height();
 
     float btn_x = win_w / 2 - 100;
     main_menu_buttons[0].x = btn_x; main_menu_buttons[0].y = win_h / 2;
@@ -88,15 +163,15 @@ void ui_draw_main_menu() {
 
 void ui_draw_pause_menu() {
     begin_ui_render();
-    draw_fullscreen_texture("menu_bg");
+    draw_fullscreen_texture(RENDER_TEXTURE_MENU_BG);
 
-    int win_w = glutGet(GLUT_WINDOW_WIDTH);
-    int win_h = glutGet(GLUT_WINDOW_HEIGHT);
-    glColor4f(0.0, 0.0, 0.0, 0.7);
-    glRectf(0, 0, win_w, win_h);
+    int win_w = render_window_width();
+    int win_h = render_window_height();
+    text_color(0.0, 0.0, 0.0, 0.7);
+    text_add_rect(0, 0, win_w, win_h);
 
-    glColor3f(1.0, 1.0, 0.8);
-    draw_text(win_w / 2 - 50, win_h - 100, "PAUSADO");
+    text_color(1.0, 1.0, 0.8, 1.0);
+    text_add(TEXT_FONT_LARGE, win_w / 2 - 50, win_h - 100, "PAUSADO");
 
     float btn_x = win_w / 2 - 100;
     pause_menu_buttons[0].x = btn_x; pause_menu_buttons[0].y = win_h / 2;
@@ -108,12 +183,12 @@ void ui_draw_pause_menu() {
     end_ui_render();
 }
 
-void ui_draw_end_screen(const char* bg_texture_name) {
+void ui_draw_end_screen(RenderTexture background) {
     begin_ui_render();
-    draw_fullscreen_texture(bg_texture_name);
+    draw_fullscreen_texture(background);
 
-    int win_w = glutGet(GLUT_WINDOW_WIDTH);
-    int win_h = glutGet(GLUT_WINDOW_HEIGHT);
+    int win_w = render_window_width();
+    int win_h = render_window_height();
 
     float btn_x = win_w / 2 - 110;
     end_screen_buttons[0].x = btn_x;
@@ -129,37 +204,73 @@ void ui_draw_end_screen(const char* bg_texture_name) {
 
 void ui_draw_game_hud(int eaten, int total, float timer, GameState state) {
     begin_ui_render();
-    char text[100];
-    if (state == STATE_ESCAPING) {
-        sprintf(text, "SAIDA ABERTA! TEMPO: %.1f", timer);
-    } else {
-        sprintf(text, "Esferas: %d / %d", eaten, total);
+    int tenths = state == STATE_ESCAPING ? (int)(timer * 10.0f + 0.5f) : 0;
+    if (state != hud_state || eaten != hud_eaten || total != hud_total || tenths != hud_tenths) {
+        if (state == STATE_ESCAPING) {
+            snprintf(hud_text, sizeof(hud_text), "SAIDA ABERTA! TEMPO: %.1f", tenths / 10.0);
+        } else {
+            snprintf(hud_text, sizeof(hud_text), "Esferas: %d / %d", eaten, total);
+        }
+        hud_state = state;
+        hud_eaten = eaten;
+        hud_total = total;
+        hud_tenths = tenths;
     }
-    glColor3f(1.0, 1.0, 1.0);
-    draw_text(20, glutGet(GLUT_WINDOW_HEIGHT) - 30, text);
+    text_color(1.0, 1.0, 1.0, 1.0);
+    text_add(TEXT_FONT_LARGE, 20, render_window_height() - 30, hud_text);
+    if (guide_visible && guide_distance >= 0) {
+        bool to_exit = state == STATE_ESCAPING;
+        if (guide_distance != shown_guide_distance || guide_direction != shown_guide_direction || to_exit != guide_to_exit) {
+            if (guide_distance == 0) {
+                snprintf(guide_text, sizeof(guide_text), "Guia: %s aqui", to_exit ? "saida" : "esfera");
+            } else {
+                snprintf(guide_text, sizeof(guide_text), "Guia: %s a %d passos, %s", to_exit ? "saida" : "esfera",
+                         guide_distance, guide_directions[guide_direction]);
+            }
+            shown_guide_distance = guide_distance;
+            shown_guide_direction = guide_direction;
+            guide_to_exit = to_exit;
+        }
+        text_add(TEXT_FONT_SMALL, 20, 20, guide_text);
+    }
+    if (profiler_overlay_visible) draw_profiler_overlay();
     end_ui_render();
 }
 
-static void draw_fullscreen_texture(const char* texture_name) {
-    GLuint tex_id = render_get_texture_id(texture_name);
-    if (tex_id == 0) return;
+void ui_toggle_profiler_overlay() {
+    profiler_overlay_visible = !profiler_overlay_visible;
+}
+
+void ui_set_guide(int distance, float angle) {
+    guide_distance = distance;
+    // Quarter turns centred on straight ahead, counted clockwise.
+    guide_direction = (int)floorf(angle / (float)(PI / 2.0) + 0.5f) & 3;
+}
+
+bool ui_toggle_guide() {
+    guide_visible = !guide_visible;
+    return guide_visible;
+}
+
+static void draw_fullscreen_texture(RenderTexture texture) {
+    GLuint tex_id = render_get_texture(texture);
+    int win_w = render_window_width();
+    int win_h = render_window_height();
 
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, tex_id);
+    glstate_set(GLSTATE_TEXTURE_2D, true);
+    glstate_bind_texture(0, tex_id);
     glColor3f(1.0, 1.0, 1.0);
 
     glBegin(GL_QUADS);
         glTexCoord2f(0.0, 0.0); glVertex2f(0, 0);
-        glTexCoord2f(1.0, 0.0); glVertex2f(glutGet(GLUT_WINDOW_WIDTH), 0);
-        glTexCoord2f(1.0, 1.0); glVertex2f(glutGet(GLUT_WINDOW_WIDTH), glutGet(GLUT_WINDOW_HEIGHT));
-        glTexCoord2f(0.0, 1.0); glVertex2f(0, glutGet(GLUT_WINDOW_HEIGHT));
+        glTexCoord2f(1.0, 0.0); glVertex2f(win_w, 0);
+        glTexCoord2f(1.0, 1.0); glVertex2f(win_w, win_h);
+        glTexCoord2f(0.0, 1.0); glVertex2f(0, win_h);
     glEnd();
-
-    glDisable(GL_TEXTURE_2D);
 }
 
 static bool is_point_in_rect(int px, int py, Button* btn) {
-    int gl_y = glutGet(GLUT_WINDOW_HEIGHT) - py;
+    int gl_y = render_window_height() - py;
     return (px >= btn->x && px <= btn->x + btn->w && gl_y >= btn->y && gl_y <= btn->y + btn->h);
 }
 
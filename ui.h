@@ -2,11 +2,19 @@
 #define UI_H
 
 #include "config.h"
+#include "render.h"
 
+bool ui_init();
+void ui_cleanup();
 void ui_draw_main_menu();
 void ui_draw_pause_menu();
-void ui_draw_end_screen(const char* bg_texture_name);
+void ui_draw_end_screen(RenderTexture background);
 void ui_draw_game_hud(int eaten, int total, float timer, GameState state);
+void ui_toggle_profiler_overlay();
+// Distance in steps (-1 hides the hint) and angle in radians, positive to the right.
+void ui_set_guide(int distance, float angle);
+// Returns whether the guide is now shown.
+bool ui_toggle_guide();
 
 int ui_check_click(int x, int y, GameState state);
 
@@ -0,0 +1,51 @@
+#include <stdlib.h>
+#include <string.h>
+#include "world.h"
+
+bool world_create(World* world, int width, int height) {
+    memset(world, 0, sizeof(*world));
+    if (width <= 0 || height <= 0) return false;
+
+    world->width = width;
+    world->height = height;
+    world->chunks_x = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    world->chunks_z = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    world->chunks = malloc((size_t)world->chunks_x * world->chunks_z * sizeof(WorldChunk));
+    if (!world->chunks) return false;
+
+    // Cells past the edge of partial chunks stay solid so lookups never see open space outside the maze.
+    memset(world->chunks, 1, (size_t)world->chunks_x * world->chunks_z * sizeof(WorldChunk));
+    world->exit_x = width - 2;
+    world->exit_z = height - 2;
+    world->start_x = 1.5f;
+    world->start_z = 1.5f;
+    return true;
+}
+
+bool world_copy(World* dst, const World* src) {
+    if (dst->chunks_x != src->chunks_x || dst->chunks_z != src->chunks_z) {
+        world_destroy(dst);
+        if (!world_create(dst, src->width, src->height)) return false;
+    }
+
+    WorldChunk* chunks = dst->chunks;
+    *dst = *src;
+    dst->chunks = chunks;
+    memcpy(dst->chunks, src->chunks, (size_t)src->chunks_x * src->chunks_z * sizeof(WorldChunk));
+    return true;
+}
+
+void world_destroy(World* world) {
+    free(world->chunks);
+    memset(world, 0, sizeof(*world));
+}
+
+int world_count_tiles(const World* world, int tile) {
+    int count = 0;
+    for (int x = 0; x < world->width; x++) {
+        for (int z = 0; z < world->height; z++) {
+            if (world_get(world, x, z) == tile) count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,51 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <stdbool.h>
+
+#define CHUNK_SHIFT 5
+#define CHUNK_SIZE (1 << CHUNK_SHIFT)
+#define CHUNK_MASK (CHUNK_SIZE - 1)
+
+typedef struct {
+    unsigned char cells[CHUNK_SIZE * CHUNK_SIZE];
+} WorldChunk;
+
+typedef struct {
+    int width, height;
+    int chunks_x, chunks_z;
+    int exit_x, exit_z;
+    float start_x, start_z;
+    WorldChunk* chunks;
+} World;
+
+bool world_create(World* world, int width, int height);
+bool world_copy(World* dst, const World* src);
+void world_destroy(World* world);
+int world_count_tiles(const World* world, int tile);
+
+static inline bool world_in_bounds(const World* world, int x, int z) {
+    return (unsigned)x < (unsigned)world->width && (unsigned)z < (unsigned)world->height;
+}
+
+static inline WorldChunk* world_chunk(const World* world, int cx, int cz) {
+    return &world->chunks[cx * world->chunks_z + cz];
+}
+
+static inline int world_get(const World* world, int x, int z) {
+    if (!world_in_bounds(world, x, z)) return 1;
+    const WorldChunk* chunk = world_chunk(world, x >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+    return chunk->cells[((x & CHUNK_MASK) << CHUNK_SHIFT) | (z & CHUNK_MASK)];
+}
+
+static inline void world_set(World* world, int x, int z, int tile) {
+    if (!world_in_bounds(world, x, z)) return;
+    WorldChunk* chunk = world_chunk(world, x >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+    chunk->cells[((x & CHUNK_MASK) << CHUNK_SHIFT) | (z & CHUNK_MASK)] = (unsigned char)tile;
+}
+
+static inline bool world_is_exit(const World* world, int x, int z) {
+    return x == world->exit_x && z == world->exit_z;
+}
+
+#endif